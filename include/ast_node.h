@@ -2,6 +2,7 @@
 
 struct Visitor;
 struct ASTNode {
+  virtual ~ASTNode() = default;
   virtual void accept(Visitor* visitor) = 0;
 };
 
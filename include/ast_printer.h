@@ -11,6 +11,10 @@ private:
   bool isRoot;
   void printLineStart(bool isMiddle = true);
   void visit(const CreateStmt* node);
+  void visit(const InsertStmt* node);
+  void visit(const SelectStmt* node);
+  void visit(const PrepareStmt* node);
+  void visit(const ExecuteStmt* node);
   void visit(const DatabaseNode* node);
   void visit(const TableNode* node);
 
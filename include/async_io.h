@@ -0,0 +1,121 @@
+#pragma once
+
+#include "block_device.h"
+#include "parameters.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// One read or write of whole blocks. The buffer must stay valid until the
+// request is done; result is then the number of bytes transferred, or -1.
+struct IORequest {
+  BlockDevice* device;
+  bool write;
+  size_t offset;
+  char* data;
+  size_t size;
+  long result;
+  bool done;
+};
+
+// Keeps up to depth block reads and writes in flight. Requests are queued with
+// submit, handed over with start and collected with reap, in completion order.
+// An engine is meant for a single owner thread, and done and result are only
+// set while that thread reaps.
+class AsyncIO {
+protected:
+  const size_t depth;
+  size_t inFlight;
+
+  AsyncIO(size_t depth);
+
+  static long perform(IORequest* request);
+  static void complete(IORequest* request, long result);
+
+public:
+  virtual ~AsyncIO() = default;
+  // io_uring when the kernel allows it, worker threads otherwise
+  static std::unique_ptr<AsyncIO> create(size_t depth = ASYNC_IO_DEPTH);
+
+  virtual const char* getName() const = 0;
+  // Queues the request; false if depth requests are already in flight
+  virtual bool submit(IORequest* request) = 0;
+  // Hands the queued requests over without waiting for them
+  virtual bool start() = 0;
+  // Waits until at least minimum requests, or every request in flight, are
+  // done, and appends the finished requests to completed
+  virtual size_t reap(std::vector<IORequest*>& completed, size_t minimum) = 0;
+
+  size_t getDepth() const;
+  size_t getInFlight() const;
+  void drain();
+  // Runs every request, keeping the queue full. Returns true if all of them
+  // transferred their whole size.
+  bool run(std::vector<IORequest>& requests);
+};
+
+// Submission and completion rings shared with the kernel, set up with the raw
+// io_uring syscalls. Requests on devices without a descriptor run inline.
+class IoUringIO final : public AsyncIO {
+private:
+  int ringFd;
+  void* submissionRing;
+  size_t submissionRingSize;
+  void* completionRing;
+  size_t completionRingSize;
+  void* entries;
+  size_t entriesSize;
+  unsigned* submissionTail;
+  unsigned* submissionMask;
+  unsigned* submissionArray;
+  unsigned* completionHead;
+  unsigned* completionTail;
+  unsigned* completionMask;
+  void* completions;
+  unsigned queued;
+  // Requests that ran inline, waiting to be reaped
+  std::vector<IORequest*> ready;
+
+  bool enter(unsigned minimum);
+
+public:
+  IoUringIO(size_t depth);
+  IoUringIO(const IoUringIO& io) = delete;
+  ~IoUringIO();
+
+  bool isOpen() const;
+  const char* getName() const;
+  bool submit(IORequest* request);
+  bool start();
+  size_t reap(std::vector<IORequest*>& completed, size_t minimum);
+};
+
+// Worker threads running pread and pwrite through the device
+class ThreadPoolIO final : public AsyncIO {
+private:
+  std::mutex mutex;
+  std::condition_variable queued;
+  std::condition_variable finished;
+  std::deque<IORequest*> pending;
+  // Finished by a worker; the owner records the result when it reaps them
+  std::vector<std::pair<IORequest*, long>> completions;
+  std::vector<std::thread> workers;
+  bool stopping;
+
+  void work();
+
+public:
+  ThreadPoolIO(size_t depth, size_t workerCount = ASYNC_IO_WORKERS);
+  ThreadPoolIO(const ThreadPoolIO& io) = delete;
+  ~ThreadPoolIO();
+
+  const char* getName() const;
+  bool submit(IORequest* request);
+  bool start();
+  size_t reap(std::vector<IORequest*>& completed, size_t minimum);
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Positional byte I/O on the storage behind a BlockFile. Calls take explicit
+// offsets and share no seek position, so different threads can read
+// different blocks at the same time.
+class BlockDevice {
+public:
+  virtual ~BlockDevice() = default;
+
+  virtual bool isOpen() const = 0;
+  virtual size_t getSize() = 0;
+  // Returns the number of bytes read, short only at the end of the device
+  virtual size_t read(size_t offset, char* data, size_t size) = 0;
+  virtual bool write(size_t offset, const char* data, size_t size) = 0;
+  virtual bool resize(size_t size) = 0;
+  virtual bool sync() = 0;
+  // Descriptor of the underlying file, -1 if there is none
+  virtual int getDescriptor() const = 0;
+};
+
+// A file accessed with pread and pwrite. With direct set the file is opened
+// with O_DIRECT so reads and writes bypass the kernel page cache; the buffer
+// pool already caches the pages. O_DIRECT needs BLOCK_SIZE-aligned buffers,
+// offsets and sizes. Offsets and sizes are whole blocks in a BlockFile;
+// unaligned buffers go through an aligned copy. A file system without
+// O_DIRECT support falls back to the page cache.
+class FileBlockDevice final : public BlockDevice {
+private:
+  const std::string path;
+  int fd;
+  bool direct;
+
+public:
+  FileBlockDevice(const std::string& path, bool direct = false);
+  FileBlockDevice(const FileBlockDevice& device) = delete;
+  ~FileBlockDevice();
+
+  bool isOpen() const;
+  bool isDirect() const;
+  size_t getSize();
+  size_t read(size_t offset, char* data, size_t size);
+  bool write(size_t offset, const char* data, size_t size);
+  bool resize(size_t size);
+  bool sync();
+  int getDescriptor() const;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "block_device.h"
+
+#include <memory>
+#include <string>
+
+// A file made of BLOCK_SIZE blocks. Blocks can be allocated ahead of being
+// written, so the block count is tracked in memory rather than taken from
+// the file size.
+//
+// The blocks are read and written through a BlockDevice. By default this is
+// the file accessed with pread and pwrite, through the page cache (BUFFERED)
+// or around it (DIRECT).
+//
+// In MAPPED mode the file is mmap-ed into an address range reserved up front,
+// so blocks can be used in place through getMappedBlock and stay at the same
+// address while the file grows. Growing extends the file with ftruncate and
+// maps the new part at the end of the existing mapping; flushing uses msync.
+class BlockFile {
+public:
+  typedef enum {
+    BUFFERED,
+    DIRECT,
+    MAPPED,
+  } Mode;
+
+private:
+  const std::string path;
+  std::unique_ptr<BlockDevice> device;
+  size_t blockCount;
+  const Mode mode;
+  char* mapping;
+  size_t mappedBlocks;
+
+  bool openMapping();
+  bool growMapping(size_t blocks);
+  bool extendMapped(size_t blocks);
+
+public:
+  BlockFile(const std::string& path, Mode mode = BUFFERED);
+  BlockFile(const std::string& path, std::unique_ptr<BlockDevice> device);
+  BlockFile(const BlockFile& file) = delete;
+  ~BlockFile();
+
+  bool isOpen() const;
+  bool isMapped() const;
+  Mode getMode() const;
+  const std::string& getPath() const;
+  BlockDevice& getDevice();
+  size_t getBlockCount() const;
+  size_t allocateBlock();
+  bool readBlock(size_t index, char* block);
+  size_t readBlocks(size_t first, size_t count, char* blocks);
+  bool writeBlock(size_t index, const char* block);
+  char* getMappedBlock(size_t index);
+  bool syncBlock(size_t index);
+  void flush();
+  bool sync();
+};
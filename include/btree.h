@@ -1,25 +1,46 @@
 #pragma once
 
+#include "btree_allocator.h"
+#include "inline_vector.h"
 #include "optional.h"
+#include "parameters.h"
 
 #include <vector>
 #include <deque>
 #include <memory>
 
 template <typename T> class BTree;
+template <typename T> class BTreeLeafNode;
+template <typename T> class BTreeInternalNode;
 
+// Common part of both node kinds: a small header followed by the inline key
+// array, so a search reads the keys from the cache lines right after the
+// header. The concrete node is a BTreeLeafNode or a BTreeInternalNode.
 template <typename T> class BTreeNode{
 private:
-  size_t order;
-  BTreeNode* next;
-  std::vector<std::unique_ptr<BTreeNode<T>>> children;
-  std::vector<T> values;
+  // Order = M -> 2M (key) + (2M + 1) (ptr_size) + next_block_ptr_size + used_size = block_size
+  static constexpr size_t order = (BLOCK_SIZE - 3 * sizeof(size_t)) / (2 * (sizeof(T) + sizeof(size_t)));
+
+  const bool leaf;
   BTreeNode* parent;
-  friend class BTree<T>;
+  BTreeNodeAllocator<T>* allocator;
 #ifdef VERDANT_FLAG_DEBUG
   static size_t nextIndex;
   size_t index;
 #endif
+  InlineVector<T, 2 * order> values;
+  friend class BTree<T>;
+  friend class BTreeLeafNode<T>;
+  friend class BTreeInternalNode<T>;
+  friend struct BTreeNodeDeleter<T>;
+
+  // Only valid on internal nodes
+  InlineVector<BTreeNodePtr<T>, 2 * order + 1>& getChildren();
+
+  // Only valid on leaves
+  BTreeNode* getNext();
+
+  void setNext(BTreeNode* next);
 
   size_t insertIndexSearch(const T& value);
 
@@ -37,9 +58,11 @@ private:
 
   Optional<BTreeNode<T>*> getNextChild(BTreeNode* curChild);
 
-  std::pair<Optional<T>, std::unique_ptr<BTreeNode<T>>> insert(T value);
+  std::pair<Optional<T>, BTreeNodePtr<T>> insert(T value);
 
-  BTreeNode(size_t order, BTreeNode* parent = nullptr);
+  BTreeNode(BTreeNodeAllocator<T>* allocator, bool leaf, BTreeNode* parent);
+
+  static BTreeNodePtr<T> create(BTreeNodeAllocator<T>* allocator, bool leaf, BTreeNode* parent = nullptr);
 
   std::pair<Optional<T>, Optional<size_t>> remove(const T& value);
 
@@ -49,6 +72,8 @@ private:
 
   Optional<T> search(const T& value);
 
+  BTreeNode<T>* findLeaf(const T& value);
+
   Optional<std::vector<T>> searchRange(const T& minVal, const T& maxVal);
 
   std::pair<bool, size_t> validate(bool root = false, BTreeNode* parent = nullptr, T* minVal = nullptr, T* maxVal = nullptr);
@@ -69,22 +94,86 @@ private:
 
 };
 
+// Leaves carry no child array, only the link to the next leaf
+template <typename T> class BTreeLeafNode final : public BTreeNode<T> {
+private:
+  BTreeNode<T>* next;
+  friend class BTreeNode<T>;
+
+  BTreeLeafNode(BTreeNodeAllocator<T>* allocator, BTreeNode<T>* parent);
+};
+
+// Children are kept as a plain array of node pointers
+template <typename T> class BTreeInternalNode final : public BTreeNode<T> {
+private:
+  InlineVector<BTreeNodePtr<T>, 2 * BTreeNode<T>::order + 1> children;
+  friend class BTreeNode<T>;
+
+  BTreeInternalNode(BTreeNodeAllocator<T>* allocator, BTreeNode<T>* parent);
+};
+
 template <typename T> class BTree {
 private:
-  size_t order;
-  std::unique_ptr<BTreeNode<T>> root;
+  static constexpr size_t order = BTreeNode<T>::order;
+  // Declared before root so that every node is gone before its memory is
+  std::unique_ptr<BTreeNodeAllocator<T>> allocator;
+  BTreeNodePtr<T> root;
+
+  static std::vector<size_t> splitEvenly(size_t count, size_t target, size_t minSize, size_t maxSize);
 public:
+  // Forward cursor over the leaf chain. It holds a position, not a copy of the
+  // values, and is invalidated by any insert or remove on the tree.
+  class Cursor {
+  private:
+    BTreeNode<T>* node;
+    size_t index;
+    friend class BTree<T>;
+
+    Cursor(BTreeNode<T>* node, size_t index);
+
+    void skipExhaustedLeaf();
+  public:
+    bool valid() const;
+
+    const T& operator*() const;
+
+    const T* operator->() const;
+
+    Cursor& operator++();
+
+    bool operator==(const Cursor& other) const;
+
+    bool operator!=(const Cursor& other) const;
+  };
+
   BTree();
+  explicit BTree(std::unique_ptr<BTreeNodeAllocator<T>> allocator);
   ~BTree();
 
   bool insert(T value);
 
+  // Replaces the content of the tree with the ascending values in
+  // [first, last), building the leaves and then each internal level bottom-up.
+  // Every node is filled up to fillFactor of its capacity. Returns false,
+  // leaving the tree untouched, if the input is not sorted.
+  template <typename Iterator> bool bulkLoad(Iterator first, Iterator last, double fillFactor = BTREE_FILL_FACTOR);
+
   Optional<T> remove(const T& value);
 
   Optional<T> search(const T& value);
 
   Optional<std::vector<T>> searchRange(const T& minVal, const T& maxVal);
 
+  Cursor begin();
+
+  Cursor end();
+
+  // First value not less than value
+  Cursor lowerBound(const T& value);
+
+  // First value greater than value
+  Cursor upperBound(const T& value);
+
   bool validate();
 
   Optional<T> getMinValue();
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "util.h"
+
+#include <memory>
+#include <vector>
+
+template <typename T> class BTreeNode;
+template <typename T> class BTreeLeafNode;
+template <typename T> class BTreeInternalNode;
+
+// Source of raw, uninitialized memory for BTree nodes. The tree constructs
+// and destroys the nodes itself, so an allocator only manages storage. Leaves
+// and internal nodes differ in size, and deallocate gets the size that was
+// requested from allocate.
+template <typename T> class BTreeNodeAllocator {
+public:
+  virtual ~BTreeNodeAllocator() = default;
+
+  virtual void* allocate(size_t size) = 0;
+
+  virtual void deallocate(void* memory, size_t size) = 0;
+};
+
+// Destroys a node and hands its memory back to the allocator it came from
+template <typename T> struct BTreeNodeDeleter {
+  void operator()(BTreeNode<T>* node) const;
+};
+
+template <typename T> using BTreeNodePtr = std::unique_ptr<BTreeNode<T>, BTreeNodeDeleter<T>>;
+
+// One heap allocation per node
+template <typename T> class BTreeNodeHeapAllocator final : public BTreeNodeAllocator<T> {
+public:
+  void* allocate(size_t size) override;
+
+  void deallocate(void* memory, size_t size) override;
+};
+
+// Carves nodes out of slabs of BTREE_ARENA_SLAB_NODES contiguous nodes of the
+// same size and recycles freed nodes through an intrusive free list per size.
+// Slabs are only released when the arena is destroyed.
+template <typename T> class BTreeNodeArena final : public BTreeNodeAllocator<T> {
+private:
+  struct FreeNode {
+    FreeNode* next;
+  };
+
+  struct SizeClass {
+    size_t size;
+    std::vector<Utility::BufferUniquePtr<char>> slabs;
+    size_t slabUsed;
+    FreeNode* freeList;
+  };
+
+  std::vector<SizeClass> sizeClasses;
+
+  static size_t alignment();
+
+  SizeClass& getSizeClass(size_t size);
+
+public:
+  void* allocate(size_t size) override;
+
+  void deallocate(void* memory, size_t size) override;
+
+  size_t getSlabCount() const;
+};
+
+#include "btree_allocator.cpp"
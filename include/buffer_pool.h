@@ -0,0 +1,95 @@
+#pragma once
+
+#include "async_io.h"
+#include "block_file.h"
+#include "optional.h"
+#include "util.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class BufferPool;
+class WriteAheadLog;
+
+// A pinned page. The page stays resident until the guard is destroyed or
+// released, and is written back on eviction if it was marked dirty.
+class PageGuard {
+private:
+  BufferPool* pool;
+  BlockFile* file;
+  size_t index;
+  char* data;
+  bool dirty;
+  uint64_t lsn;
+
+public:
+  PageGuard();
+  PageGuard(BufferPool* pool, BlockFile* file, size_t index, char* data);
+  PageGuard(const PageGuard& guard) = delete;
+  PageGuard(PageGuard&& guard);
+  PageGuard& operator=(PageGuard&& guard);
+  ~PageGuard();
+
+  char* getData() const;
+  size_t getIndex() const;
+  // lsn is the log record of the change, if it was logged
+  void markDirty(uint64_t lsn = 0);
+  void release();
+};
+
+struct BufferFrame {
+  BlockFile* file;
+  size_t index;
+  char* data;
+  size_t pinCount;
+  bool dirty;
+  bool referenced;
+  // Last log record that changed the page
+  uint64_t lsn;
+};
+
+typedef std::pair<const BlockFile*, size_t> PageId;
+
+struct PageIdHash {
+  size_t operator()(const PageId& pageId) const;
+};
+
+// Fixed-capacity page cache shared by every table and index. Frames are
+// pinned while in use and replaced with the CLOCK policy once unpinned.
+// With a log attached, a logged page is written back only after its log
+// records are durable.
+class BufferPool {
+private:
+  Utility::BufferUniquePtr<char> memory;
+  WriteAheadLog* log;
+  std::vector<BufferFrame> frames;
+  std::unordered_map<PageId, size_t, PageIdHash> pageTable;
+  size_t clockHand;
+  // Created on the first flush of everything
+  std::unique_ptr<AsyncIO> io;
+
+  Optional<size_t> findVictim();
+  bool writeBack(BufferFrame& frame);
+  Optional<PageGuard> pin(BlockFile& file, size_t index, bool load);
+
+public:
+  BufferPool(size_t frameCount);
+  BufferPool(const BufferPool& pool) = delete;
+  ~BufferPool();
+  static BufferPool& getInstance();
+
+  Optional<PageGuard> fetchPage(BlockFile& file, size_t index);
+  Optional<PageGuard> newPage(BlockFile& file);
+  void unpinPage(BlockFile& file, size_t index, bool dirty, uint64_t lsn = 0);
+  bool flushPage(BlockFile& file, size_t index);
+  bool flushFile(BlockFile& file);
+  bool evictFile(BlockFile& file);
+  bool flushAll();
+  void setLog(WriteAheadLog* log);
+  size_t getFrameCount() const;
+  size_t getResidentCount() const;
+};
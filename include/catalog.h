@@ -0,0 +1,37 @@
+#pragma once
+
+#include "column_info.h"
+#include "optional.h"
+#include "table.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// The tables of a database, read from its master table once on connect. The
+// master table stays open and every CREATE TABLE is written through to it,
+// so resolving a name or creating a table never reopens the file or scans
+// the catalog.
+class Catalog {
+private:
+  std::string database;
+  std::unique_ptr<Table> master;
+  std::unordered_map<std::string, TableSchema> schemas;
+
+  void load();
+
+public:
+  Catalog(const std::string& database);
+
+  // Parses the CREATE TABLE statement kept for a table in the master table
+  static Optional<TableSchema> parseSchema(const std::string& name, const std::string& createStatement);
+
+  const std::string& getDatabase() const;
+  size_t getTableCount() const;
+  // Files kept open by the master table
+  size_t getFileCount() const;
+  bool hasTable(const std::string& name) const;
+  Optional<const TableSchema*> getSchema(const std::string& name) const;
+  // Records a new table in the master table and the cache
+  bool addTable(const std::string& name, const TableSchema& schema, const std::string& createStatement);
+};
@@ -20,3 +20,15 @@ struct ColumnInfo {
 };
 
 typedef std::unordered_map<std::string, std::pair<size_t, ColumnInfo>> Columns;
+
+// How the rows of a table are laid out in its pages: whole records, or one
+// minipage per column (PAX)
+typedef enum {
+  ROW_LAYOUT,
+  PAX_LAYOUT,
+} PageLayout;
+
+struct TableSchema {
+  Columns columns;
+  PageLayout layout = ROW_LAYOUT;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "optimistic_lock.h"
+#include "optional.h"
+#include "parameters.h"
+
+#include <atomic>
+#include <type_traits>
+#include <vector>
+
+template <typename T> class ConcurrentBTree;
+
+template <typename T> struct ConcurrentBTreeNode {
+  OptimisticLock lock;
+  const bool leaf;
+  size_t count;
+
+  ConcurrentBTreeNode(bool leaf);
+};
+
+// Leaves are chained left to right through next, which range scans follow
+// without going back up the tree
+template <typename T> struct ConcurrentBTreeLeaf : public ConcurrentBTreeNode<T> {
+  static constexpr size_t capacity = (BLOCK_SIZE - sizeof(ConcurrentBTreeNode<T>) - sizeof(void*)) / sizeof(T);
+
+  ConcurrentBTreeLeaf* next;
+  T keys[capacity];
+
+  ConcurrentBTreeLeaf();
+
+  bool isFull() const;
+
+  size_t lowerBound(const T& key) const;
+
+  bool insert(const T& key);
+
+  ConcurrentBTreeLeaf* split(T& separator);
+};
+
+// keys[i] is the largest key of the subtree under children[i]
+template <typename T> struct ConcurrentBTreeInner : public ConcurrentBTreeNode<T> {
+  static constexpr size_t capacity = (BLOCK_SIZE - sizeof(ConcurrentBTreeNode<T>) - sizeof(void*)) / (sizeof(T) + sizeof(void*));
+
+  T keys[capacity];
+  ConcurrentBTreeNode<T>* children[capacity + 1];
+
+  ConcurrentBTreeInner();
+
+  bool isFull() const;
+
+  size_t lowerBound(const T& key) const;
+
+  void insert(const T& key, ConcurrentBTreeNode<T>* child);
+
+  ConcurrentBTreeInner* split(T& separator);
+};
+
+// Thread-safe B+Tree built on optimistic lock coupling. Readers never write
+// to shared memory and only validate node versions, writers latch the one or
+// two nodes they change. Full nodes are split eagerly on the way down, so a
+// split never has to climb back up. Removal does not merge nodes, which means
+// nodes are never unlinked and can be freed once, when the tree is destroyed.
+template <typename T> class ConcurrentBTree {
+private:
+  static_assert(std::is_trivially_copyable<T>::value, "Keys are read while being written and must be plain values");
+
+  std::atomic<ConcurrentBTreeNode<T>*> root;
+
+  void makeRoot(const T& separator, ConcurrentBTreeNode<T>* left, ConcurrentBTreeNode<T>* right);
+
+  ConcurrentBTreeLeaf<T>* findLeaf(const T& key, uint64_t& leafVersion, bool& needRestart);
+
+  static void yield(size_t restartCount);
+
+  static void freeNode(ConcurrentBTreeNode<T>* node);
+
+  bool validate(ConcurrentBTreeNode<T>* node, size_t depth, size_t& leafDepth, const T* minKey, const T* maxKey);
+
+  size_t countNodes(ConcurrentBTreeNode<T>* node);
+
+public:
+  ConcurrentBTree();
+  ConcurrentBTree(const ConcurrentBTree& other) = delete;
+  ~ConcurrentBTree();
+
+  // Returns false if the key was already present, in which case it is
+  // overwritten like in BTree::insert
+  bool insert(const T& key);
+
+  Optional<T> remove(const T& key);
+
+  Optional<T> search(const T& key);
+
+  Optional<std::vector<T>> searchRange(const T& minKey, const T& maxKey);
+
+  // The following are only meant for quiescent trees
+  bool validate();
+
+  size_t getHeight();
+
+  size_t countNodes();
+};
+
+#include "concurrent_btree.cpp"
@@ -1,9 +1,20 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include "optional.h"
 
+class Catalog;
+class TableCache;
+class PlanCache;
+
 struct Context {
   Optional<std::string> database;
   Optional<std::string*> statement;
+  // Tables of the connected database
+  std::shared_ptr<Catalog> catalog;
+  // Tables kept open across statements and connections
+  std::shared_ptr<TableCache> tables;
+  // Parsed statements, cached and prepared
+  std::shared_ptr<PlanCache> plans;
 };
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "block_file.h"
+#include "buffer_pool.h"
+#include "optional.h"
+#include "parameters.h"
+#include "storage_interface.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+template <typename K, typename V> class DiskBTree;
+
+// View over one BLOCK_SIZE index page. The node does not own the page; all
+// accessors read and write the page bytes in place.
+template <typename K, typename V> class DiskBTreeNode {
+private:
+  char* page;
+  friend class DiskBTree<K, V>;
+
+  DiskBTreeNode(char* page);
+
+  static size_t leafCapacity();
+
+  static size_t internalCapacity();
+
+  void init(bool leaf);
+
+  bool isLeaf() const;
+
+  size_t size() const;
+
+  void setSize(size_t size);
+
+  size_t getNext() const;
+
+  void setNext(size_t next);
+
+  K getKey(size_t index) const;
+
+  void setKey(size_t index, const K& key);
+
+  V getValue(size_t index) const;
+
+  void setValue(size_t index, const V& value);
+
+  size_t getChild(size_t index) const;
+
+  void setChild(size_t index, size_t child);
+
+  size_t lowerBound(const K& key) const;
+
+  size_t upperBound(const K& key) const;
+
+  void insertLeafEntry(size_t index, const K& key, const V& value);
+
+  void insertInternalEntry(size_t index, const K& key, size_t rightChild);
+
+  void removeLeafEntry(size_t index);
+};
+
+// B+Tree whose nodes are serialized into fixed BLOCK_SIZE pages of an index
+// file and address each other by page number, so the index persists across
+// restarts and only the pages on the search path are ever in memory.
+//
+// Index pages are not logged. Instead the tree is marked dirty on disk before
+// its first change after a save and clean again once save made every page
+// durable, so an index left dirty by a crash is known to be stale.
+template <typename K, typename V> class DiskBTree final : public StorageInterface {
+private:
+  BlockFile file;
+  size_t root;
+  size_t height;
+  bool dirty;
+
+  PageGuard fetchPage(size_t index);
+
+  PageGuard newPage();
+
+  void readMeta();
+
+  void writeMeta();
+
+  void setDirty();
+
+  Optional<std::pair<K, size_t>> insert(size_t pageIndex, const K& key, const V& value);
+
+  bool validate(size_t pageIndex, size_t depth, const K* minKey, const K* maxKey);
+
+  size_t countNodes(size_t pageIndex);
+
+public:
+  DiskBTree(const std::string& path);
+  ~DiskBTree();
+
+  bool insert(const K& key, const V& value);
+
+  Optional<V> remove(const K& key);
+
+  Optional<V> search(const K& key);
+
+  Optional<std::vector<std::pair<K, V>>> searchRange(const K& minKey, const K& maxKey);
+
+  bool validate();
+
+  size_t getHeight();
+
+  size_t countNodes();
+
+  // Whether the tree changed after its last save
+  bool isDirty() const;
+
+  void save();
+};
+
+#include "disk_btree.cpp"
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "stmt.h"
+#include "token.h"
+
+// EXECUTE name [(value, ...)], running a prepared statement with the values
+// as its parameters
+struct ExecuteStmt: public Stmt {
+  const std::string name;
+  // Views into the statement text, used before the text goes away
+  std::vector<Token> values;
+
+  ExecuteStmt(const std::string& name);
+  void accept(Visitor* visitor);
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "optional.h"
+#include "storage_interface.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Approximate free bytes of every block of a table file, kept in its own file
+// next to the table with one byte per block. A block's free space is rounded
+// down to a category of BLOCK_SIZE / FREE_SPACE_CATEGORIES bytes, and every
+// category keeps the list of its blocks, so finding a block with room for a
+// record looks at no more than FREE_SPACE_CATEGORIES lists.
+//
+// The map is a hint: a block may hold less than recorded after a crash, so
+// callers check the block itself and update the map when it is off.
+class FreeSpaceMap final : public StorageInterface {
+private:
+  const std::string path;
+  std::vector<uint8_t> categories;
+  std::vector<std::vector<size_t>> buckets;
+  // Position of each block in its bucket
+  std::vector<size_t> positions;
+  bool dirty;
+
+  void unlink(size_t block);
+  void link(size_t block, uint8_t category);
+
+public:
+  FreeSpaceMap(const std::string& path);
+
+  static uint8_t toCategory(size_t freeBytes);
+  size_t getBlockCount() const;
+  // A lower bound of the free bytes of block
+  size_t getFreeSpace(size_t block) const;
+  // Records the free bytes of block; block may be the next new block
+  void update(size_t block, size_t freeBytes);
+  // Some block with at least bytes free
+  Optional<size_t> find(size_t bytes) const;
+  void clear();
+  void save();
+};
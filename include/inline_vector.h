@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+
+// Vector with a fixed capacity whose elements live inside the object, so a
+// node embedding it needs no allocation of its own. Iterators are pointers.
+template <typename T, size_t N> class InlineVector {
+private:
+  alignas(T) unsigned char storage[N * sizeof(T)];
+  size_t count;
+
+public:
+  InlineVector();
+  InlineVector(const InlineVector& other) = delete;
+  InlineVector& operator=(const InlineVector& other) = delete;
+  ~InlineVector();
+
+  static constexpr size_t capacity() { return N; }
+
+  size_t size() const;
+
+  bool empty() const;
+
+  T* data();
+
+  const T* data() const;
+
+  T* begin();
+
+  T* end();
+
+  const T* begin() const;
+
+  const T* end() const;
+
+  T& operator[](size_t index);
+
+  const T& operator[](size_t index) const;
+
+  T& back();
+
+  void push_back(T value);
+
+  void pop_back();
+
+  T* insert(T* position, T value);
+
+  T* erase(T* position);
+
+  template <typename Iterator> void assign(Iterator first, Iterator last);
+
+  void resize(size_t size);
+
+  void clear();
+};
+
+#include "inline_vector.cpp"
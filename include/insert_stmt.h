@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "stmt.h"
+
+struct InsertStmt: public Stmt {
+  const std::string table;
+  // Empty when the statement does not name its columns
+  std::vector<std::string> columns;
+  std::vector<std::vector<std::string>> rows;
+
+  InsertStmt(const std::string& table);
+  void accept(Visitor* visitor);
+  // Values are numbered row by row
+  void bind(const std::vector<const Token*>& values, size_t first);
+  std::unique_ptr<Stmt> clone() const;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Version latch for optimistic lock coupling. Bit 0 marks the node obsolete,
+// bit 1 is the exclusive lock and the remaining bits count modifications.
+// Readers take no lock: they remember the version, read, and then check that
+// the version did not move. Any failed step sets needRestart and the whole
+// operation starts over from the root.
+class OptimisticLock {
+private:
+  std::atomic<uint64_t> version;
+
+  static bool isLocked(uint64_t version);
+
+  static bool isObsolete(uint64_t version);
+
+public:
+  OptimisticLock();
+
+  uint64_t readLockOrRestart(bool& needRestart) const;
+
+  void checkOrRestart(uint64_t startVersion, bool& needRestart) const;
+
+  void readUnlockOrRestart(uint64_t startVersion, bool& needRestart) const;
+
+  void upgradeToWriteLockOrRestart(uint64_t& startVersion, bool& needRestart);
+
+  void writeLockOrRestart(bool& needRestart);
+
+  void writeUnlock();
+
+  void writeUnlockObsolete();
+};
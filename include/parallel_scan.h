@@ -0,0 +1,33 @@
+#pragma once
+
+#include "table.h"
+#include "vector_executor.h"
+
+#include <atomic>
+#include <ostream>
+#include <vector>
+
+// Aggregates a table on several threads. The blocks of the table are cut
+// into morsels of PARALLEL_SCAN_MORSEL_BLOCKS blocks, which the workers take
+// in order from a shared counter until none is left, so a slow morsel does
+// not hold the others back. Every worker filters and aggregates its morsels
+// with its own VectorExecutor and keeps the result to itself; the results
+// are merged once all workers are done.
+class ParallelScan {
+private:
+  Table& table;
+  const SelectPlan& plan;
+  const size_t workerCount;
+  size_t blockCount;
+  std::atomic<size_t> nextMorsel;
+
+  void work(std::vector<AggregateValue>& values);
+
+public:
+  // workerCount 0 picks one worker per hardware thread
+  ParallelScan(Table& table, const SelectPlan& plan, size_t workerCount = 0);
+
+  std::vector<AggregateValue> aggregate();
+  // Writes the aggregate names and values as one row
+  void run(std::ostream& out);
+};
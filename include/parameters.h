@@ -4,6 +4,25 @@
 #include <string>
 
 #define BLOCK_SIZE 8192
+#define BUFFER_POOL_FRAMES 1024
+#define TABLE_SCAN_READ_AHEAD 32
+#define TABLE_SCAN_IO_DEPTH 8
+#define VECTOR_BATCH_SIZE ((size_t)1024)
+#define PARALLEL_SCAN_MORSEL_BLOCKS ((size_t)16)
+#define ASYNC_IO_DEPTH 64
+#define ASYNC_IO_WORKERS 4
+#define TABLE_STORAGE_MODE BlockFile::BUFFERED
+#define TABLE_CACHE_FILES ((size_t)128)
+#define PLAN_CACHE_SIZE ((size_t)256)
+#define SCRIPT_READ_CHUNK_SIZE ((size_t)1 << 16)
+#define FREE_SPACE_CATEGORIES 256
+#define MMAP_RESERVED_BLOCKS ((size_t)1 << 20)
+#define MMAP_GROW_BLOCKS 256
+#define WAL_FILE_NAME "verdant.wal"
+#define WAL_CHECKPOINT_SIZE ((size_t)16 << 20)
+#define BTREE_FILL_FACTOR 1.0
+#define BTREE_ARENA_SLAB_NODES 64
 #define MAX_OBJECT_NAME 100
+#define MAX_INDEX_KEY_SIZE 128
 #define MAX_CREATE_STATEMENT_SIZE 255
 #define DATA_PATH "~/.verdant/"
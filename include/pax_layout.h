@@ -0,0 +1,65 @@
+#pragma once
+
+#include "record_layout.h"
+#include "wal.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Geometry of the pages of a PAX table. A page holds up to getCapacity()
+// rows, split into one minipage per column:
+//
+//   rowCount | heapStart | (nullBitmap | values)[] | blank | varchar heap
+//
+// INT and FLOAT minipages are contiguous arrays of 4-byte values, so a scan
+// reads only the columns it needs and loops over them directly. A VARCHAR
+// minipage holds an (offset, length) pair of uint16_t per row into the heap,
+// which grows down from the end of the page. Every minipage starts 8-byte
+// aligned. The capacity assumes VARCHAR values half as long as declared.
+// Rows arrive as records encoded by the table's RecordLayout.
+class PaxLayout {
+private:
+  const RecordLayout& layout;
+  size_t capacity;
+  std::vector<size_t> bitmapOffsets;
+  std::vector<size_t> valueOffsets;
+  size_t minipagesEnd;
+  // Bytes of the values minipages take per row
+  size_t rowSize;
+  bool hasVariable;
+  // Whether the minipages for one row and its estimated heap fit in a page
+  bool usable;
+
+  size_t place(size_t capacity);
+  static size_t readHeapStart(const char* block);
+
+public:
+  static constexpr size_t HEADER_SIZE = 2 * sizeof(size_t);
+  static constexpr size_t SLOT_SIZE = 2 * sizeof(uint16_t);
+
+  PaxLayout(const RecordLayout& layout);
+
+  size_t getCapacity() const;
+  // A table whose columns do not leave room for even one row per page is
+  // rejected when it is created
+  bool isUsable() const;
+  const RecordLayout& getRecordLayout() const;
+  static size_t readRowCount(const char* block);
+  // Space left, comparable with getRequiredSpace; 0 once every row is taken
+  size_t getFreeSpace(const char* block) const;
+  size_t getRequiredSpace(const char* record) const;
+  bool isEnoughSpace(const char* block, const char* record) const;
+  // Whether the record fits in an empty page
+  bool isFitting(const char* record) const;
+  // Appends a row, returning the ranges of the page it changed
+  std::vector<PageRange> addRow(char* block, const char* record) const;
+
+  bool isNull(const char* block, size_t row, size_t column) const;
+  // The minipage of a column: 4-byte values for INT and FLOAT, slots for
+  // VARCHAR. NULL rows hold zero.
+  const char* getColumn(const char* block, size_t column) const;
+  std::pair<const char*, size_t> getValue(const char* block, size_t row, size_t column) const;
+  // Encodes a row back into a record of the RecordLayout
+  void readRow(const char* block, size_t row, std::vector<char>& record) const;
+};
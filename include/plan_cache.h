@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ast.h"
+#include "optional.h"
+#include "parameters.h"
+#include "token.h"
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Parsed statements kept for reuse. INSERT and SELECT statements are cached
+// under their token stream with every literal replaced by '?', and parsed
+// with every literal as a parameter, so a statement of the same shape with
+// other literals only binds them instead of being parsed again. A cached
+// statement is never changed: each run binds a copy of it, and the copies of
+// a SELECT share the plan built on its first run. At most capacity
+// statements are cached, dropping the least recently used.
+//
+// Statements named by PREPARE are kept apart until replaced.
+class PlanCache {
+private:
+  struct Entry {
+    std::string key;
+    std::shared_ptr<AST> ast;
+  };
+
+  size_t capacity;
+  // Most recently used first
+  std::list<Entry> entries;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index;
+  std::unordered_map<std::string, std::shared_ptr<AST>> prepared;
+
+  static bool isCacheable(const std::vector<Token>& tokens);
+  static std::string normalize(const std::vector<Token>& tokens);
+  static void sharePlans(AST& ast);
+  void add(const std::string& key, std::shared_ptr<AST> ast);
+
+public:
+  PlanCache(size_t capacity = PLAN_CACHE_SIZE);
+
+  // The AST of the statements, bound to their literals
+  Optional<std::shared_ptr<AST>> parse(const std::vector<Token>& tokens);
+  static size_t getParameterCount(const AST& ast);
+  // A copy of a cached or prepared AST with the parameters of every
+  // statement set in order. Fails with INVALID_SYNTAX if the count of values
+  // is not the count of parameters, and with INVALID_TYPE if a value is not a
+  // literal or a number is out of range.
+  static Optional<std::shared_ptr<AST>> bind(const AST& ast, const std::vector<const Token*>& values);
+  size_t getSize() const;
+
+  void prepare(const std::string& name, std::shared_ptr<AST> ast);
+  Optional<std::shared_ptr<AST>> getPrepared(const std::string& name);
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "ast.h"
+#include "stmt.h"
+
+// PREPARE name AS statement, where the statement takes '?' parameters
+struct PrepareStmt: public Stmt {
+  const std::string name;
+  std::shared_ptr<AST> statement;
+
+  PrepareStmt(const std::string& name, std::shared_ptr<AST> statement);
+  void accept(Visitor* visitor);
+};
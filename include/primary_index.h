@@ -0,0 +1,56 @@
+#pragma once
+
+#include "column_info.h"
+#include "disk_btree.h"
+#include "field.h"
+#include "optional.h"
+#include "parameters.h"
+#include "storage_interface.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+typedef std::pair<size_t, size_t> Location;
+
+// Zero-padded VARCHAR key. Padding with '\0' keeps memcmp order equal to
+// the lexicographic order of the strings.
+struct VarcharKey {
+  char value[MAX_INDEX_KEY_SIZE];
+
+  bool operator<(const VarcharKey& rhs) const;
+  bool operator==(const VarcharKey& rhs) const;
+  bool operator!=(const VarcharKey& rhs) const;
+};
+
+// Maps the primary key of every record of a table to its Location. The key
+// type of the underlying DiskBTree is chosen from the primary column type.
+class PrimaryIndex : public StorageInterface {
+public:
+  virtual ~PrimaryIndex() = default;
+  virtual Optional<Location> search(Field& key) = 0;
+  virtual bool insert(Field& key, Location location) = 0;
+  // Inserts a key given as its serialized value, as stored in a record
+  virtual bool insert(std::pair<const char*, size_t> value, Location location) = 0;
+  // Whether the index changed after its last save
+  virtual bool isDirty() = 0;
+
+  static std::unique_ptr<PrimaryIndex> create(const std::string& path, const ColumnInfo& column);
+};
+
+template <typename K> class TypedPrimaryIndex final : public PrimaryIndex {
+private:
+  DiskBTree<K, Location> tree;
+  const ColumnInfo column;
+
+  Optional<K> toKey(Field& field);
+  static K toKey(std::pair<const char*, size_t> value);
+
+public:
+  TypedPrimaryIndex(const std::string& path, const ColumnInfo& column);
+  Optional<Location> search(Field& key);
+  bool insert(Field& key, Location location);
+  bool insert(std::pair<const char*, size_t> value, Location location);
+  bool isDirty();
+  void save();
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "column_info.h"
+#include "optional.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Encoding of the records of one table, derived from its columns:
+//
+//   nullBitmap | fixed-width values | varint lengths | variable-width values
+//
+// The null bitmap has one bit per column. INT and FLOAT values sit at offsets
+// fixed by the schema, NULL or not, so they are read without looking at the
+// rest of the record. Every VARCHAR column has a varint length, in column
+// order, followed by the bytes of all of them back to back.
+class RecordLayout {
+private:
+  std::vector<std::pair<std::string, ColumnInfo>> columns;
+  // Byte offset of a fixed-width column, position among the VARCHAR columns
+  // otherwise
+  std::vector<size_t> offsets;
+  size_t bitmapSize;
+  size_t fixedSize;
+  size_t variableCount;
+
+public:
+  RecordLayout(const Columns& columns);
+
+  static size_t getVarintSize(size_t value);
+  static size_t writeVarint(char* destination, size_t value);
+  static size_t readVarint(const char* source, size_t& value);
+
+  size_t getColumnCount() const;
+  const std::string& getName(size_t column) const;
+  const ColumnInfo& getInfo(size_t column) const;
+  // Size of the record with the given VARCHAR lengths
+  size_t getSize(const std::vector<size_t>& variableLengths) const;
+  // Largest possible record
+  size_t getMaxSize() const;
+
+  // Writes a record into destination, which holds getSize bytes. values holds
+  // the serialized value of every column, a null data pointer for NULL.
+  void encode(const std::vector<std::pair<const char*, size_t>>& values, char* destination) const;
+  bool isNull(const char* record, size_t column) const;
+  // The bytes of a value; the value must not be NULL
+  std::pair<const char*, size_t> getValue(const char* record, size_t column) const;
+};
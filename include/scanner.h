@@ -3,20 +3,26 @@
 #include "token.h"
 #include <vector>
 #include <string>
+#include <string_view>
 
 #include "optional.h"
 
 std::ostream& operator<<(std::ostream& os, const Token& obj);
 
+// Splits a statement into tokens that view the text, without copying it
 class Scanner {
 private:
   size_t ptr;
   size_t line;
-  const std::string& text;
+  std::string_view text;
 
   void skipBlank();
+  static Token::TokenType getKeyword(std::string_view word);
 
 public:
-  Scanner(const std::string& text);
+  Scanner(std::string_view text);
+  // Clears tokens and scans into them, so a buffer kept across statements
+  // is not allocated again. False on a syntax error.
+  bool scan(std::vector<Token>& tokens);
   Optional<std::vector<Token>> scan();
 };
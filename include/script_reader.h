@@ -0,0 +1,28 @@
+#pragma once
+
+#include "parameters.h"
+
+#include <istream>
+#include <string>
+#include <vector>
+
+// Splits a SQL script into statements as it reads it, a chunk at a time, so
+// only the chunk and the statement being read are held in memory. A
+// statement ends at a ';' outside a string literal and may span lines; a
+// command starting with '\' ends at the end of its line.
+class ScriptReader {
+private:
+  std::istream& in;
+  std::vector<char> chunk;
+  size_t position;
+  size_t end;
+
+  bool fill();
+
+public:
+  ScriptReader(std::istream& in, size_t chunkSize = SCRIPT_READ_CHUNK_SIZE);
+
+  // Reads the next statement into statement, reusing its storage. A last
+  // statement without ';' is returned too. False at the end of the script.
+  bool next(std::string& statement);
+};
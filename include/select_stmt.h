@@ -0,0 +1,63 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "stmt.h"
+
+// A comparison of a column with a literal
+struct Condition {
+  typedef enum {
+    EQUAL,
+    NOT_EQUAL,
+    LESS,
+    LESS_EQUAL,
+    GREATER,
+    GREATER_EQUAL,
+  } Operator;
+
+  std::string column;
+  Operator op;
+  std::string value;
+  bool isString;
+};
+
+// COUNT(*), COUNT(column) or SUM(column)
+struct Aggregate {
+  typedef enum {
+    COUNT,
+    SUM,
+  } Function;
+
+  Function function;
+  // Empty for COUNT(*)
+  std::string column;
+};
+
+struct SelectPlan;
+
+// The plan of a cached or prepared statement, built on its first run and
+// shared by the copies the statement is bound into. Tables of the same name
+// in other databases differ, so the plan only holds in its database.
+struct SharedPlan {
+  std::string database;
+  std::shared_ptr<const SelectPlan> plan;
+};
+
+struct SelectStmt: public Stmt {
+  const std::string table;
+  // Empty for SELECT * and for aggregates
+  std::vector<std::string> columns;
+  std::vector<Aggregate> aggregates;
+  // All of them hold for a selected row
+  std::vector<Condition> conditions;
+  // Set when the statement is cached or prepared
+  std::shared_ptr<SharedPlan> sharedPlan;
+
+  SelectStmt(const std::string& table);
+  void accept(Visitor* visitor);
+  // The value of condition i is value i
+  void bind(const std::vector<const Token*>& values, size_t first);
+  std::unique_ptr<Stmt> clone() const;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+// Key types whose in-node search goes through simdLowerBound instead of the
+// generic binary search
+template <typename T> struct SimdSearchable : std::false_type {};
+template <> struct SimdSearchable<int> : std::true_type {};
+template <> struct SimdSearchable<long> : std::true_type {};
+template <> struct SimdSearchable<long long> : std::true_type {};
+template <> struct SimdSearchable<float> : std::true_type {};
+template <> struct SimdSearchable<double> : std::true_type {};
+
+// Index of the first of size ascending values that is not less than value.
+// A branchless binary search narrows the range down to a small window that
+// is then counted with AVX2 compares when the CPU supports them.
+template <typename T> size_t simdLowerBound(const T* values, size_t size, const T& value);
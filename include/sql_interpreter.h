@@ -1,17 +1,28 @@
 #pragma once
 
 #include "visitor.h"
+#include "column_info.h"
 #include "context.h"
+#include "optional.h"
 
 #include <ast.h>
 #include <status.h>
 
+class RecordLayout;
+struct SelectPlan;
+
 class SQLInterpreter final: public Visitor {
 private:
   VerdantStatus::StatusEnum status;
   void visit(const CreateStmt* node);
+  void visit(const InsertStmt* node);
+  void visit(const SelectStmt* node);
+  void visit(const PrepareStmt* node);
+  void visit(const ExecuteStmt* node);
   void visit(const DatabaseNode* node);
   void visit(const TableNode* node);
+  Optional<const TableSchema*> loadSchema(const std::string& table);
+  Optional<SelectPlan> getPlan(const SelectStmt& node, const RecordLayout& layout);
   const AST& ast;
   Context& context;
 
@@ -2,6 +2,7 @@
 
 #include "ast.h"
 #include "ast_node.h"
+#include "select_stmt.h"
 #include "optional.h"
 #include "token.h"
 #include <memory>
@@ -13,6 +14,10 @@ class SQLParser {
 private:
   size_t ptr;
   const std::vector<Token>& tokens;
+  // Whether every literal value becomes a parameter, for the plan cache
+  const bool parameterizeLiterals;
+  // Whether '?' parameters are allowed, inside PREPARE
+  bool isPreparing;
   
   Optional<const Token*> consume(Token::TokenType type, const std::string& message);
   Optional<const Token*> multiConsume(const std::vector<Token::TokenType>& types, const std::string& message);
@@ -22,11 +27,17 @@ private:
   OptionalNode error(const std::string& message);
   OptionalNode stmt();
   OptionalNode createStmt();
+  OptionalNode insertStmt();
+  OptionalNode selectStmt();
+  OptionalNode prepareStmt();
+  OptionalNode executeStmt();
+  Optional<const Token*> value(std::vector<size_t>& parameters, size_t position, const std::string& message);
+  bool aggregate(Aggregate::Function function, std::vector<Aggregate>& aggregates);
   bool match(Token::TokenType type);
   Optional<Token::TokenType> multiMatch(const std::vector<Token::TokenType>& types);
   bool checkCurrentType(Token::TokenType);
 
 public:
-  SQLParser(const std::vector<Token>& tokens);
+  SQLParser(const std::vector<Token>& tokens, bool parameterizeLiterals = false);
   Optional<AST> parse();
 };
@@ -14,6 +14,7 @@ public:
     OUT_OF_BOUND,
     UNSPECIFIED_DATABASE,
     UNIMPLEMENTED,
+    OUT_OF_MEMORY,
     GENERIC_ERROR,
   } StatusEnum;
 
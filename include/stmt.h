@@ -1,7 +1,19 @@
 #pragma once
 
 #include "ast_node.h"
+#include "token.h"
+
+#include <memory>
+#include <vector>
 
 struct Stmt: public ASTNode {
-};
+  // Positions, among the values of the statement in the order they appear,
+  // that are parameters. Increasing.
+  std::vector<size_t> parameters;
 
+  // Sets the parameters from values[first], values[first + 1], ...
+  virtual void bind(const std::vector<const Token*>& values, size_t first);
+  // A copy to bind parameters into. nullptr for statements that are never
+  // cached or prepared.
+  virtual std::unique_ptr<Stmt> clone() const;
+};
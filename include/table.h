@@ -1,65 +1,169 @@
 #pragma once
 
+#include "async_io.h"
+#include "block_file.h"
+#include "buffer_pool.h"
 #include "column_info.h"
 #include "context.h"
 #include "field.h"
+#include "free_space_map.h"
 #include "optional.h"
+#include "pax_layout.h"
 #include "parameters.h"
+#include "primary_index.h"
+#include "record_layout.h"
 #include "storage_interface.h"
 #include "util.h"
+#include "wal.h"
 
-#include <fstream>
+#include <cstdint>
 #include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 typedef std::pair<const char *, size_t> BinaryRecord;
 typedef std::pair<Utility::BufferUniquePtr<char>, size_t> Buffer;
 typedef Optional<Buffer> OptionalBuffer;
-typedef std::pair<size_t, size_t> Location;
 
+// One block of a table file. The block is pinned in the buffer pool, or for a
+// mapped file points straight into the mapping. Blocks of a PAX table are
+// laid out by pax and their rows are read back as records through row.
 struct TableBlock final : public StorageInterface {
-  char block[BLOCK_SIZE];
-  std::fstream &file;
+  BlockFile &file;
   const size_t index;
-  size_t recordCount;
-  size_t nextAddress;
+  PageGuard page;
+  char *block;
+  // Log record of the last change, 0 if none
+  uint64_t lsn;
+  const PaxLayout *pax;
+  std::vector<char> row;
 
-  TableBlock(std::fstream &file, size_t index);
-  // Index, address, buffer
-  std::vector<std::tuple<size_t, size_t, Buffer>> changes;
+  TableBlock(BlockFile &file, size_t index, const PaxLayout *pax = nullptr);
 
   size_t getBookkeepLocation();
-  size_t getRecordCountOnFile();
-  size_t getNextAddressOnFile();
+  size_t getRecordCount();
+  size_t getNextAddress();
+  void setRecordCount(size_t recordCount);
+  void setNextAddress(size_t nextAddress);
   Optional<size_t> getRecordAddress(size_t index);
 
+  size_t getFreeSpace();
   bool isEnoughSpace(Buffer &buffer);
   bool addRecord(Buffer &&buffer);
   Optional<BinaryRecord> getRecord(size_t index);
+  static size_t readRecordCount(const char *block);
+  static Optional<BinaryRecord> readRecord(const char *block, size_t index);
   void saveRecordPointer(size_t index, size_t pointer);
   void save();
 };
 
+// Streams every record of a table file in block order. Blocks are read
+// TABLE_SCAN_READ_AHEAD at a time with one sequential read into a private
+// buffer, bypassing the buffer pool, so a scan neither pays a read per page
+// nor evicts the pages other statements are working on. With an I/O depth
+// above one, that many reads are kept in flight through an AsyncIO engine
+// while the scan works on the blocks already read. Records are views into
+// the buffer and stay valid until the scan moves past their block.
+// Mapped files skip the buffer and are scanned straight from the mapping.
+// A scan can be limited to a range of blocks, e.g. one morsel of a parallel
+// scan.
+// The rows of PAX blocks are returned as records encoded into row; column
+// scans take whole blocks with nextPage instead.
+class TableScanner {
+private:
+  BlockFile &file;
+  const PaxLayout *pax;
+  std::vector<char> row;
+  const size_t firstBlock;
+  const size_t endBlock;
+  Utility::BufferUniquePtr<char> buffer;
+  const char *blocks;
+  const size_t readAhead;
+  size_t nextBlock;
+  size_t bufferedBlocks;
+  size_t bufferIndex;
+  size_t recordIndex;
+  size_t nextRead;
+  size_t currentChunk;
+  std::vector<IORequest> chunks;
+  // Declared after the buffer, so the reads in flight end before it is freed
+  std::unique_ptr<AsyncIO> io;
+
+  bool fill();
+  void requestChunk(size_t chunk);
+  size_t getEndBlock() const;
+
+public:
+  TableScanner(BlockFile &file, size_t readAhead = TABLE_SCAN_READ_AHEAD,
+               size_t ioDepth = TABLE_SCAN_IO_DEPTH, const PaxLayout *pax = nullptr,
+               size_t firstBlock = 0, size_t endBlock = SIZE_MAX);
+  Optional<BinaryRecord> next();
+  // The next whole block, valid until the following call. Not to be mixed
+  // with next.
+  Optional<const char *> nextPage();
+  size_t getBlockIndex() const;
+};
+
 class Table final : public StorageInterface {
 private:
-  std::fstream file;
-  std::unordered_map<size_t, std::unique_ptr<TableBlock>> loadedBlocks;
+  // First, so the log is replayed before the table file is opened
+  WriteAheadLog &log;
+  BlockFile file;
+  FreeSpaceMap freeSpace;
   Columns columns;
+  RecordLayout layout;
+  // Set for a PAX table
+  std::unique_ptr<PaxLayout> pax;
   Optional<Context *> context;
+  // Highest LSN written into the mapping of a mapped file, 0 if none
+  uint64_t mappedLsn;
+  std::string primaryColumn;
+  std::unique_ptr<PrimaryIndex> primaryIndex;
 
-  Optional<TableBlock *> getBlock(size_t index);
+  void openPrimaryIndex();
+  void rebuildPrimaryIndex(const ColumnInfo &column);
+  void flushLog();
+  Optional<std::unique_ptr<TableBlock>> getBlock(size_t index);
+  std::unique_ptr<TableBlock> findBlock(Buffer &buffer);
+  size_t getRequiredSpace(Buffer &buffer);
+  void loadFreeSpace();
   OptionalBuffer createBuffer(std::vector<Field> &fields);
+  Field *getPrimaryField(std::vector<Field> &fields);
+  bool checkRecord(std::vector<Field> &fields, Buffer &buffer);
+  void placeRecord(std::vector<Field> &fields, Buffer &&buffer,
+                   std::unique_ptr<TableBlock> &block);
   bool addRecordToField(std::vector<Field> &fields, Location location);
+  void commit(std::unique_ptr<TableBlock> &block);
 
 public:
-  Table(Context *context, const std::string &name, Columns &&columns);
+  // A MAPPED table keeps its file mmap-ed and works on the blocks in place
+  // instead of going through the buffer pool. The page layout is fixed when
+  // the table is created and must be given the same every time it is opened.
+  Table(Context *context, const std::string &name, Columns &&columns,
+        BlockFile::Mode mode = TABLE_STORAGE_MODE, PageLayout pageLayout = ROW_LAYOUT);
   Table(const std::string &database, const std::string &name,
-        Columns &&columns);
+        Columns &&columns, BlockFile::Mode mode = TABLE_STORAGE_MODE,
+        PageLayout pageLayout = ROW_LAYOUT);
   static std::unique_ptr<Table> createMasterTable(const std::string &database);
   static std::unique_ptr<Table> getMasterTable(const std::string &database);
   ~Table();
   void save();
   bool addRecord(std::vector<Field> &fields);
+  size_t addRecords(std::vector<std::vector<Field>> &records);
+  Optional<Location> findRecord(Field &key);
+  Optional<std::vector<Field>> getRecord(Location location);
+  std::unique_ptr<TableScanner> scan();
+  // Writes the dirty blocks of the table back, so its file can be scanned
+  void flushBlocks();
+  // A synchronous scan of blocks [firstBlock, endBlock) that leaves the
+  // buffer pool alone, so worker threads can scan a flushed table at once
+  std::unique_ptr<TableScanner> scanBlocks(size_t firstBlock, size_t endBlock);
+  size_t getBlockCount();
+  // Files the table keeps open: the table file, and the index file of a
+  // table with a primary key
+  size_t getFileCount() const;
+  const RecordLayout &getLayout() const;
+  // nullptr unless the table is PAX
+  const PaxLayout *getPaxLayout() const;
+  std::vector<Field> parseRecord(BinaryRecord record);
 };
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "column_info.h"
+#include "parameters.h"
+#include "table.h"
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Tables kept open across statements, keyed by database and table, so a
+// statement reuses the open table file, index and cached pages instead of
+// opening them again. The capacity is a budget of file descriptors, since
+// those run out first: a table holds one per file it keeps open. Descriptors
+// reserved for tables opened elsewhere, like the master table of the
+// connected database, count against it too. The least recently used table
+// nobody holds is closed to stay within the budget.
+class TableCache {
+private:
+  struct Entry {
+    std::string key;
+    std::shared_ptr<Table> table;
+    size_t files;
+  };
+
+  size_t capacity;
+  size_t reserved;
+  // Descriptors held by the cached tables
+  size_t files;
+  // Most recently used first
+  std::list<Entry> entries;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index;
+
+  static std::string getKey(const std::string& database, const std::string& name);
+  void evict();
+
+public:
+  TableCache(size_t capacity = TABLE_CACHE_FILES);
+
+  // The open table, opening it with the schema if it is not cached
+  std::shared_ptr<Table> open(const std::string& database, const std::string& name, const TableSchema& schema);
+  bool isOpen(const std::string& database, const std::string& name) const;
+  size_t getSize() const;
+  size_t getFileCount() const;
+  // Sets the descriptors held outside the cache, closing tables to make room
+  void reserve(size_t files);
+  // Closes every table
+  void clear();
+};
@@ -10,6 +10,7 @@ private:
 public:
   TableNode(const std::string& name);
   Columns columns;
+  PageLayout layout = ROW_LAYOUT;
 
   const std::string& getName() const;
   const VerdantObjectType getType() const;
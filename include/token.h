@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 
 struct Token {
   typedef enum {
@@ -12,20 +13,43 @@ struct Token {
     TOKEN_VARCHAR,
     TOKEN_PRIMARY,
     TOKEN_KEY,
+    TOKEN_INSERT,
+    TOKEN_INTO,
+    TOKEN_VALUES,
+    TOKEN_LAYOUT,
+    TOKEN_SELECT,
+    TOKEN_FROM,
+    TOKEN_WHERE,
+    TOKEN_AND,
+    TOKEN_COUNT,
+    TOKEN_SUM,
+    TOKEN_PREPARE,
+    TOKEN_EXECUTE,
+    TOKEN_AS,
     TOKEN_INT_VALUE,
     TOKEN_FLOAT_VALUE,
+    TOKEN_STRING_VALUE,
+    TOKEN_PARAMETER,
     TOKEN_IDENTIFIER,
     TOKEN_SEMICOLON,
     TOKEN_COMMA,
     TOKEN_LEFT_PAREN,
     TOKEN_RIGHT_PAREN,
     TOKEN_BACK_SLASH,
+    TOKEN_STAR,
+    TOKEN_EQUAL,
+    TOKEN_NOT_EQUAL,
+    TOKEN_LESS,
+    TOKEN_LESS_EQUAL,
+    TOKEN_GREATER,
+    TOKEN_GREATER_EQUAL,
   } TokenType;
 
   const TokenType type;
-  const std::string value;
+  // A view into the scanned text, valid while the text is
+  const std::string_view value;
   const size_t line;
 
-  Token(TokenType type, std::string value, size_t line);
+  Token(TokenType type, std::string_view value, size_t line);
   std::string toString();
 };
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <memory>
+#include <string_view>
 
 namespace Utility {
   struct DeleteByFree {
@@ -10,11 +11,18 @@ namespace Utility {
   template<class T> using BufferUniquePtr = std::unique_ptr<T, DeleteByFree>;
   
   std::string toLower(const std::string& str);
+  // Compares without allocating; lower must be lowercase
+  bool equalsLower(std::string_view str, std::string_view lower);
   bool createDirectory(const std::string& path);
   bool isDirectoryExist(const std::string& path);
   bool isAlpha(const char c);
   bool isFloat(const std::string& str);
   bool isInteger(const std::string& str);
+  // The whole string as a number; false on junk or a value out of range,
+  // where std::stoi and std::stof would throw
+  bool parseInt(std::string_view str, int& value);
+  bool parseFloat(std::string_view str, float& value);
+  std::string getDataPath();
   std::string getDatabasePath(const std::string& database);
 }
 
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "column_info.h"
+#include "optional.h"
+#include "pax_layout.h"
+#include "record_layout.h"
+#include "select_stmt.h"
+#include "table.h"
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Values of one column for the rows of a batch. NULL rows are flagged in
+// nulls and hold zero or an empty string.
+struct ColumnVector {
+  ColumnInfo::ColumnType type;
+  std::vector<int> ints;
+  std::vector<float> floats;
+  // VARCHAR values back to back, value i from offsets[i] to offsets[i + 1]
+  std::string bytes;
+  std::vector<uint32_t> offsets;
+  std::vector<uint8_t> nulls;
+
+  void clear();
+  void append(const char* value, size_t size);
+  void appendNull();
+  std::string_view getString(size_t row) const;
+  std::string toString(size_t row) const;
+};
+
+// Up to VECTOR_BATCH_SIZE rows of the columns a query reads. selection holds
+// the indexes of the rows still selected, in increasing order.
+struct Batch {
+  size_t size;
+  std::vector<ColumnVector> columns;
+  std::vector<uint32_t> selection;
+};
+
+// A condition resolved to a column of the batch, with its literal parsed to
+// the type of the column
+struct Predicate {
+  size_t column;
+  Condition::Operator op;
+  int intValue;
+  float floatValue;
+  std::string stringValue;
+};
+
+// An aggregate resolved to a column of the batch, or NO_COLUMN for COUNT(*)
+struct AggregatePlan {
+  static constexpr size_t NO_COLUMN = SIZE_MAX;
+
+  Aggregate::Function function;
+  size_t column;
+};
+
+// Running value of an aggregate. count is the number of rows added, sums
+// are kept in the widest type of the column.
+struct AggregateValue {
+  size_t count = 0;
+  long long intSum = 0;
+  double floatSum = 0;
+
+  void merge(const AggregateValue& value);
+};
+
+// What a SELECT reads and keeps. columns are columns of the table's
+// RecordLayout; the projection, predicates and aggregates refer to positions
+// in columns. A plan with aggregates has no projection.
+struct SelectPlan {
+  std::vector<size_t> columns;
+  std::vector<size_t> projection;
+  std::vector<Predicate> predicates;
+  std::vector<AggregatePlan> aggregates;
+
+  static Optional<SelectPlan> create(const RecordLayout& layout, const SelectStmt& stmt);
+  // Sets the values of the predicates from the conditions of a statement of
+  // the same shape as the one the plan was created from, false if a value
+  // does not match its column
+  bool bind(const RecordLayout& layout, const std::vector<Condition>& conditions);
+  std::string getAggregateName(const RecordLayout& layout, size_t aggregate) const;
+  std::string formatAggregate(const RecordLayout& layout, size_t aggregate, const AggregateValue& value) const;
+};
+
+// Runs a SelectPlan over a table a batch at a time. Only the columns of the
+// plan are decoded, straight from the minipages for a PAX table. Predicates
+// run as one loop per predicate over a whole batch, specialized for the
+// column type and operator, and narrow the selection vector in place, so
+// nothing is dispatched per row.
+class VectorExecutor {
+private:
+  const SelectPlan& plan;
+  const RecordLayout& layout;
+  const PaxLayout* pax;
+  std::unique_ptr<TableScanner> scanner;
+  // PAX block being read and its next row
+  const char* page;
+  size_t pageRow;
+
+  void fillRows(Batch& batch);
+  void fillPages(Batch& batch);
+  void filter(Batch& batch) const;
+
+public:
+  VectorExecutor(Table& table, const SelectPlan& plan);
+  VectorExecutor(Table& table, const SelectPlan& plan, std::unique_ptr<TableScanner> scanner);
+
+  // Reads the next batch with at least one row selected, false at the end
+  bool next(Batch& batch);
+  // Adds the selected rows of a batch to the aggregates of the plan
+  void aggregate(const Batch& batch, std::vector<AggregateValue>& values) const;
+  // Writes the projected columns of every selected row, returning the count
+  size_t run(std::ostream& out);
+};
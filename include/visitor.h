@@ -3,10 +3,18 @@
 
 #include "create_stmt.h"
 #include "database_node.h"
+#include "execute_stmt.h"
+#include "insert_stmt.h"
+#include "prepare_stmt.h"
+#include "select_stmt.h"
 #include "table_node.h"
 
 struct Visitor {
   virtual void visit(const CreateStmt* node) = 0;
+  virtual void visit(const InsertStmt* node) = 0;
+  virtual void visit(const SelectStmt* node) = 0;
+  virtual void visit(const PrepareStmt* node) = 0;
+  virtual void visit(const ExecuteStmt* node) = 0;
   virtual void visit(const DatabaseNode* node) = 0;
   virtual void visit(const TableNode* node) = 0;
 };
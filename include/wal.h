@@ -0,0 +1,67 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+class BufferPool;
+
+// Byte range of a page, as offset and length
+typedef std::pair<size_t, size_t> PageRange;
+
+// Redo log for page changes. Every change is appended as a record holding the
+// new bytes of the changed ranges of one block, tagged with an increasing log
+// sequence number (LSN). Records are buffered in memory and made durable by
+// flush; callers that flush while another flush is writing wait for the next
+// round, so concurrent statements share one fdatasync (group commit). A flush
+// that fails leaves its records pending and the log as it was before it.
+//
+// A page must not reach its file before the records that changed it are
+// durable. The buffer pool checks the page LSN before every write back, and a
+// table with a mapped file flushes the log before it msyncs the mapping.
+//
+// On startup, recover replays the durable records onto the files and
+// truncates the log. Replay rewrites bytes, so it can run any number of times.
+// A checkpoint writes every dirty page back, syncs the changed files and
+// truncates the log.
+class WriteAheadLog {
+private:
+  const std::string path;
+  BufferPool* pool;
+  int fd;
+  std::mutex mutex;
+  std::condition_variable flushed;
+  std::string pending;
+  uint64_t nextLsn;
+  uint64_t durableLsn;
+  bool flushing;
+  // Set once a failed flush could not be cut off the log
+  bool failed;
+  size_t failureCount;
+  size_t logSize;
+  size_t syncCount;
+  std::set<std::string> files;
+
+  static uint64_t checksum(const char* data, size_t size);
+
+public:
+  // Attached to a pool, the log replays itself and takes part in the pool's
+  // write backs. The log file is created if it does not exist.
+  WriteAheadLog(const std::string& path, BufferPool* pool = nullptr);
+  WriteAheadLog(const WriteAheadLog& log) = delete;
+  ~WriteAheadLog();
+  static WriteAheadLog& getInstance();
+
+  bool isOpen() const;
+  uint64_t append(const std::string& file, size_t blockIndex, const char* block, const std::vector<PageRange>& ranges);
+  bool flush(uint64_t lsn);
+  bool flushAll();
+  size_t recover();
+  bool checkpoint();
+  size_t getSize();
+  size_t getSyncCount();
+};
@@ -1,6 +1,10 @@
 #include "ast_printer.h"
 #include "column_info.h"
 #include "create_stmt.h"
+#include "execute_stmt.h"
+#include "insert_stmt.h"
+#include "prepare_stmt.h"
+#include "select_stmt.h"
 #include "table_node.h"
 #include <iostream>
 #include <string>
@@ -37,6 +41,87 @@ void ASTPrinter::visit(const CreateStmt* node) {
   isRoot = prevIsRoot;
 }
 
+void ASTPrinter::visit(const InsertStmt* node) {
+  this->printLineStart();
+  std::cout << "INSERT { table: " << node->table << ", rows: " << node->rows.size() << " }" << std::endl;
+  if (node->columns.empty()) {
+    return;
+  }
+  bool prevIsRoot = isRoot;
+  isRoot = false;
+  for (size_t i = 0; i < node->columns.size(); i++) {
+    this->printLineStart(i != node->columns.size() - 1);
+    std::cout << "{ index: " << i << ", name: " << node->columns[i] << " }" << std::endl;
+  }
+  isRoot = prevIsRoot;
+}
+
+static std::string printOperator(Condition::Operator op) {
+  switch (op) {
+    case Condition::EQUAL:
+      return "=";
+    case Condition::NOT_EQUAL:
+      return "!=";
+    case Condition::LESS:
+      return "<";
+    case Condition::LESS_EQUAL:
+      return "<=";
+    case Condition::GREATER:
+      return ">";
+    case Condition::GREATER_EQUAL:
+      return ">=";
+  }
+  return "";
+}
+
+void ASTPrinter::visit(const SelectStmt* node) {
+  this->printLineStart();
+  std::cout << "SELECT { table: " << node->table << ", columns: ";
+  if (node->columns.empty() && node->aggregates.empty()) {
+    std::cout << "*";
+  }
+  for (size_t i = 0; i < node->columns.size(); i++) {
+    std::cout << (i == 0 ? "" : ", ") << node->columns[i];
+  }
+  for (size_t i = 0; i < node->aggregates.size(); i++) {
+    const Aggregate& aggregate = node->aggregates[i];
+    std::cout << (i == 0 ? "" : ", ") << (aggregate.function == Aggregate::COUNT ? "COUNT(" : "SUM(")
+              << (aggregate.column.empty() ? "*" : aggregate.column) << ")";
+  }
+  std::cout << " }" << std::endl;
+  bool prevIsRoot = isRoot;
+  isRoot = false;
+  for (size_t i = 0; i < node->conditions.size(); i++) {
+    const Condition& condition = node->conditions[i];
+    this->printLineStart(i != node->conditions.size() - 1);
+    std::cout << "WHERE { " << condition.column << " " << printOperator(condition.op) << " "
+              << (condition.isString ? "'" + condition.value + "'" : condition.value) << " }" << std::endl;
+  }
+  isRoot = prevIsRoot;
+}
+
+void ASTPrinter::visit(const PrepareStmt* node) {
+  this->printLineStart();
+  std::cout << "PREPARE { name: " << node->name << " }" << std::endl;
+  bool prevIsRoot = isRoot;
+  isRoot = false;
+  for (auto& root : node->statement->roots) {
+    root->accept(this);
+  }
+  isRoot = prevIsRoot;
+}
+
+void ASTPrinter::visit(const ExecuteStmt* node) {
+  this->printLineStart();
+  std::cout << "EXECUTE { name: " << node->name << ", values: ";
+  for (size_t i = 0; i < node->values.size(); i++) {
+    const Token& value = node->values[i];
+    const char* quote = value.type == Token::TOKEN_STRING_VALUE ? "'" : "";
+    std::cout << (i == 0 ? "" : ", ") << quote << value.value << quote;
+  }
+  std::cout << " }" << std::endl;
+}
+
 void ASTPrinter::visit(const DatabaseNode* node) {
   this->printLineStart(false);
   std::cout << "DATABASE { name: " << node->getName() << " }" << std::endl;
@@ -56,7 +141,8 @@ static std::string printColumnType(const ColumnInfo& column) {
 
 void ASTPrinter::visit(const TableNode* node) {
   this->printLineStart(false);
-  std::cout << "TABLE { name: " << node->getName() << " }" << std::endl;
+  std::cout << "TABLE { name: " << node->getName()
+            << ", layout: " << (node->layout == PAX_LAYOUT ? "PAX" : "ROW") << " }" << std::endl;
   this->skipSpace += 5;
   std::vector<std::pair<const std::string*, const ColumnInfo*>> orderedColumns;
   orderedColumns.resize(node->columns.size());
@@ -0,0 +1,334 @@
+#include "async_io.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+
+AsyncIO::AsyncIO(size_t depth) : depth(std::max(depth, (size_t)1)), inFlight(0) {}
+
+std::unique_ptr<AsyncIO> AsyncIO::create(size_t depth) {
+  std::unique_ptr<IoUringIO> ring(new IoUringIO(depth));
+  if (ring->isOpen()) {
+    return ring;
+  }
+#ifdef VERDANT_FLAG_DEBUG
+  std::cout << "[DEBUG] io_uring is not available, using " << ASYNC_IO_WORKERS << " I/O threads" << std::endl;
+#endif
+  return std::unique_ptr<AsyncIO>(new ThreadPoolIO(depth));
+}
+
+// Runs the request synchronously on the calling thread
+long AsyncIO::perform(IORequest* request) {
+  if (request->write) {
+    return request->device->write(request->offset, request->data, request->size) ? request->size : -1;
+  }
+  return request->device->read(request->offset, request->data, request->size);
+}
+
+void AsyncIO::complete(IORequest* request, long result) {
+  request->result = result;
+  request->done = true;
+}
+
+size_t AsyncIO::getDepth() const {
+  return depth;
+}
+
+size_t AsyncIO::getInFlight() const {
+  return inFlight;
+}
+
+void AsyncIO::drain() {
+  std::vector<IORequest*> completed;
+  while (inFlight > 0 && reap(completed, inFlight) > 0) {
+    completed.clear();
+  }
+}
+
+bool AsyncIO::run(std::vector<IORequest>& requests) {
+  for (auto& request : requests) {
+    request.done = false;
+  }
+  std::vector<IORequest*> completed;
+  size_t next = 0;
+  while (next < requests.size() || inFlight > 0) {
+    while (next < requests.size() && submit(&requests[next])) {
+      next++;
+    }
+    completed.clear();
+    if (!start() || reap(completed, 1) == 0) {
+      break;
+    }
+  }
+  bool result = true;
+  for (auto& request : requests) {
+    result = result && request.done && request.result == static_cast<long>(request.size);
+  }
+  return result;
+}
+
+#ifdef __NR_io_uring_setup
+
+IoUringIO::IoUringIO(size_t depth)
+    : AsyncIO(depth), ringFd(-1), submissionRing(MAP_FAILED), submissionRingSize(0),
+      completionRing(MAP_FAILED), completionRingSize(0), entries(MAP_FAILED), entriesSize(0), queued(0) {
+  struct io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  ringFd = syscall(__NR_io_uring_setup, static_cast<unsigned>(this->depth), &params);
+  if (ringFd < 0) {
+    return;
+  }
+  submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  bool singleMapping = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (singleMapping) {
+    submissionRingSize = completionRingSize = std::max(submissionRingSize, completionRingSize);
+  }
+  submissionRing = mmap(nullptr, submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ringFd, IORING_OFF_SQ_RING);
+  completionRing = singleMapping ? submissionRing
+                                 : mmap(nullptr, completionRingSize, PROT_READ | PROT_WRITE,
+                                        MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+  entriesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+  entries = mmap(nullptr, entriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+  if (submissionRing == MAP_FAILED || completionRing == MAP_FAILED || entries == MAP_FAILED) {
+    close(ringFd);
+    ringFd = -1;
+    return;
+  }
+  char* submission = static_cast<char*>(submissionRing);
+  submissionTail = reinterpret_cast<unsigned*>(submission + params.sq_off.tail);
+  submissionMask = reinterpret_cast<unsigned*>(submission + params.sq_off.ring_mask);
+  submissionArray = reinterpret_cast<unsigned*>(submission + params.sq_off.array);
+  char* completion = static_cast<char*>(completionRing);
+  completionHead = reinterpret_cast<unsigned*>(completion + params.cq_off.head);
+  completionTail = reinterpret_cast<unsigned*>(completion + params.cq_off.tail);
+  completionMask = reinterpret_cast<unsigned*>(completion + params.cq_off.ring_mask);
+  completions = completion + params.cq_off.cqes;
+}
+
+IoUringIO::~IoUringIO() {
+  if (ringFd >= 0) {
+    drain();
+  }
+  if (entries != MAP_FAILED) {
+    munmap(entries, entriesSize);
+  }
+  if (completionRing != MAP_FAILED && completionRing != submissionRing) {
+    munmap(completionRing, completionRingSize);
+  }
+  if (submissionRing != MAP_FAILED) {
+    munmap(submissionRing, submissionRingSize);
+  }
+  if (ringFd >= 0) {
+    close(ringFd);
+  }
+}
+
+bool IoUringIO::isOpen() const {
+  return ringFd >= 0;
+}
+
+// Submits the queued entries, and waits for minimum completions if non-zero
+bool IoUringIO::enter(unsigned minimum) {
+  while (true) {
+    int result = syscall(__NR_io_uring_enter, ringFd, queued, minimum, minimum > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+#ifdef VERDANT_FLAG_DEBUG
+      std::cerr << "[ERROR] io_uring_enter failed: " << std::strerror(errno) << std::endl;
+#endif
+      return false;
+    }
+    queued -= result;
+    return true;
+  }
+}
+
+const char* IoUringIO::getName() const {
+  return "io_uring";
+}
+
+bool IoUringIO::submit(IORequest* request) {
+  if (inFlight >= depth) {
+    return false;
+  }
+  inFlight++;
+  request->done = false;
+  int fd = request->device->getDescriptor();
+  if (fd < 0) {
+    complete(request, perform(request));
+    ready.push_back(request);
+    return true;
+  }
+  // Only this thread produces entries, so the tail needs no atomic read
+  unsigned tail = *submissionTail;
+  unsigned index = tail & *submissionMask;
+  struct io_uring_sqe* entry = &static_cast<struct io_uring_sqe*>(entries)[index];
+  std::memset(entry, 0, sizeof(*entry));
+  entry->opcode = request->write ? IORING_OP_WRITE : IORING_OP_READ;
+  entry->fd = fd;
+  entry->addr = reinterpret_cast<uint64_t>(request->data);
+  entry->len = request->size;
+  entry->off = request->offset;
+  entry->user_data = reinterpret_cast<uint64_t>(request);
+  submissionArray[index] = index;
+  __atomic_store_n(submissionTail, tail + 1, __ATOMIC_RELEASE);
+  queued++;
+  return true;
+}
+
+bool IoUringIO::start() {
+  return queued == 0 || enter(0);
+}
+
+size_t IoUringIO::reap(std::vector<IORequest*>& completed, size_t minimum) {
+  size_t count = ready.size();
+  completed.insert(completed.end(), ready.begin(), ready.end());
+  inFlight -= ready.size();
+  ready.clear();
+  if (queued > 0 && !enter(0)) {
+    return count;
+  }
+  while (true) {
+    unsigned head = *completionHead;
+    unsigned tail = __atomic_load_n(completionTail, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++) {
+      struct io_uring_cqe* entry = &static_cast<struct io_uring_cqe*>(completions)[head & *completionMask];
+      IORequest* request = reinterpret_cast<IORequest*>(entry->user_data);
+      long result = entry->res;
+      if (result == -EINVAL || result == -EOPNOTSUPP) {
+        // Kernels without plain read and write opcodes
+        result = perform(request);
+      } else if (result < 0) {
+        result = -1;
+      } else if (request->write && result < static_cast<long>(request->size)) {
+        // Finish a short write synchronously
+        result = request->device->write(request->offset + result, request->data + result, request->size - result)
+                     ? request->size : -1;
+      }
+      complete(request, result);
+      completed.push_back(request);
+      count++;
+      inFlight--;
+    }
+    __atomic_store_n(completionHead, head, __ATOMIC_RELEASE);
+    if (count >= minimum || inFlight == 0 || !enter(1)) {
+      return count;
+    }
+  }
+}
+
+#else
+
+IoUringIO::IoUringIO(size_t depth) : AsyncIO(depth), ringFd(-1), queued(0) {}
+
+IoUringIO::~IoUringIO() {}
+
+bool IoUringIO::isOpen() const {
+  return false;
+}
+
+bool IoUringIO::enter(unsigned minimum) {
+  return false;
+}
+
+const char* IoUringIO::getName() const {
+  return "io_uring";
+}
+
+bool IoUringIO::submit(IORequest* request) {
+  return false;
+}
+
+bool IoUringIO::start() {
+  return false;
+}
+
+size_t IoUringIO::reap(std::vector<IORequest*>& completed, size_t minimum) {
+  return 0;
+}
+
+#endif
+
+ThreadPoolIO::ThreadPoolIO(size_t depth, size_t workerCount) : AsyncIO(depth), stopping(false) {
+  for (size_t i = 0; i < std::max(workerCount, (size_t)1); i++) {
+    workers.emplace_back(&ThreadPoolIO::work, this);
+  }
+}
+
+ThreadPoolIO::~ThreadPoolIO() {
+  drain();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  queued.notify_all();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+void ThreadPoolIO::work() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    queued.wait(lock, [this]() { return stopping || !pending.empty(); });
+    if (pending.empty()) {
+      return;
+    }
+    IORequest* request = pending.front();
+    pending.pop_front();
+    lock.unlock();
+    long result = perform(request);
+    lock.lock();
+    completions.emplace_back(request, result);
+    finished.notify_one();
+  }
+}
+
+const char* ThreadPoolIO::getName() const {
+  return "threads";
+}
+
+bool ThreadPoolIO::submit(IORequest* request) {
+  if (inFlight >= depth) {
+    return false;
+  }
+  inFlight++;
+  request->done = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back(request);
+  }
+  queued.notify_one();
+  return true;
+}
+
+// Workers pick requests up as soon as they are submitted
+bool ThreadPoolIO::start() {
+  return true;
+}
+
+size_t ThreadPoolIO::reap(std::vector<IORequest*>& completed, size_t minimum) {
+  std::unique_lock<std::mutex> lock(mutex);
+  size_t target = std::min(minimum, inFlight);
+  finished.wait(lock, [this, target]() { return completions.size() >= target; });
+  size_t count = completions.size();
+  for (auto& completion : completions) {
+    complete(completion.first, completion.second);
+    completed.push_back(completion.first);
+  }
+  completions.clear();
+  inFlight -= count;
+  return count;
+}
@@ -0,0 +1,124 @@
+#include "block_device.h"
+#include "parameters.h"
+#include "util.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static bool isAligned(const void* pointer) {
+  return reinterpret_cast<uintptr_t>(pointer) % BLOCK_SIZE == 0;
+}
+
+FileBlockDevice::FileBlockDevice(const std::string& path, bool direct) : path(path), fd(-1), direct(direct) {
+  if (direct) {
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    if (fd < 0 && errno == EINVAL) {
+#ifdef VERDANT_FLAG_DEBUG
+      std::cout << "[DEBUG] O_DIRECT is not supported for " << path << ", using the page cache" << std::endl;
+#endif
+      this->direct = false;
+    }
+  }
+  if (!this->direct) {
+    fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+}
+
+FileBlockDevice::~FileBlockDevice() {
+  if (fd >= 0) {
+    close(fd);
+  }
+}
+
+bool FileBlockDevice::isOpen() const {
+  return fd >= 0;
+}
+
+bool FileBlockDevice::isDirect() const {
+  return direct;
+}
+
+size_t FileBlockDevice::getSize() {
+  struct stat sb;
+  if (fstat(fd, &sb) != 0) {
+    return 0;
+  }
+  return sb.st_size;
+}
+
+size_t FileBlockDevice::read(size_t offset, char* data, size_t size) {
+  Utility::BufferUniquePtr<char> bounce;
+  char* target = data;
+  if (direct && !isAligned(data)) {
+    bounce.reset(static_cast<char*>(std::aligned_alloc(BLOCK_SIZE, (size + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE)));
+    if (bounce == nullptr) {
+      return 0;
+    }
+    target = bounce.get();
+  }
+  size_t done = 0;
+  while (done < size) {
+    ssize_t result = pread(fd, &target[done], size - done, offset + done);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+#ifdef VERDANT_FLAG_DEBUG
+      if (result < 0) {
+        std::cerr << "[ERROR] Cannot read " << path << ": " << std::strerror(errno) << std::endl;
+      }
+#endif
+      break;
+    }
+    done += result;
+  }
+  if (target != data) {
+    std::memcpy(data, target, done);
+  }
+  return done;
+}
+
+bool FileBlockDevice::write(size_t offset, const char* data, size_t size) {
+  Utility::BufferUniquePtr<char> bounce;
+  const char* source = data;
+  if (direct && !isAligned(data)) {
+    bounce.reset(static_cast<char*>(std::aligned_alloc(BLOCK_SIZE, (size + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE)));
+    if (bounce == nullptr) {
+      return false;
+    }
+    std::memcpy(bounce.get(), data, size);
+    source = bounce.get();
+  }
+  size_t done = 0;
+  while (done < size) {
+    ssize_t result = pwrite(fd, &source[done], size - done, offset + done);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+#ifdef VERDANT_FLAG_DEBUG
+      std::cerr << "[ERROR] Cannot write " << path << ": " << std::strerror(errno) << std::endl;
+#endif
+      return false;
+    }
+    done += result;
+  }
+  return true;
+}
+
+bool FileBlockDevice::resize(size_t size) {
+  return ftruncate(fd, size) == 0;
+}
+
+bool FileBlockDevice::sync() {
+  return fdatasync(fd) == 0;
+}
+
+int FileBlockDevice::getDescriptor() const {
+  return fd;
+}
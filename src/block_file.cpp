@@ -0,0 +1,215 @@
+#include "block_file.h"
+#include "parameters.h"
+#include "status.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sys/mman.h>
+
+BlockFile::BlockFile(const std::string& path, Mode mode)
+    : path(path), device(new FileBlockDevice(path, mode == DIRECT)), blockCount(0), mode(mode),
+      mapping(nullptr), mappedBlocks(0) {
+  if (!device->isOpen()) {
+    return;
+  }
+  blockCount = device->getSize() / BLOCK_SIZE;
+  if (mode == MAPPED) {
+    openMapping();
+  }
+}
+
+BlockFile::BlockFile(const std::string& path, std::unique_ptr<BlockDevice> device)
+    : path(path), device(std::move(device)), blockCount(0), mode(BUFFERED), mapping(nullptr), mappedBlocks(0) {
+  if (this->device->isOpen()) {
+    blockCount = this->device->getSize() / BLOCK_SIZE;
+  }
+}
+
+BlockFile::~BlockFile() {
+  if (mapping != nullptr) {
+    msync(mapping, blockCount * BLOCK_SIZE, MS_SYNC);
+    munmap(mapping, MMAP_RESERVED_BLOCKS * BLOCK_SIZE);
+  }
+}
+
+// Reserves the whole address range without backing it, then maps the file
+// over the start of it
+bool BlockFile::openMapping() {
+  void* reserved = mmap(nullptr, MMAP_RESERVED_BLOCKS * BLOCK_SIZE, PROT_NONE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (reserved == MAP_FAILED) {
+    std::cerr << "[ERROR] Cannot reserve address space for " << path << std::endl;
+    return false;
+  }
+  mapping = static_cast<char*>(reserved);
+  if (!growMapping(blockCount)) {
+    munmap(mapping, MMAP_RESERVED_BLOCKS * BLOCK_SIZE);
+    mapping = nullptr;
+    return false;
+  }
+  return true;
+}
+
+// Maps at least the first blocks blocks of the file. The mapping grows in
+// steps of MMAP_GROW_BLOCKS so that appending does not remap every block;
+// the part past the end of the file is never touched.
+bool BlockFile::growMapping(size_t blocks) {
+  if (blocks <= mappedBlocks) {
+    return true;
+  }
+  size_t target = std::min((blocks + MMAP_GROW_BLOCKS - 1) / MMAP_GROW_BLOCKS * MMAP_GROW_BLOCKS,
+                           static_cast<size_t>(MMAP_RESERVED_BLOCKS));
+  if (blocks > target) {
+    std::cerr << "[ERROR] " << path << " outgrew its reserved address space" << std::endl;
+    return false;
+  }
+  void* result = mmap(mapping + mappedBlocks * BLOCK_SIZE, (target - mappedBlocks) * BLOCK_SIZE,
+                      PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, device->getDescriptor(),
+                      mappedBlocks * BLOCK_SIZE);
+  if (result == MAP_FAILED) {
+#ifdef VERDANT_FLAG_DEBUG
+    std::cerr << "[ERROR] Cannot map " << path << ": " << std::strerror(errno) << std::endl;
+#endif
+    return false;
+  }
+  mappedBlocks = target;
+  return true;
+}
+
+// Grows the file to blocks blocks and makes sure they are all mapped. The file
+// is extended before the count is, so every block below blockCount is backed.
+bool BlockFile::extendMapped(size_t blocks) {
+  if (!growMapping(blocks) || !device->resize(blocks * BLOCK_SIZE)) {
+#ifdef VERDANT_FLAG_DEBUG
+    std::cerr << "[ERROR] Cannot extend " << path << " to " << blocks << " blocks" << std::endl;
+#endif
+    return false;
+  }
+  return true;
+}
+
+bool BlockFile::isOpen() const {
+  return mode == MAPPED ? mapping != nullptr : device->isOpen();
+}
+
+bool BlockFile::isMapped() const {
+  return mode == MAPPED;
+}
+
+BlockFile::Mode BlockFile::getMode() const {
+  return mode;
+}
+
+const std::string& BlockFile::getPath() const {
+  return path;
+}
+
+BlockDevice& BlockFile::getDevice() {
+  return *device;
+}
+
+size_t BlockFile::getBlockCount() const {
+  return blockCount;
+}
+
+size_t BlockFile::allocateBlock() {
+  if (mode == MAPPED && !extendMapped(blockCount + 1)) {
+    VerdantStatus::handleError(VerdantStatus::INTERNAL_ERROR);
+  }
+  return blockCount++;
+}
+
+bool BlockFile::readBlock(size_t index, char* block) {
+  if (mode == MAPPED) {
+    char* source = getMappedBlock(index);
+    if (source == nullptr) {
+      return false;
+    }
+    std::memcpy(block, source, BLOCK_SIZE);
+    return true;
+  }
+  if (device->read(index * BLOCK_SIZE, block, BLOCK_SIZE) != BLOCK_SIZE) {
+#ifdef VERDANT_FLAG_DEBUG
+    std::cerr << "[ERROR] Cannot read block " << index << " of " << path << std::endl;
+#endif
+    return false;
+  }
+  return true;
+}
+
+// One sequential read of up to count consecutive blocks. Returns the number of
+// whole blocks read, which is less than count only at the end of the file.
+size_t BlockFile::readBlocks(size_t first, size_t count, char* blocks) {
+  if (first >= blockCount) {
+    return 0;
+  }
+  count = std::min(count, blockCount - first);
+  if (mode == MAPPED) {
+    std::memcpy(blocks, getMappedBlock(first), count * BLOCK_SIZE);
+    return count;
+  }
+  return device->read(first * BLOCK_SIZE, blocks, count * BLOCK_SIZE) / BLOCK_SIZE;
+}
+
+bool BlockFile::writeBlock(size_t index, const char* block) {
+  if (mode == MAPPED) {
+    char* destination = getMappedBlock(index);
+    if (destination == nullptr) {
+      return false;
+    }
+    std::memcpy(destination, block, BLOCK_SIZE);
+    return true;
+  }
+  if (!device->write(index * BLOCK_SIZE, block, BLOCK_SIZE)) {
+#ifdef VERDANT_FLAG_DEBUG
+    std::cerr << "[ERROR] Cannot write block " << index << " of " << path << std::endl;
+#endif
+    return false;
+  }
+  if (index >= blockCount) {
+    blockCount = index + 1;
+  }
+  return true;
+}
+
+// Address of a block inside the mapping. Asking for the block right after the
+// last one extends the file by one zeroed block.
+char* BlockFile::getMappedBlock(size_t index) {
+  if (mode != MAPPED || mapping == nullptr || index > blockCount) {
+    return nullptr;
+  }
+  if (index == blockCount) {
+    if (!extendMapped(index + 1)) {
+      return nullptr;
+    }
+    blockCount++;
+  }
+  return mapping + index * BLOCK_SIZE;
+}
+
+bool BlockFile::syncBlock(size_t index) {
+  if (mode != MAPPED) {
+    return device->sync();
+  }
+  if (index >= blockCount) {
+    return false;
+  }
+  return msync(mapping + index * BLOCK_SIZE, BLOCK_SIZE, MS_SYNC) == 0;
+}
+
+// Makes the blocks written so far visible to other readers of the file. Only
+// the mapping holds writes back from the kernel; pwrite does not.
+void BlockFile::flush() {
+  if (mapping != nullptr && blockCount > 0) {
+    msync(mapping, blockCount * BLOCK_SIZE, MS_ASYNC);
+  }
+}
+
+// Makes the blocks durable
+bool BlockFile::sync() {
+  if (mapping != nullptr && blockCount > 0 && msync(mapping, blockCount * BLOCK_SIZE, MS_SYNC) != 0) {
+    return false;
+  }
+  return device->sync();
+}
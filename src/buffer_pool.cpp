@@ -0,0 +1,278 @@
+#include "buffer_pool.h"
+#include "parameters.h"
+#include "status.h"
+#include "wal.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <unordered_set>
+
+PageGuard::PageGuard() : pool(nullptr), file(nullptr), index(0), data(nullptr), dirty(false), lsn(0) {}
+
+PageGuard::PageGuard(BufferPool* pool, BlockFile* file, size_t index, char* data)
+    : pool(pool), file(file), index(index), data(data), dirty(false), lsn(0) {}
+
+PageGuard::PageGuard(PageGuard&& guard)
+    : pool(guard.pool), file(guard.file), index(guard.index), data(guard.data), dirty(guard.dirty), lsn(guard.lsn) {
+  guard.pool = nullptr;
+  guard.data = nullptr;
+}
+
+PageGuard& PageGuard::operator=(PageGuard&& guard) {
+  if (this != &guard) {
+    release();
+    pool = guard.pool;
+    file = guard.file;
+    index = guard.index;
+    data = guard.data;
+    dirty = guard.dirty;
+    lsn = guard.lsn;
+    guard.pool = nullptr;
+    guard.data = nullptr;
+  }
+  return *this;
+}
+
+PageGuard::~PageGuard() { release(); }
+
+char* PageGuard::getData() const {
+  return data;
+}
+
+size_t PageGuard::getIndex() const {
+  return index;
+}
+
+void PageGuard::markDirty(uint64_t lsn) {
+  dirty = true;
+  this->lsn = std::max(this->lsn, lsn);
+}
+
+void PageGuard::release() {
+  if (pool != nullptr) {
+    pool->unpinPage(*file, index, dirty, lsn);
+  }
+  pool = nullptr;
+  data = nullptr;
+  dirty = false;
+  lsn = 0;
+}
+
+size_t PageIdHash::operator()(const PageId& pageId) const {
+  return std::hash<const BlockFile*>()(pageId.first) ^ (std::hash<size_t>()(pageId.second) << 1);
+}
+
+BufferPool::BufferPool(size_t frameCount) : log(nullptr), clockHand(0) {
+  assert(frameCount > 0);
+  memory.reset(static_cast<char*>(std::aligned_alloc(BLOCK_SIZE, frameCount * BLOCK_SIZE)));
+  if (memory == nullptr) {
+    std::cerr << "[ERROR] Cannot allocate " << frameCount << " buffer pool frames" << std::endl;
+    VerdantStatus::handleError(VerdantStatus::OUT_OF_MEMORY);
+  }
+  frames.resize(frameCount);
+  for (size_t i = 0; i < frameCount; i++) {
+    frames[i] = { nullptr, 0, &memory.get()[i * BLOCK_SIZE], 0, false, false, 0 };
+  }
+  pageTable.reserve(frameCount);
+}
+
+BufferPool::~BufferPool() { flushAll(); }
+
+BufferPool& BufferPool::getInstance() {
+  static BufferPool instance(BUFFER_POOL_FRAMES);
+  return instance;
+}
+
+Optional<size_t> BufferPool::findVictim() {
+  // Two sweeps: the first one may only clear reference bits
+  for (size_t step = 0; step < 2 * frames.size(); step++) {
+    size_t frameIndex = clockHand;
+    BufferFrame& frame = frames[frameIndex];
+    clockHand = (clockHand + 1) % frames.size();
+    if (frame.pinCount > 0) {
+      continue;
+    }
+    if (frame.referenced) {
+      frame.referenced = false;
+      continue;
+    }
+    return frameIndex;
+  }
+  return Optional<size_t>(VerdantStatus::OUT_OF_MEMORY);
+}
+
+bool BufferPool::writeBack(BufferFrame& frame) {
+  if (!frame.dirty) {
+    return true;
+  }
+  // Write-ahead: the records that changed the page go first
+  if (log != nullptr && frame.lsn > 0 && !log->flush(frame.lsn)) {
+    return false;
+  }
+  if (!frame.file->writeBlock(frame.index, frame.data)) {
+    return false;
+  }
+  frame.dirty = false;
+  frame.lsn = 0;
+  return true;
+}
+
+Optional<PageGuard> BufferPool::pin(BlockFile& file, size_t index, bool load) {
+  auto found = pageTable.find(std::make_pair(&file, index));
+  if (found != pageTable.end()) {
+    BufferFrame& frame = frames[found->second];
+    frame.pinCount++;
+    frame.referenced = true;
+    return PageGuard(this, &file, index, frame.data);
+  }
+
+  auto optionalVictim = findVictim();
+  if (!optionalVictim.unwrappable()) {
+    std::cerr << "[ERROR] All " << frames.size() << " buffer pool frames are pinned" << std::endl;
+    return Optional<PageGuard>(VerdantStatus::OUT_OF_MEMORY);
+  }
+  BufferFrame& frame = frames[optionalVictim.unwrap()];
+  if (frame.file != nullptr) {
+    if (!writeBack(frame)) {
+      return Optional<PageGuard>(VerdantStatus::INTERNAL_ERROR);
+    }
+    pageTable.erase(std::make_pair(frame.file, frame.index));
+  }
+
+  if (load) {
+    if (!file.readBlock(index, frame.data)) {
+      frame.file = nullptr;
+      return Optional<PageGuard>(VerdantStatus::INTERNAL_ERROR);
+    }
+    frame.dirty = false;
+  } else {
+    std::memset(frame.data, 0, BLOCK_SIZE);
+    frame.dirty = true;
+  }
+  frame.file = &file;
+  frame.index = index;
+  frame.pinCount = 1;
+  frame.referenced = true;
+  frame.lsn = 0;
+  pageTable[std::make_pair(&file, index)] = optionalVictim.unwrap();
+  return PageGuard(this, &file, index, frame.data);
+}
+
+Optional<PageGuard> BufferPool::fetchPage(BlockFile& file, size_t index) {
+  if (index >= file.getBlockCount()) {
+#ifdef VERDANT_FLAG_DEBUG
+    std::cerr << "[ERROR] Trying to fetch a block out of bound: " << index << "/" << file.getBlockCount() << std::endl;
+#endif
+    return Optional<PageGuard>(VerdantStatus::OUT_OF_BOUND);
+  }
+  return pin(file, index, true);
+}
+
+Optional<PageGuard> BufferPool::newPage(BlockFile& file) {
+  size_t index = file.allocateBlock();
+  return pin(file, index, false);
+}
+
+void BufferPool::unpinPage(BlockFile& file, size_t index, bool dirty, uint64_t lsn) {
+  auto found = pageTable.find(std::make_pair(&file, index));
+  if (found == pageTable.end()) {
+#ifdef VERDANT_FLAG_DEBUG
+    std::cerr << "[ERROR] Unpinning a page that is not resident: " << index << std::endl;
+#endif
+    VerdantStatus::handleError(VerdantStatus::INTERNAL_ERROR);
+  }
+  BufferFrame& frame = frames[found->second];
+  assert(frame.pinCount > 0);
+  frame.pinCount--;
+  frame.dirty = frame.dirty || dirty;
+  frame.lsn = std::max(frame.lsn, lsn);
+}
+
+bool BufferPool::flushPage(BlockFile& file, size_t index) {
+  auto found = pageTable.find(std::make_pair(&file, index));
+  if (found == pageTable.end()) {
+    return true;
+  }
+  return writeBack(frames[found->second]);
+}
+
+bool BufferPool::flushFile(BlockFile& file) {
+  bool result = true;
+  for (auto& frame : frames) {
+    if (frame.file == &file) {
+      result = writeBack(frame) && result;
+    }
+  }
+  file.flush();
+  return result;
+}
+
+// Writes back and drops every page of the file. Must be called before the
+// BlockFile goes away so no frame keeps a dangling file pointer.
+bool BufferPool::evictFile(BlockFile& file) {
+  bool result = flushFile(file);
+  for (auto& frame : frames) {
+    if (frame.file != &file) {
+      continue;
+    }
+#ifdef VERDANT_FLAG_DEBUG
+    assert(frame.pinCount == 0);
+#endif
+    pageTable.erase(std::make_pair(frame.file, frame.index));
+    frame.file = nullptr;
+    frame.referenced = false;
+  }
+  return result;
+}
+
+// Makes the log durable once for all pages, then writes the dirty pages with
+// up to ASYNC_IO_DEPTH writes in flight
+bool BufferPool::flushAll() {
+  uint64_t lsn = 0;
+  std::vector<IORequest> requests;
+  std::vector<BufferFrame*> written;
+  for (auto& frame : frames) {
+    if (frame.file != nullptr && frame.dirty) {
+      lsn = std::max(lsn, frame.lsn);
+      requests.push_back({&frame.file->getDevice(), true, frame.index * BLOCK_SIZE, frame.data, BLOCK_SIZE, 0, false});
+      written.push_back(&frame);
+    }
+  }
+  if (log != nullptr && lsn > 0 && !log->flush(lsn)) {
+    return false;
+  }
+  if (!requests.empty() && io == nullptr) {
+    io = AsyncIO::create();
+  }
+  bool result = requests.empty() || io->run(requests);
+  for (size_t i = 0; i < requests.size(); i++) {
+    if (requests[i].done && requests[i].result == BLOCK_SIZE) {
+      written[i]->dirty = false;
+      written[i]->lsn = 0;
+    }
+  }
+  // Each file is flushed once, however many of its pages were written
+  std::unordered_set<BlockFile*> files;
+  for (BufferFrame* frame : written) {
+    files.insert(frame->file);
+  }
+  for (BlockFile* file : files) {
+    file->flush();
+  }
+  return result;
+}
+
+void BufferPool::setLog(WriteAheadLog* log) {
+  this->log = log;
+}
+
+size_t BufferPool::getFrameCount() const {
+  return frames.size();
+}
+
+size_t BufferPool::getResidentCount() const {
+  return pageTable.size();
+}
@@ -0,0 +1,117 @@
+#include "catalog.h"
+#include "create_stmt.h"
+#include "scanner.h"
+#include "sql_parser.h"
+#include "table_node.h"
+#include "verdant_object.h"
+
+#include <iostream>
+
+Catalog::Catalog(const std::string& database)
+    : database(database), master(Table::getMasterTable(database)) {
+  load();
+}
+
+// Reads every table of the master table, skipping the entry of the master
+// table itself, whose schema is fixed
+void Catalog::load() {
+  std::string masterName = database + "_verdant_master.vtbl";
+  auto scanner = master->scan();
+  while (true) {
+    auto optionalRecord = scanner->next();
+    if (!optionalRecord.unwrappable()) {
+      break;
+    }
+    std::string name;
+    std::string type;
+    std::string createStatement;
+    for (auto& field : master->parseRecord(optionalRecord.unwrap())) {
+      if (field.name == "name") {
+        name = std::move(field.value);
+      } else if (field.name == "type") {
+        type = std::move(field.value);
+      } else if (field.name == "create_statement") {
+        createStatement = std::move(field.value);
+      }
+    }
+    if (name == masterName || type != std::to_string(VerdantObjectType::TABLE)) {
+      continue;
+    }
+    auto optionalSchema = parseSchema(name, createStatement);
+    if (!optionalSchema.unwrappable()) {
+      std::cerr << "[ERROR] Definition of table '" << name << "' in the master table is invalid" << std::endl;
+      continue;
+    }
+    schemas.emplace(std::move(name), optionalSchema.unwrap());
+  }
+#ifdef VERDANT_FLAG_DEBUG
+  std::cout << "[DEBUG] Loaded " << schemas.size() << " tables of database " << database << std::endl;
+#endif
+}
+
+Optional<TableSchema> Catalog::parseSchema(const std::string& name, const std::string& createStatement) {
+  auto optionalTokens = Scanner(createStatement).scan();
+  if (!optionalTokens.unwrappable()) {
+    return Optional<TableSchema>(VerdantStatus::INTERNAL_ERROR);
+  }
+  std::vector<Token> tokens = optionalTokens.unwrap();
+  auto optionalAst = SQLParser(tokens).parse();
+  if (!optionalAst.unwrappable()) {
+    return Optional<TableSchema>(VerdantStatus::INTERNAL_ERROR);
+  }
+  AST ast = optionalAst.unwrap();
+  for (auto& root : ast.roots) {
+    auto createStmt = dynamic_cast<CreateStmt*>(root.get());
+    if (createStmt == nullptr || createStmt->creation->getType() != VerdantObjectType::TABLE ||
+        createStmt->creation->getName() != name) {
+      continue;
+    }
+    auto tableNode = static_cast<TableNode*>(createStmt->creation.get());
+    TableSchema schema;
+    schema.columns = tableNode->columns;
+    schema.layout = tableNode->layout;
+    return schema;
+  }
+  return Optional<TableSchema>(VerdantStatus::INTERNAL_ERROR);
+}
+
+const std::string& Catalog::getDatabase() const {
+  return database;
+}
+
+size_t Catalog::getTableCount() const {
+  return schemas.size();
+}
+
+size_t Catalog::getFileCount() const {
+  return master->getFileCount();
+}
+
+bool Catalog::hasTable(const std::string& name) const {
+  return schemas.find(name) != schemas.end();
+}
+
+Optional<const TableSchema*> Catalog::getSchema(const std::string& name) const {
+  auto it = schemas.find(name);
+  if (it == schemas.end()) {
+    return Optional<const TableSchema*>(VerdantStatus::INVALID_SYNTAX);
+  }
+  return &it->second;
+}
+
+// Writes through: the record is added and flushed before the cache changes
+bool Catalog::addTable(const std::string& name, const TableSchema& schema, const std::string& createStatement) {
+  if (hasTable(name)) {
+    return false;
+  }
+  std::vector<Field> record;
+  record.push_back({"name", name});
+  record.push_back({"type", std::to_string(VerdantObjectType::TABLE)});
+  record.push_back({"create_statement", createStatement});
+  if (!master->addRecord(record)) {
+    return false;
+  }
+  master->save();
+  schemas.emplace(name, schema);
+  return true;
+}
@@ -1,4 +1,6 @@
 #include "cmd_interpreter.h"
+#include "catalog.h"
+#include "table_cache.h"
 #include "status.h"
 #include "util.h"
 
@@ -39,7 +41,7 @@ VerdantStatus::StatusEnum CommandInterpreter::interpret() {
     return VerdantStatus::INVALID_SYNTAX;
   }
 
-  auto optionalCmd = consume(Token::TOKEN_IDENTIFIER, "Invalid token '" + current()->value + "'");
+  auto optionalCmd = consume(Token::TOKEN_IDENTIFIER, "Invalid token '" + std::string(current()->value) + "'");
   if (!optionalCmd.unwrappable()) {
     return VerdantStatus::INVALID_SYNTAX;
   }
@@ -54,15 +56,19 @@ VerdantStatus::StatusEnum CommandInterpreter::interpret() {
       return VerdantStatus::INVALID_SYNTAX;
     }
     if (!this->isAtEnd()) {
-      error("Unexpected token '" + current()->value + "'");
+      error("Unexpected token '" + std::string(current()->value) + "'");
       return VerdantStatus::INVALID_SYNTAX;
     }
-    std::string databaseIdentifier = optionalDatabaseIdentifier.unwrap()->value;
+    std::string databaseIdentifier(optionalDatabaseIdentifier.unwrap()->value);
     if (!Utility::isDirectoryExist(Utility::getDatabasePath(databaseIdentifier))) {
       std::cerr << "[ERROR] Database not exist, or Verdant does not have permission to access the database" << std::endl;
       return VerdantStatus::INVALID_PERMISSION;
     }
 
+    // The previous catalog closes its master table before the new one opens
+    context.catalog = nullptr;
+    context.catalog = std::make_shared<Catalog>(databaseIdentifier);
+    context.tables->reserve(context.catalog->getFileCount());
     context.database.setValue(std::move(databaseIdentifier));
     std::cout << "Connected to database " << context.database.peek() << std::endl;
 
@@ -1,4 +1,5 @@
 #include "column_info.h"
+#include "record_layout.h"
 #include "status.h"
 
 #include <iostream>
@@ -13,11 +14,11 @@ bool ColumnInfo::operator==(const ColumnInfo& rhs) const {
 size_t ColumnInfo::getSize() const {
   switch (type) {
     case ColumnInfo::INT:
-      return sizeof(ColumnInfo::ColumnType) + sizeof(int);
+      return sizeof(int);
     case ColumnInfo::FLOAT:
-      return sizeof(ColumnInfo::ColumnType) + sizeof(float);
+      return sizeof(float);
     case ColumnInfo::VARCHAR:
-      return sizeof(ColumnInfo::ColumnType) + sizeof(size_t) + varcharSize;
+      return RecordLayout::getVarintSize(varcharSize) + varcharSize;
   }
 #ifdef VERDANT_FLAG_DEBUG
   std::cerr << "[ERROR] Unreachable" << std::endl;
@@ -0,0 +1,9 @@
+#include "execute_stmt.h"
+
+#include "visitor.h"
+
+ExecuteStmt::ExecuteStmt(const std::string& name) : name(name) {}
+
+void ExecuteStmt::accept(Visitor* visitor) {
+  visitor->visit(this);
+}
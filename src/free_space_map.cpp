@@ -0,0 +1,104 @@
+#include "free_space_map.h"
+#include "parameters.h"
+#include "status.h"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+
+static const size_t CATEGORY_SIZE = BLOCK_SIZE / FREE_SPACE_CATEGORIES;
+
+FreeSpaceMap::FreeSpaceMap(const std::string& path)
+    : path(path), buckets(FREE_SPACE_CATEGORIES), dirty(false) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    return;
+  }
+  size_t size = file.tellg();
+  std::vector<uint8_t> loaded(size);
+  file.seekg(0);
+  if (!file.read(reinterpret_cast<char*>(loaded.data()), size)) {
+    return;
+  }
+  for (size_t block = 0; block < loaded.size(); block++) {
+    update(block, loaded[block] * CATEGORY_SIZE);
+  }
+  dirty = false;
+}
+
+uint8_t FreeSpaceMap::toCategory(size_t freeBytes) {
+  return std::min(freeBytes / CATEGORY_SIZE, (size_t)FREE_SPACE_CATEGORIES - 1);
+}
+
+size_t FreeSpaceMap::getBlockCount() const {
+  return categories.size();
+}
+
+size_t FreeSpaceMap::getFreeSpace(size_t block) const {
+  return block < categories.size() ? categories[block] * CATEGORY_SIZE : 0;
+}
+
+// Swaps the last block of the bucket into the place of block
+void FreeSpaceMap::unlink(size_t block) {
+  std::vector<size_t>& bucket = buckets[categories[block]];
+  size_t position = positions[block];
+  bucket[position] = bucket.back();
+  positions[bucket[position]] = position;
+  bucket.pop_back();
+}
+
+void FreeSpaceMap::link(size_t block, uint8_t category) {
+  categories[block] = category;
+  positions[block] = buckets[category].size();
+  buckets[category].push_back(block);
+}
+
+void FreeSpaceMap::update(size_t block, size_t freeBytes) {
+  assert(block <= categories.size());
+  uint8_t category = toCategory(freeBytes);
+  if (block == categories.size()) {
+    categories.push_back(category);
+    positions.push_back(0);
+  } else if (categories[block] == category) {
+    return;
+  } else {
+    unlink(block);
+  }
+  link(block, category);
+  dirty = true;
+}
+
+// Every block in a category at or above the rounded up request has room for
+// it, so the first non-empty bucket answers. Smaller categories are tried
+// first, which keeps the blocks with the most room for larger records.
+Optional<size_t> FreeSpaceMap::find(size_t bytes) const {
+  for (size_t category = (bytes + CATEGORY_SIZE - 1) / CATEGORY_SIZE; category < FREE_SPACE_CATEGORIES; category++) {
+    if (!buckets[category].empty()) {
+      return buckets[category].back();
+    }
+  }
+  return Optional<size_t>(VerdantStatus::OUT_OF_BOUND);
+}
+
+void FreeSpaceMap::clear() {
+  categories.clear();
+  positions.clear();
+  for (auto& bucket : buckets) {
+    bucket.clear();
+  }
+  dirty = true;
+}
+
+void FreeSpaceMap::save() {
+  if (!dirty) {
+    return;
+  }
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(categories.data()), categories.size());
+  if (!file) {
+    std::cerr << "[ERROR] Cannot write the free space map " << path << std::endl;
+    return;
+  }
+  dirty = false;
+}
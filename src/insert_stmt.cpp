@@ -0,0 +1,27 @@
+#include "insert_stmt.h"
+
+#include "visitor.h"
+
+InsertStmt::InsertStmt(const std::string& table) : table(table) {}
+
+void InsertStmt::accept(Visitor* visitor) {
+  visitor->visit(this);
+}
+
+void InsertStmt::bind(const std::vector<const Token*>& values, size_t first) {
+  size_t position = 0;
+  size_t parameter = 0;
+  for (auto& row : rows) {
+    for (auto& value : row) {
+      if (parameter < parameters.size() && parameters[parameter] == position) {
+        value = values[first + parameter]->value;
+        parameter++;
+      }
+      position++;
+    }
+  }
+}
+
+std::unique_ptr<Stmt> InsertStmt::clone() const {
+  return std::unique_ptr<Stmt>(new InsertStmt(*this));
+}
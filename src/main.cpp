@@ -1,22 +1,28 @@
-#include "ast_printer.h"
 #include "cmd_interpreter.h"
 #include "sql_interpreter.h"
 #include "optional.h"
 #include "util.h"
 #include "version.h"
 #include "scanner.h"
+#include "script_reader.h"
 #include "status.h"
-#include "sql_parser.h"
+#include "table_cache.h"
 #include "parameters.h"
+#include "plan_cache.h"
 #include "context.h"
+#include "wal.h"
 
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <string>
 
-bool execute(Context& context, std::vector<std::string>& statements, std::string& statement) {
+// tokens is a buffer kept across statements
+bool execute(Context& context, std::string& statement, std::vector<Token>& tokens) {
   context.statement.setValue(&statement);
-  std::vector<Token> tokens = Scanner(statement).scan().unwrap();
+  if (!Scanner(statement).scan(tokens)) {
+    return true;
+  }
 #ifdef VERDANT_FLAG_DEBUG
 //for (auto &token: tokens) {
 //  std::cout << token.toString() << std::endl;
@@ -35,23 +41,18 @@ bool execute(Context& context, std::vector<std::string>& statements, std::string
     return true;
   }
 
-  Optional<AST> optionalAst = SQLParser(tokens).parse();
+  auto optionalAst = context.plans->parse(tokens);
   if (!optionalAst.unwrappable()) {
     return true;
   }
-  AST ast = optionalAst.unwrap();
-  
-#ifdef VERDANT_FLAG_DEBUG
-  ASTPrinter printer("[DEBUG] ");
-  printer.print(ast);
-#endif
-  SQLInterpreter(ast, context).interpret();
+  std::shared_ptr<AST> ast = optionalAst.unwrap();
+  SQLInterpreter(*ast, context).interpret();
 
   return true;
 }
 
 
-bool loop(Context& context, std::vector<std::string>& statements) {
+bool loop(Context& context, std::vector<std::string>& statements, std::vector<Token>& tokens) {
   std::string statement;
   std::cout << (context.database.unwrappable() ? context.database.peek() + " " : "") << ">> ";
   if (!std::getline(std::cin, statement)) {
@@ -62,15 +63,47 @@ bool loop(Context& context, std::vector<std::string>& statements) {
     return false;
   }
 
-  bool result = execute(context, statements, statement);
+  bool result = execute(context, statement, tokens);
   statements.push_back(std::move(statement));
   return result;
 }
 
-int main() {
-  std::cout << "Verdant" << " Version " << VERDANT_VERSION_MAJOR << "."
-            << VERDANT_VERSION_MINOR << std::endl;
+// Runs the statements of a script with no prompts, holding one statement
+// at a time
+bool runScript(Context& context, const std::string& path) {
+  std::ifstream script(path, std::ios::binary);
+  if (!script.is_open()) {
+    std::cerr << "[ERROR] Cannot open script " << path << std::endl;
+    return false;
+  }
+  ScriptReader reader(script);
+  std::string statement;
+  std::vector<Token> tokens;
+  while (reader.next(statement)) {
+    if (!execute(context, statement, tokens)) {
+      break;
+    }
+  }
+  if (script.bad()) {
+    std::cerr << "[ERROR] Cannot read script " << path << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char* argv[]) {
+  Optional<std::string> scriptPath;
+  if (argc == 3 && std::string(argv[1]) == "-f") {
+    scriptPath.setValue(std::string(argv[2]));
+  } else if (argc != 1) {
+    std::cerr << "Usage: " << argv[0] << " [-f file.sql]" << std::endl;
+    exit(1);
+  }
 
+  if (!scriptPath.unwrappable()) {
+    std::cout << "Verdant" << " Version " << VERDANT_VERSION_MAJOR << "."
+              << VERDANT_VERSION_MINOR << std::endl;
+  }
 #ifdef VERDANT_FLAG_DEBUG
   std::cout << "[WARNING] Debug mode enabled." << std::endl;
 #endif 
@@ -78,10 +111,20 @@ int main() {
     std::cout << "[ERROR] Cannot create/access data directory at " << DATA_PATH << std::endl;
     exit(1);
   }
+  // Replays the log before any table is opened
+  if (!WriteAheadLog::getInstance().isOpen()) {
+    exit(1);
+  }
 
-  std::vector<std::string> statements;
-  Context context = { Optional<std::string>(), Optional<std::string*>() };
+  Context context = { Optional<std::string>(), Optional<std::string*>(), nullptr,
+                      std::make_shared<TableCache>(), std::make_shared<PlanCache>() };
 
-  while (loop(context, statements)) {}
+  if (scriptPath.unwrappable()) {
+    return runScript(context, scriptPath.peek()) ? VerdantStatus::SUCCESS : 1;
+  }
+
+  std::vector<std::string> statements;
+  std::vector<Token> tokens;
+  while (loop(context, statements, tokens)) {}
   return VerdantStatus::SUCCESS;
 }
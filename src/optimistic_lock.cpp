@@ -0,0 +1,53 @@
+#include "optimistic_lock.h"
+
+OptimisticLock::OptimisticLock() : version(0b100) {}
+
+bool OptimisticLock::isLocked(uint64_t version) {
+  return (version & 0b10) == 0b10;
+}
+
+bool OptimisticLock::isObsolete(uint64_t version) {
+  return (version & 0b1) == 0b1;
+}
+
+uint64_t OptimisticLock::readLockOrRestart(bool& needRestart) const {
+  uint64_t currentVersion = this->version.load();
+  if (isLocked(currentVersion) || isObsolete(currentVersion)) {
+    needRestart = true;
+  }
+  return currentVersion;
+}
+
+void OptimisticLock::checkOrRestart(uint64_t startVersion, bool& needRestart) const {
+  this->readUnlockOrRestart(startVersion, needRestart);
+}
+
+void OptimisticLock::readUnlockOrRestart(uint64_t startVersion, bool& needRestart) const {
+  if (startVersion != this->version.load()) {
+    needRestart = true;
+  }
+}
+
+void OptimisticLock::upgradeToWriteLockOrRestart(uint64_t& startVersion, bool& needRestart) {
+  if (this->version.compare_exchange_strong(startVersion, startVersion + 0b10)) {
+    startVersion = startVersion + 0b10;
+  } else {
+    needRestart = true;
+  }
+}
+
+void OptimisticLock::writeLockOrRestart(bool& needRestart) {
+  uint64_t currentVersion = this->readLockOrRestart(needRestart);
+  if (needRestart) {
+    return;
+  }
+  this->upgradeToWriteLockOrRestart(currentVersion, needRestart);
+}
+
+void OptimisticLock::writeUnlock() {
+  this->version.fetch_add(0b10);
+}
+
+void OptimisticLock::writeUnlockObsolete() {
+  this->version.fetch_add(0b11);
+}
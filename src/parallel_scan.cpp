@@ -0,0 +1,67 @@
+#include "parallel_scan.h"
+#include "parameters.h"
+
+#include <algorithm>
+#include <thread>
+
+ParallelScan::ParallelScan(Table& table, const SelectPlan& plan, size_t workerCount)
+    : table(table), plan(plan),
+      workerCount(workerCount > 0 ? workerCount : std::max(std::thread::hardware_concurrency(), 1u)),
+      blockCount(0), nextMorsel(0) {}
+
+void ParallelScan::work(std::vector<AggregateValue>& values) {
+  values.resize(plan.aggregates.size());
+  Batch batch;
+  while (true) {
+    size_t firstBlock = nextMorsel.fetch_add(1) * PARALLEL_SCAN_MORSEL_BLOCKS;
+    if (firstBlock >= blockCount) {
+      return;
+    }
+    size_t endBlock = std::min(firstBlock + PARALLEL_SCAN_MORSEL_BLOCKS, blockCount);
+    VectorExecutor executor(table, plan, table.scanBlocks(firstBlock, endBlock));
+    while (executor.next(batch)) {
+      executor.aggregate(batch, values);
+    }
+  }
+}
+
+// The table is flushed once up front; from then on the workers only read the
+// file. Tables of a single morsel are aggregated on the calling thread.
+std::vector<AggregateValue> ParallelScan::aggregate() {
+  table.flushBlocks();
+  blockCount = table.getBlockCount();
+  nextMorsel = 0;
+  size_t morselCount = (blockCount + PARALLEL_SCAN_MORSEL_BLOCKS - 1) / PARALLEL_SCAN_MORSEL_BLOCKS;
+  size_t threadCount = std::min(workerCount, morselCount);
+
+  std::vector<std::vector<AggregateValue>> results(std::max(threadCount, (size_t)1));
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < threadCount; i++) {
+    workers.emplace_back(&ParallelScan::work, this, std::ref(results[i]));
+  }
+  work(results[0]);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  std::vector<AggregateValue> values(plan.aggregates.size());
+  for (auto& result : results) {
+    for (size_t i = 0; i < result.size(); i++) {
+      values[i].merge(result[i]);
+    }
+  }
+  return values;
+}
+
+void ParallelScan::run(std::ostream& out) {
+  std::vector<AggregateValue> values = aggregate();
+  const RecordLayout& layout = table.getLayout();
+  for (size_t i = 0; i < plan.aggregates.size(); i++) {
+    out << (i == 0 ? "" : " | ") << plan.getAggregateName(layout, i);
+  }
+  out << std::endl;
+  for (size_t i = 0; i < plan.aggregates.size(); i++) {
+    out << (i == 0 ? "" : " | ") << plan.formatAggregate(layout, i, values[i]);
+  }
+  out << std::endl;
+}
@@ -0,0 +1,175 @@
+#include "pax_layout.h"
+#include "parameters.h"
+
+#include <algorithm>
+#include <cstring>
+
+static size_t alignUp(size_t offset) {
+  return (offset + 7) & ~(size_t)7;
+}
+
+PaxLayout::PaxLayout(const RecordLayout& layout)
+    : layout(layout), rowSize(0), hasVariable(false) {
+  size_t columnCount = layout.getColumnCount();
+  bitmapOffsets.resize(columnCount);
+  valueOffsets.resize(columnCount);
+  size_t estimate = 0;
+  for (size_t i = 0; i < columnCount; i++) {
+    const ColumnInfo& info = layout.getInfo(i);
+    if (info.type == ColumnInfo::VARCHAR) {
+      rowSize += SLOT_SIZE;
+      estimate += info.varcharSize / 2;
+      hasVariable = true;
+    } else {
+      rowSize += info.getSize();
+    }
+  }
+  usable = place(1) + estimate <= BLOCK_SIZE;
+  // Largest capacity whose minipages leave the heap its estimated share
+  capacity = (BLOCK_SIZE - HEADER_SIZE) / (rowSize + estimate + (columnCount + 7) / 8);
+  capacity = std::max(capacity, (size_t)1);
+  while (capacity > 1 && place(capacity) + capacity * estimate > BLOCK_SIZE) {
+    capacity--;
+  }
+  minipagesEnd = place(capacity);
+}
+
+// Lays the minipages out for a capacity, returning where they end
+size_t PaxLayout::place(size_t capacity) {
+  size_t offset = HEADER_SIZE;
+  for (size_t i = 0; i < layout.getColumnCount(); i++) {
+    bitmapOffsets[i] = offset;
+    offset = alignUp(offset + (capacity + 7) / 8);
+    valueOffsets[i] = offset;
+    size_t width = layout.getInfo(i).type == ColumnInfo::VARCHAR ? SLOT_SIZE : layout.getInfo(i).getSize();
+    offset = alignUp(offset + capacity * width);
+  }
+  return offset;
+}
+
+size_t PaxLayout::getCapacity() const {
+  return capacity;
+}
+
+bool PaxLayout::isUsable() const {
+  return usable;
+}
+
+const RecordLayout& PaxLayout::getRecordLayout() const {
+  return layout;
+}
+
+size_t PaxLayout::readRowCount(const char* block) {
+  size_t rowCount;
+  std::memcpy(&rowCount, block, sizeof(size_t));
+  return rowCount;
+}
+
+// A new page is all zeros, which stands for an empty heap
+size_t PaxLayout::readHeapStart(const char* block) {
+  size_t heapStart;
+  std::memcpy(&heapStart, &block[sizeof(size_t)], sizeof(size_t));
+  return heapStart == 0 ? BLOCK_SIZE : heapStart;
+}
+
+// A row takes rowSize bytes of minipages and its VARCHAR bytes of heap, so a
+// page with a row left has the heap plus one row of space. Without VARCHAR
+// columns the rows left are the whole story. Minipages larger than the page
+// leave no space at all.
+size_t PaxLayout::getFreeSpace(const char* block) const {
+  size_t rowsLeft = capacity - readRowCount(block);
+  if (rowsLeft == 0 || minipagesEnd > BLOCK_SIZE) {
+    return 0;
+  }
+  if (!hasVariable) {
+    return rowsLeft * rowSize;
+  }
+  return readHeapStart(block) - minipagesEnd + rowSize;
+}
+
+size_t PaxLayout::getRequiredSpace(const char* record) const {
+  size_t required = rowSize;
+  for (size_t i = 0; i < layout.getColumnCount(); i++) {
+    if (layout.getInfo(i).type == ColumnInfo::VARCHAR && !layout.isNull(record, i)) {
+      required += layout.getValue(record, i).second;
+    }
+  }
+  return required;
+}
+
+bool PaxLayout::isEnoughSpace(const char* block, const char* record) const {
+  return getFreeSpace(block) >= getRequiredSpace(record);
+}
+
+bool PaxLayout::isFitting(const char* record) const {
+  return minipagesEnd <= BLOCK_SIZE && getRequiredSpace(record) <= BLOCK_SIZE - minipagesEnd + rowSize;
+}
+
+std::vector<PageRange> PaxLayout::addRow(char* block, const char* record) const {
+  size_t row = readRowCount(block);
+  size_t heapStart = readHeapStart(block);
+  size_t heapEnd = heapStart;
+  std::vector<PageRange> ranges;
+  for (size_t i = 0; i < layout.getColumnCount(); i++) {
+    if (layout.isNull(record, i)) {
+      block[bitmapOffsets[i] + row / 8] |= static_cast<char>(1 << (row % 8));
+      ranges.push_back({bitmapOffsets[i] + row / 8, 1});
+      continue;
+    }
+    auto value = layout.getValue(record, i);
+    if (layout.getInfo(i).type != ColumnInfo::VARCHAR) {
+      std::memcpy(&block[valueOffsets[i] + row * value.second], value.first, value.second);
+      ranges.push_back({valueOffsets[i] + row * value.second, value.second});
+      continue;
+    }
+    heapStart -= value.second;
+    std::memcpy(&block[heapStart], value.first, value.second);
+    uint16_t slot[2] = {static_cast<uint16_t>(heapStart), static_cast<uint16_t>(value.second)};
+    std::memcpy(&block[valueOffsets[i] + row * SLOT_SIZE], slot, SLOT_SIZE);
+    ranges.push_back({valueOffsets[i] + row * SLOT_SIZE, SLOT_SIZE});
+  }
+  if (heapStart < heapEnd) {
+    ranges.push_back({heapStart, heapEnd - heapStart});
+  }
+  row++;
+  std::memcpy(block, &row, sizeof(size_t));
+  std::memcpy(&block[sizeof(size_t)], &heapStart, sizeof(size_t));
+  ranges.push_back({0, HEADER_SIZE});
+  return ranges;
+}
+
+bool PaxLayout::isNull(const char* block, size_t row, size_t column) const {
+  return (block[bitmapOffsets[column] + row / 8] >> (row % 8)) & 1;
+}
+
+const char* PaxLayout::getColumn(const char* block, size_t column) const {
+  return &block[valueOffsets[column]];
+}
+
+std::pair<const char*, size_t> PaxLayout::getValue(const char* block, size_t row, size_t column) const {
+  const ColumnInfo& info = layout.getInfo(column);
+  if (info.type != ColumnInfo::VARCHAR) {
+    return std::make_pair(&block[valueOffsets[column] + row * info.getSize()], info.getSize());
+  }
+  uint16_t slot[2];
+  std::memcpy(slot, &block[valueOffsets[column] + row * SLOT_SIZE], SLOT_SIZE);
+  return std::make_pair(&block[slot[0]], static_cast<size_t>(slot[1]));
+}
+
+void PaxLayout::readRow(const char* block, size_t row, std::vector<char>& record) const {
+  std::vector<std::pair<const char*, size_t>> values;
+  std::vector<size_t> variableLengths;
+  values.reserve(layout.getColumnCount());
+  for (size_t i = 0; i < layout.getColumnCount(); i++) {
+    if (isNull(block, row, i)) {
+      values.push_back(std::make_pair(nullptr, 0));
+    } else {
+      values.push_back(getValue(block, row, i));
+    }
+    if (layout.getInfo(i).type == ColumnInfo::VARCHAR) {
+      variableLengths.push_back(values.back().second);
+    }
+  }
+  record.resize(layout.getSize(variableLengths));
+  layout.encode(values, record.data());
+}
@@ -0,0 +1,184 @@
+#include "plan_cache.h"
+#include "ast_printer.h"
+#include "select_stmt.h"
+#include "sql_parser.h"
+#include "stmt.h"
+#include "util.h"
+
+#include <iostream>
+
+PlanCache::PlanCache(size_t capacity) : capacity(capacity) {}
+
+static bool isLiteral(const Token& token) {
+  return token.type == Token::TOKEN_INT_VALUE || token.type == Token::TOKEN_FLOAT_VALUE ||
+         token.type == Token::TOKEN_STRING_VALUE;
+}
+
+// Only INSERT and SELECT have all their literals in value positions; the
+// literals of CREATE are part of its shape
+bool PlanCache::isCacheable(const std::vector<Token>& tokens) {
+  bool isStart = true;
+  for (auto& token : tokens) {
+    if (isStart && token.type != Token::TOKEN_INSERT && token.type != Token::TOKEN_SELECT &&
+        token.type != Token::TOKEN_SEMICOLON) {
+      return false;
+    }
+    if (token.type == Token::TOKEN_PARAMETER) {
+      return false;
+    }
+    isStart = token.type == Token::TOKEN_SEMICOLON;
+  }
+  return true;
+}
+
+// Literals of any type come down to '?' and keywords and operators to their
+// type, so only identifiers keep their text
+std::string PlanCache::normalize(const std::vector<Token>& tokens) {
+  std::string key;
+  for (auto& token : tokens) {
+    if (isLiteral(token)) {
+      key += '?';
+    } else {
+      key += std::to_string(token.type);
+    }
+    if (token.type == Token::TOKEN_IDENTIFIER) {
+      key += ':';
+      key += token.value;
+    }
+    key += '\x1f';
+  }
+  return key;
+}
+
+Optional<std::shared_ptr<AST>> PlanCache::parse(const std::vector<Token>& tokens) {
+  bool cacheable = isCacheable(tokens);
+  std::string key;
+  if (cacheable) {
+    key = normalize(tokens);
+    auto found = index.find(key);
+    if (found != index.end()) {
+      std::vector<const Token*> values;
+      for (auto& token : tokens) {
+        if (isLiteral(token)) {
+          values.push_back(&token);
+        }
+      }
+      auto bound = bind(*found->second->ast, values);
+      if (bound.unwrappable()) {
+        entries.splice(entries.begin(), entries, found->second);
+#ifdef VERDANT_FLAG_DEBUG
+        std::cout << "[DEBUG] Plan cache hit, " << values.size() << " parameters bound" << std::endl;
+#endif
+        return bound;
+      }
+    }
+  }
+
+  Optional<AST> optionalAst = SQLParser(tokens, cacheable).parse();
+  if (!optionalAst.unwrappable()) {
+    return Optional<std::shared_ptr<AST>>(optionalAst.status);
+  }
+  std::shared_ptr<AST> ast(new AST(optionalAst.unwrap()));
+#ifdef VERDANT_FLAG_DEBUG
+  ASTPrinter printer("[DEBUG] ");
+  printer.print(*ast);
+#endif
+  // The first run uses the cached AST itself, with its own literals
+  if (cacheable) {
+    sharePlans(*ast);
+    add(key, ast);
+  }
+  return ast;
+}
+
+void PlanCache::sharePlans(AST& ast) {
+  for (auto& root : ast.roots) {
+    auto select = dynamic_cast<SelectStmt*>(root.get());
+    if (select != nullptr) {
+      select->sharedPlan = std::make_shared<SharedPlan>();
+    }
+  }
+}
+
+void PlanCache::add(const std::string& key, std::shared_ptr<AST> ast) {
+  auto found = index.find(key);
+  if (found != index.end()) {
+    entries.erase(found->second);
+  }
+  entries.push_front({key, std::move(ast)});
+  index[key] = entries.begin();
+  while (entries.size() > capacity) {
+    index.erase(entries.back().key);
+    entries.pop_back();
+  }
+}
+
+size_t PlanCache::getParameterCount(const AST& ast) {
+  size_t count = 0;
+  for (auto& root : ast.roots) {
+    auto stmt = dynamic_cast<const Stmt*>(root.get());
+    if (stmt != nullptr) {
+      count += stmt->parameters.size();
+    }
+  }
+  return count;
+}
+
+// Only INSERT and SELECT are cached or prepared, and both can be copied
+// A number has to fit the type it was scanned as, the widest a column of
+// that type holds
+static bool isValidValue(const Token& token) {
+  int intValue;
+  float floatValue;
+  switch (token.type) {
+  case Token::TOKEN_INT_VALUE:
+    return Utility::parseInt(token.value, intValue);
+  case Token::TOKEN_FLOAT_VALUE:
+    return Utility::parseFloat(token.value, floatValue);
+  case Token::TOKEN_STRING_VALUE:
+    return true;
+  default:
+    return false;
+  }
+}
+
+Optional<std::shared_ptr<AST>> PlanCache::bind(const AST& ast, const std::vector<const Token*>& values) {
+  if (values.size() != getParameterCount(ast)) {
+    return Optional<std::shared_ptr<AST>>(VerdantStatus::INVALID_SYNTAX);
+  }
+  for (auto value : values) {
+    if (!isValidValue(*value)) {
+      return Optional<std::shared_ptr<AST>>(VerdantStatus::INVALID_TYPE);
+    }
+  }
+  std::shared_ptr<AST> bound(new AST());
+  size_t first = 0;
+  for (auto& root : ast.roots) {
+    auto stmt = dynamic_cast<const Stmt*>(root.get());
+    std::unique_ptr<Stmt> copy = stmt != nullptr ? stmt->clone() : nullptr;
+    if (copy == nullptr) {
+      return Optional<std::shared_ptr<AST>>(VerdantStatus::INTERNAL_ERROR);
+    }
+    copy->bind(values, first);
+    first += copy->parameters.size();
+    bound->addRoot(std::move(copy));
+  }
+  return bound;
+}
+
+size_t PlanCache::getSize() const {
+  return entries.size();
+}
+
+void PlanCache::prepare(const std::string& name, std::shared_ptr<AST> ast) {
+  sharePlans(*ast);
+  prepared[name] = std::move(ast);
+}
+
+Optional<std::shared_ptr<AST>> PlanCache::getPrepared(const std::string& name) {
+  auto found = prepared.find(name);
+  if (found == prepared.end()) {
+    return Optional<std::shared_ptr<AST>>(VerdantStatus::INVALID_SYNTAX);
+  }
+  return found->second;
+}
@@ -0,0 +1,11 @@
+#include "prepare_stmt.h"
+
+#include "visitor.h"
+#include <utility>
+
+PrepareStmt::PrepareStmt(const std::string& name, std::shared_ptr<AST> statement)
+    : name(name), statement(std::move(statement)) {}
+
+void PrepareStmt::accept(Visitor* visitor) {
+  visitor->visit(this);
+}
@@ -0,0 +1,85 @@
+#include "primary_index.h"
+#include "status.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+bool VarcharKey::operator<(const VarcharKey& rhs) const {
+  return std::memcmp(value, rhs.value, MAX_INDEX_KEY_SIZE) < 0;
+}
+
+bool VarcharKey::operator==(const VarcharKey& rhs) const {
+  return std::memcmp(value, rhs.value, MAX_INDEX_KEY_SIZE) == 0;
+}
+
+bool VarcharKey::operator!=(const VarcharKey& rhs) const {
+  return !(*this == rhs);
+}
+
+std::unique_ptr<PrimaryIndex> PrimaryIndex::create(const std::string& path, const ColumnInfo& column) {
+  switch (column.type) {
+  case ColumnInfo::INT:
+    return std::unique_ptr<PrimaryIndex>(new TypedPrimaryIndex<int>(path, column));
+  case ColumnInfo::FLOAT:
+    return std::unique_ptr<PrimaryIndex>(new TypedPrimaryIndex<float>(path, column));
+  case ColumnInfo::VARCHAR:
+    if (column.varcharSize > MAX_INDEX_KEY_SIZE) {
+      std::cerr << "[ERROR] Primary key is longer than " << MAX_INDEX_KEY_SIZE << " characters" << std::endl;
+      return nullptr;
+    }
+    return std::unique_ptr<PrimaryIndex>(new TypedPrimaryIndex<VarcharKey>(path, column));
+  }
+#ifdef VERDANT_FLAG_DEBUG
+  std::cerr << "[ERROR] Unreachable" << std::endl;
+#endif
+  VerdantStatus::handleError(VerdantStatus::INTERNAL_ERROR);
+  exit(VerdantStatus::INTERNAL_ERROR);
+}
+
+template <typename K>
+TypedPrimaryIndex<K>::TypedPrimaryIndex(const std::string& path, const ColumnInfo& column)
+    : tree(path), column(column) {}
+
+template <typename K> Optional<K> TypedPrimaryIndex<K>::toKey(Field& field) {
+  auto optionalSerialization = field.serialize(column);
+  if (!optionalSerialization.unwrappable()) {
+    return Optional<K>(VerdantStatus::INVALID_TYPE);
+  }
+  return toKey(optionalSerialization.unwrap());
+}
+
+template <typename K> K TypedPrimaryIndex<K>::toKey(std::pair<const char*, size_t> value) {
+  K key;
+  std::memset(static_cast<void*>(&key), 0, sizeof(K));
+  std::memcpy(static_cast<void*>(&key), value.first, std::min(value.second, sizeof(K)));
+  return key;
+}
+
+template <typename K> Optional<Location> TypedPrimaryIndex<K>::search(Field& key) {
+  auto optionalKey = toKey(key);
+  if (!optionalKey.unwrappable()) {
+    return Optional<Location>(optionalKey.status);
+  }
+  return tree.search(optionalKey.unwrap());
+}
+
+template <typename K> bool TypedPrimaryIndex<K>::insert(Field& key, Location location) {
+  auto optionalKey = toKey(key);
+  if (!optionalKey.unwrappable()) {
+    return false;
+  }
+  return tree.insert(optionalKey.unwrap(), location);
+}
+
+template <typename K> bool TypedPrimaryIndex<K>::insert(std::pair<const char*, size_t> value, Location location) {
+  return tree.insert(toKey(value), location);
+}
+
+template <typename K> bool TypedPrimaryIndex<K>::isDirty() {
+  return tree.isDirty();
+}
+
+template <typename K> void TypedPrimaryIndex<K>::save() {
+  tree.save();
+}
@@ -0,0 +1,147 @@
+#include "record_layout.h"
+
+#include <cstring>
+
+RecordLayout::RecordLayout(const Columns& columns) : variableCount(0) {
+  this->columns.resize(columns.size());
+  for (auto& column : columns) {
+    this->columns[column.second.first] = std::make_pair(column.first, column.second.second);
+  }
+  bitmapSize = (this->columns.size() + 7) / 8;
+  fixedSize = bitmapSize;
+  offsets.resize(this->columns.size());
+  for (size_t i = 0; i < this->columns.size(); i++) {
+    switch (this->columns[i].second.type) {
+    case ColumnInfo::INT:
+    case ColumnInfo::FLOAT:
+      offsets[i] = fixedSize;
+      fixedSize += this->columns[i].second.getSize();
+      break;
+    case ColumnInfo::VARCHAR:
+      offsets[i] = variableCount++;
+      break;
+    }
+  }
+}
+
+size_t RecordLayout::getVarintSize(size_t value) {
+  size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    size++;
+  }
+  return size;
+}
+
+// Seven bits per byte, low bits first, high bit set on all but the last byte
+size_t RecordLayout::writeVarint(char* destination, size_t value) {
+  size_t size = 0;
+  while (value >= 0x80) {
+    destination[size++] = static_cast<char>((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  destination[size++] = static_cast<char>(value);
+  return size;
+}
+
+size_t RecordLayout::readVarint(const char* source, size_t& value) {
+  value = 0;
+  size_t size = 0;
+  unsigned shift = 0;
+  while (true) {
+    unsigned char byte = static_cast<unsigned char>(source[size++]);
+    value |= static_cast<size_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return size;
+    }
+    shift += 7;
+  }
+}
+
+size_t RecordLayout::getColumnCount() const {
+  return columns.size();
+}
+
+const std::string& RecordLayout::getName(size_t column) const {
+  return columns[column].first;
+}
+
+const ColumnInfo& RecordLayout::getInfo(size_t column) const {
+  return columns[column].second;
+}
+
+size_t RecordLayout::getSize(const std::vector<size_t>& variableLengths) const {
+  size_t size = fixedSize;
+  for (size_t length : variableLengths) {
+    size += getVarintSize(length) + length;
+  }
+  return size;
+}
+
+size_t RecordLayout::getMaxSize() const {
+  size_t size = fixedSize;
+  for (auto& column : columns) {
+    if (column.second.type == ColumnInfo::VARCHAR) {
+      size += column.second.getSize();
+    }
+  }
+  return size;
+}
+
+void RecordLayout::encode(const std::vector<std::pair<const char*, size_t>>& values, char* destination) const {
+  std::memset(destination, 0, fixedSize);
+  size_t lengthsSize = 0;
+  for (size_t i = 0; i < columns.size(); i++) {
+    if (columns[i].second.type == ColumnInfo::VARCHAR) {
+      lengthsSize += getVarintSize(values[i].first == nullptr ? 0 : values[i].second);
+    }
+  }
+  char* lengths = &destination[fixedSize];
+  char* data = &lengths[lengthsSize];
+  for (size_t i = 0; i < columns.size(); i++) {
+    const char* value = values[i].first;
+    if (value == nullptr) {
+      destination[i / 8] |= static_cast<char>(1 << (i % 8));
+    }
+    if (columns[i].second.type != ColumnInfo::VARCHAR) {
+      if (value != nullptr) {
+        std::memcpy(&destination[offsets[i]], value, values[i].second);
+      }
+      continue;
+    }
+    size_t length = value == nullptr ? 0 : values[i].second;
+    lengths += writeVarint(lengths, length);
+    if (length > 0) {
+      std::memcpy(data, value, length);
+    }
+    data += length;
+  }
+}
+
+bool RecordLayout::isNull(const char* record, size_t column) const {
+  return (record[column / 8] >> (column % 8)) & 1;
+}
+
+// A VARCHAR value is found by skipping the lengths and values of the VARCHAR
+// columns before it
+std::pair<const char*, size_t> RecordLayout::getValue(const char* record, size_t column) const {
+  const ColumnInfo& info = columns[column].second;
+  if (info.type != ColumnInfo::VARCHAR) {
+    return std::make_pair(&record[offsets[column]], info.getSize());
+  }
+  const char* lengths = &record[fixedSize];
+  size_t skipped = 0;
+  size_t length = 0;
+  for (size_t i = 0; i <= offsets[column]; i++) {
+    lengths += readVarint(lengths, length);
+    if (i < offsets[column]) {
+      skipped += length;
+    }
+  }
+  // The remaining lengths come before the data
+  for (size_t i = offsets[column] + 1; i < variableCount; i++) {
+    size_t ignored;
+    lengths += readVarint(lengths, ignored);
+  }
+  return std::make_pair(&lengths[skipped], length);
+}
@@ -4,19 +4,34 @@
 #include <algorithm>
 #include <cctype>
 #include <array>
+#include <initializer_list>
+#include <utility>
 
 std::ostream& operator<<(std::ostream& os, const Token& obj) {
   os << "{" << obj.type << ", " << obj.value << "}";
   return os;
 }
 
-Scanner::Scanner(const std::string& text) : ptr(0), line(1), text(text) {}
+Scanner::Scanner(std::string_view text) : ptr(0), line(1), text(text) {}
 
 Optional<std::vector<Token>> Scanner::scan() {
   std::vector<Token> tokens;
+  if (!scan(tokens)) {
+    return Optional<std::vector<Token>>(VerdantStatus::INVALID_SYNTAX);
+  }
+  return Optional<std::vector<Token>>(std::move(tokens));
+}
+
+bool Scanner::scan(std::vector<Token>& tokens) {
+  tokens.clear();
+  this->ptr = 0;
+  this->line = 1;
 
   while (ptr < text.size()) {
     skipBlank();
+    if (ptr >= text.size()) {
+      break;
+    }
     if (text[ptr] == ';') {
       tokens.push_back({ Token::TOKEN_SEMICOLON, ";", line });
       ptr++;
@@ -46,21 +61,70 @@ Optional<std::vector<Token>> Scanner::scan() {
       ptr++;
       continue;
     }
+    if (text[ptr] == '*') {
+      tokens.push_back({ Token::TOKEN_STAR, "*", line });
+      ptr++;
+      continue;
+    }
+    if (text[ptr] == '?') {
+      tokens.push_back({ Token::TOKEN_PARAMETER, "?", line });
+      ptr++;
+      continue;
+    }
+    if (text[ptr] == '=') {
+      tokens.push_back({ Token::TOKEN_EQUAL, "=", line });
+      ptr++;
+      continue;
+    }
+    if (text[ptr] == '!' || text[ptr] == '<' || text[ptr] == '>') {
+      std::string_view op = text.substr(ptr, 2);
+      if (op == "!=" || op == "<>") {
+        tokens.push_back({ Token::TOKEN_NOT_EQUAL, op, line });
+      } else if (op == "<=") {
+        tokens.push_back({ Token::TOKEN_LESS_EQUAL, op, line });
+      } else if (op == ">=") {
+        tokens.push_back({ Token::TOKEN_GREATER_EQUAL, op, line });
+      } else if (text[ptr] == '<') {
+        op = "<";
+        tokens.push_back({ Token::TOKEN_LESS, op, line });
+      } else if (text[ptr] == '>') {
+        op = ">";
+        tokens.push_back({ Token::TOKEN_GREATER, op, line });
+      } else {
+        std::cerr << "[ERROR] Line " << line << ": unexpected character " << text[ptr] << std::endl;
+        return false;
+      }
+      ptr += op.size();
+      continue;
+    }
 
-    if (std::isdigit(text[ptr])) {
-      size_t endPtr = ptr;
+    if (text[ptr] == '\'') {
+      size_t endPtr = text.find('\'', ptr + 1);
+      if (endPtr == std::string_view::npos) {
+        std::cerr << "[ERROR] Line " << line << ": unterminated string" << std::endl;
+        return false;
+      }
+      tokens.push_back({ Token::TOKEN_STRING_VALUE, text.substr(ptr + 1, endPtr - ptr - 1), line });
+      line += std::count(text.begin() + ptr, text.begin() + endPtr, '\n');
+      ptr = endPtr + 1;
+      continue;
+    }
+
+    bool isNegative = text[ptr] == '-' && ptr + 1 < text.size() && std::isdigit(text[ptr + 1]);
+    if (std::isdigit(text[ptr]) || isNegative) {
+      size_t endPtr = isNegative ? ptr + 1 : ptr;
       bool isFloat = false;
-      constexpr std::array<char, 5> allowedCharacters = {' ', '\n', '\t', '(', ')'};
+      constexpr std::array<char, 12> allowedCharacters = {' ', '\n', '\t', '\r', '(', ')', ',', ';', '=', '<', '>', '!'};
       while (endPtr < text.size() && std::find(allowedCharacters.begin(), allowedCharacters.end(), text[endPtr]) == allowedCharacters.end()) {
         char cur = text[endPtr];
         if (cur != '.' && !std::isdigit(cur)) {
           std::cerr << "[ERROR] Line " << line << ": unexpected character " << cur << std::endl;
-          return Optional<typeof tokens>(VerdantStatus::INVALID_SYNTAX);
+          return false;
         }
         if (cur == '.') {
           if (isFloat) {
             std::cerr << "[ERROR] Line " << line << ": unexpected character " << cur << std::endl;
-            return Optional<typeof tokens>(VerdantStatus::INVALID_SYNTAX);
+            return false;
           }
           isFloat = true;
         }
@@ -74,28 +138,8 @@ Optional<std::vector<Token>> Scanner::scan() {
         endPtr++;
       }
   
-      std::string tokenString = text.substr(ptr, endPtr - ptr);
-      std::string lowerTokenString = Utility::toLower(tokenString);
-  
-      if (lowerTokenString == "create") {
-        tokens.push_back({ Token::TOKEN_CREATE, tokenString, line });
-      } else if (lowerTokenString == "database") {
-        tokens.push_back({ Token::TOKEN_DATABASE, tokenString, line });
-      } else if (lowerTokenString == "table") {
-        tokens.push_back({ Token::TOKEN_TABLE, tokenString, line });
-      } else if (lowerTokenString == "int") {
-        tokens.push_back({ Token::TOKEN_INT, tokenString, line });
-      } else if (lowerTokenString == "float") {
-        tokens.push_back({ Token::TOKEN_FLOAT, tokenString, line });
-      } else if (lowerTokenString == "varchar") {
-        tokens.push_back({ Token::TOKEN_VARCHAR, tokenString, line });
-      } else if (lowerTokenString == "primary") {
-        tokens.push_back({ Token::TOKEN_PRIMARY, tokenString, line });
-      } else if (lowerTokenString == "key") {
-        tokens.push_back({ Token::TOKEN_KEY, tokenString, line });
-      } else {
-        tokens.push_back({ Token::TOKEN_IDENTIFIER, tokenString, line });
-      }
+      std::string_view word = text.substr(ptr, endPtr - ptr);
+      tokens.push_back({ getKeyword(word), word, line });
 
       ptr = endPtr;
     } else {
@@ -103,14 +147,50 @@ Optional<std::vector<Token>> Scanner::scan() {
     }
   }
 
-  Optional<typeof tokens> returnValue = tokens;
-  return returnValue;
+  return true;
+}
+
+static Token::TokenType matchKeyword(std::string_view word,
+                                     std::initializer_list<std::pair<std::string_view, Token::TokenType>> keywords) {
+  for (auto& keyword : keywords) {
+    if (Utility::equalsLower(word, keyword.first)) {
+      return keyword.second;
+    }
+  }
+  return Token::TOKEN_IDENTIFIER;
+}
+
+// Keywords by length, compared in place instead of lowering a copy
+Token::TokenType Scanner::getKeyword(std::string_view word) {
+  switch (word.size()) {
+    case 2:
+      return matchKeyword(word, { { "as", Token::TOKEN_AS } });
+    case 3:
+      return matchKeyword(word, { { "int", Token::TOKEN_INT }, { "key", Token::TOKEN_KEY },
+                                  { "and", Token::TOKEN_AND }, { "sum", Token::TOKEN_SUM } });
+    case 4:
+      return matchKeyword(word, { { "into", Token::TOKEN_INTO }, { "from", Token::TOKEN_FROM } });
+    case 5:
+      return matchKeyword(word, { { "table", Token::TOKEN_TABLE }, { "float", Token::TOKEN_FLOAT },
+                                  { "where", Token::TOKEN_WHERE }, { "count", Token::TOKEN_COUNT } });
+    case 6:
+      return matchKeyword(word, { { "create", Token::TOKEN_CREATE }, { "insert", Token::TOKEN_INSERT },
+                                  { "values", Token::TOKEN_VALUES }, { "layout", Token::TOKEN_LAYOUT },
+                                  { "select", Token::TOKEN_SELECT } });
+    case 7:
+      return matchKeyword(word, { { "varchar", Token::TOKEN_VARCHAR }, { "primary", Token::TOKEN_PRIMARY },
+                                  { "prepare", Token::TOKEN_PREPARE }, { "execute", Token::TOKEN_EXECUTE } });
+    case 8:
+      return matchKeyword(word, { { "database", Token::TOKEN_DATABASE } });
+    default:
+      return Token::TOKEN_IDENTIFIER;
+  }
 }
 
 void Scanner::skipBlank() {
-  constexpr std::array<char, 3> blanks = {' ', '\t', '\n'};
-  while (std::find(blanks.begin(), blanks.end(), text[ptr]) != blanks.end()) {
-    if (text[ptr] == ' ' or text[ptr] == '\t') {
+  constexpr std::array<char, 4> blanks = {' ', '\t', '\n', '\r'};
+  while (ptr < text.size() && std::find(blanks.begin(), blanks.end(), text[ptr]) != blanks.end()) {
+    if (text[ptr] == ' ' or text[ptr] == '\t' or text[ptr] == '\r') {
       ptr++;
       continue;
     }
@@ -0,0 +1,47 @@
+#include "script_reader.h"
+
+#include <algorithm>
+
+ScriptReader::ScriptReader(std::istream& in, size_t chunkSize)
+    : in(in), chunk(std::max(chunkSize, (size_t)1)), position(0), end(0) {}
+
+bool ScriptReader::fill() {
+  in.read(chunk.data(), chunk.size());
+  end = in.gcount();
+  position = 0;
+  return end > 0;
+}
+
+static bool isBlank(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool ScriptReader::next(std::string& statement) {
+  statement.clear();
+  bool isCommand = false;
+  bool isString = false;
+  while (position < end || fill()) {
+    char c = chunk[position++];
+    if (statement.empty()) {
+      // Blanks between statements are dropped
+      if (isBlank(c)) {
+        continue;
+      }
+      isCommand = c == '\\';
+    }
+    if (isCommand) {
+      if (c == '\n') {
+        return true;
+      }
+      statement.push_back(c);
+      continue;
+    }
+    statement.push_back(c);
+    if (c == '\'') {
+      isString = !isString;
+    } else if (c == ';' && !isString) {
+      return true;
+    }
+  }
+  return !statement.empty();
+}
@@ -0,0 +1,23 @@
+#include "select_stmt.h"
+
+#include "visitor.h"
+
+SelectStmt::SelectStmt(const std::string& table) : table(table) {}
+
+void SelectStmt::accept(Visitor* visitor) {
+  visitor->visit(this);
+}
+
+void SelectStmt::bind(const std::vector<const Token*>& values, size_t first) {
+  for (size_t i = 0; i < parameters.size(); i++) {
+    const Token* value = values[first + i];
+    Condition& condition = conditions[parameters[i]];
+    condition.value = value->value;
+    condition.isString = value->type == Token::TOKEN_STRING_VALUE;
+  }
+}
+
+// The copy shares the plan
+std::unique_ptr<Stmt> SelectStmt::clone() const {
+  return std::unique_ptr<Stmt>(new SelectStmt(*this));
+}
@@ -0,0 +1,106 @@
+#include "simd_search.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VERDANT_SIMD_X86
+#endif
+
+// Window size at which the binary search hands over to the linear count
+static const size_t LINEAR_WINDOW = 32;
+
+template <typename T> static size_t countLessScalar(const T* values, size_t size, T value) {
+  size_t count = 0;
+  for (size_t i = 0; i < size; i++) {
+    count += values[i] < value;
+  }
+  return count;
+}
+
+#ifdef VERDANT_SIMD_X86
+static bool hasAvx2() {
+  static const bool supported = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+  return supported;
+}
+
+// Each kernel counts the values less than value in the first blocks full
+// vectors and leaves the tail to the caller
+
+__attribute__((target("avx2"))) static size_t countLessAvx2(const int* values, size_t blocks, int value) {
+  __m256i key = _mm256_set1_epi32(value);
+  size_t count = 0;
+  for (size_t i = 0; i < blocks; i++) {
+    __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i * 8));
+    __m256i less = _mm256_cmpgt_epi32(key, block);
+    count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(less)));
+  }
+  return count;
+}
+
+__attribute__((target("avx2"))) static size_t countLessAvx2(const long long* values, size_t blocks, long long value) {
+  __m256i key = _mm256_set1_epi64x(value);
+  size_t count = 0;
+  for (size_t i = 0; i < blocks; i++) {
+    __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i * 4));
+    __m256i less = _mm256_cmpgt_epi64(key, block);
+    count += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(less)));
+  }
+  return count;
+}
+
+__attribute__((target("avx2"))) static size_t countLessAvx2(const long* values, size_t blocks, long value) {
+  static_assert(sizeof(long) == sizeof(long long) || sizeof(long) == sizeof(int), "Unexpected size of long");
+  if (sizeof(long) == sizeof(long long)) {
+    return countLessAvx2(reinterpret_cast<const long long*>(values), blocks, (long long)value);
+  }
+  return countLessAvx2(reinterpret_cast<const int*>(values), blocks, (int)value);
+}
+
+__attribute__((target("avx2"))) static size_t countLessAvx2(const float* values, size_t blocks, float value) {
+  __m256 key = _mm256_set1_ps(value);
+  size_t count = 0;
+  for (size_t i = 0; i < blocks; i++) {
+    __m256 block = _mm256_loadu_ps(values + i * 8);
+    count += __builtin_popcount(_mm256_movemask_ps(_mm256_cmp_ps(block, key, _CMP_LT_OQ)));
+  }
+  return count;
+}
+
+__attribute__((target("avx2"))) static size_t countLessAvx2(const double* values, size_t blocks, double value) {
+  __m256d key = _mm256_set1_pd(value);
+  size_t count = 0;
+  for (size_t i = 0; i < blocks; i++) {
+    __m256d block = _mm256_loadu_pd(values + i * 4);
+    count += __builtin_popcount(_mm256_movemask_pd(_mm256_cmp_pd(block, key, _CMP_LT_OQ)));
+  }
+  return count;
+}
+#endif
+
+template <typename T> static size_t countLess(const T* values, size_t size, T value) {
+#ifdef VERDANT_SIMD_X86
+  if (hasAvx2()) {
+    const size_t lanes = 32 / sizeof(T);
+    size_t blocks = size / lanes;
+    return countLessAvx2(values, blocks, value) + countLessScalar(values + blocks * lanes, size - blocks * lanes, value);
+  }
+#endif
+  return countLessScalar(values, size, value);
+}
+
+template <typename T> size_t simdLowerBound(const T* values, size_t size, const T& value) {
+  // Everything before base is less than value and the answer is at most
+  // base + size, so halving never needs a branch on the comparison
+  const T* base = values;
+  while (size > LINEAR_WINDOW) {
+    size_t half = size / 2;
+    base = base[half] < value ? base + half : base;
+    size -= half;
+  }
+  return (base - values) + countLess(base, size, value);
+}
+
+template size_t simdLowerBound<int>(const int* values, size_t size, const int& value);
+template size_t simdLowerBound<long>(const long* values, size_t size, const long& value);
+template size_t simdLowerBound<long long>(const long long* values, size_t size, const long long& value);
+template size_t simdLowerBound<float>(const float* values, size_t size, const float& value);
+template size_t simdLowerBound<double>(const double* values, size_t size, const double& value);
@@ -1,10 +1,18 @@
 #include "sql_interpreter.h"
+#include "catalog.h"
 #include "create_stmt.h"
 #include "database_node.h"
+#include "insert_stmt.h"
+#include "parallel_scan.h"
 #include "parameters.h"
+#include "pax_layout.h"
+#include "plan_cache.h"
 #include "status.h"
 #include "table.h"
+#include "table_cache.h"
+#include "table_node.h"
 #include "util.h"
+#include "vector_executor.h"
 
 #include <iostream>
 
@@ -26,6 +34,144 @@ void SQLInterpreter::visit(const CreateStmt *node) {
   node->creation->accept(this);
 }
 
+// Resolves a table through the catalog of the connected database
+Optional<const TableSchema *> SQLInterpreter::loadSchema(const std::string &table) {
+  auto optionalSchema = context.catalog->getSchema(table);
+  if (!optionalSchema.unwrappable()) {
+    std::cerr << "[ERROR] Table '" << table << "' does not exist" << std::endl;
+  }
+  return optionalSchema;
+}
+
+void SQLInterpreter::visit(const InsertStmt *node) {
+  if (!context.database.unwrappable()) {
+    std::cerr << "[ERROR] No database currently connected" << std::endl;
+    this->status = VerdantStatus::UNSPECIFIED_DATABASE;
+    return;
+  }
+
+  auto optionalSchema = loadSchema(node->table);
+  if (!optionalSchema.unwrappable()) {
+    this->status = optionalSchema.status;
+    return;
+  }
+  const TableSchema &schema = *optionalSchema.unwrap();
+  const Columns &columns = schema.columns;
+
+  std::vector<std::string> names = node->columns;
+  if (names.empty()) {
+    names.resize(columns.size());
+    for (auto &column : columns) {
+      names[column.second.first] = column.first;
+    }
+  }
+
+  std::vector<std::vector<Field>> records;
+  records.reserve(node->rows.size());
+  for (auto &row : node->rows) {
+    if (row.size() != names.size()) {
+      std::cerr << "[ERROR] Expect " << names.size() << " values per row" << std::endl;
+      this->status = VerdantStatus::INVALID_SYNTAX;
+      return;
+    }
+    std::vector<Field> record;
+    record.reserve(row.size());
+    for (size_t i = 0; i < row.size(); i++) {
+      record.push_back({names[i], row[i]});
+    }
+    records.push_back(std::move(record));
+  }
+
+  auto table = context.tables->open(context.database.peek(), node->table, schema);
+  // Durable once addRecords returns, as the table commits through the log;
+  // the pages are written back on eviction, checkpoint or close
+  size_t inserted = table->addRecords(records);
+
+  this->status = inserted == records.size() ? VerdantStatus::SUCCESS : VerdantStatus::INVALID_TYPE;
+}
+
+void SQLInterpreter::visit(const SelectStmt *node) {
+  if (!context.database.unwrappable()) {
+    std::cerr << "[ERROR] No database currently connected" << std::endl;
+    this->status = VerdantStatus::UNSPECIFIED_DATABASE;
+    return;
+  }
+
+  auto optionalSchema = loadSchema(node->table);
+  if (!optionalSchema.unwrappable()) {
+    this->status = optionalSchema.status;
+    return;
+  }
+  const TableSchema &schema = *optionalSchema.unwrap();
+
+  auto table = context.tables->open(context.database.peek(), node->table, schema);
+  auto optionalPlan = getPlan(*node, table->getLayout());
+  if (!optionalPlan.unwrappable()) {
+    this->status = optionalPlan.status;
+    return;
+  }
+  SelectPlan plan = optionalPlan.unwrap();
+  if (!plan.aggregates.empty()) {
+    ParallelScan(*table, plan).run(std::cout);
+  } else {
+    size_t count = VectorExecutor(*table, plan).run(std::cout);
+    std::cout << "(" << count << (count == 1 ? " row)" : " rows)") << std::endl;
+  }
+
+  this->status = VerdantStatus::SUCCESS;
+}
+
+// A cached or prepared statement builds its plan on the first run in the
+// database, and later runs only bind the values of the conditions into a
+// copy of it
+Optional<SelectPlan> SQLInterpreter::getPlan(const SelectStmt &node, const RecordLayout &layout) {
+  const auto &shared = node.sharedPlan;
+  if (shared != nullptr && shared->plan != nullptr && shared->database == context.database.peek()) {
+    SelectPlan plan = *shared->plan;
+    if (!plan.bind(layout, node.conditions)) {
+      return Optional<SelectPlan>(VerdantStatus::INVALID_TYPE);
+    }
+    return plan;
+  }
+  auto optionalPlan = SelectPlan::create(layout, node);
+  if (shared != nullptr && optionalPlan.unwrappable()) {
+    shared->database = context.database.peek();
+    shared->plan = std::make_shared<const SelectPlan>(optionalPlan.peek());
+  }
+  return optionalPlan;
+}
+
+void SQLInterpreter::visit(const PrepareStmt *node) {
+  context.plans->prepare(node->name, node->statement);
+  this->status = VerdantStatus::SUCCESS;
+}
+
+void SQLInterpreter::visit(const ExecuteStmt *node) {
+  auto optionalStatement = context.plans->getPrepared(node->name);
+  if (!optionalStatement.unwrappable()) {
+    std::cerr << "[ERROR] Prepared statement '" << node->name << "' does not exist" << std::endl;
+    this->status = VerdantStatus::INVALID_SYNTAX;
+    return;
+  }
+  std::shared_ptr<AST> statement = optionalStatement.unwrap();
+  std::vector<const Token *> values;
+  for (auto &value : node->values) {
+    values.push_back(&value);
+  }
+  auto optionalBound = PlanCache::bind(*statement, values);
+  if (!optionalBound.unwrappable()) {
+    if (optionalBound.status == VerdantStatus::INVALID_TYPE) {
+      std::cerr << "[ERROR] Invalid value for '" << node->name << "'" << std::endl;
+    } else {
+      std::cerr << "[ERROR] Expect " << PlanCache::getParameterCount(*statement) << " values for '" << node->name
+                << "'" << std::endl;
+    }
+    this->status = optionalBound.status;
+    return;
+  }
+  this->status = SQLInterpreter(*optionalBound.unwrap(), context).interpret();
+}
+
 void SQLInterpreter::visit(const TableNode *node) {
   if (!context.database.unwrappable()) {
     std::cerr << "[ERROR] No database currently connected" << std::endl;
@@ -33,18 +179,29 @@ void SQLInterpreter::visit(const TableNode *node) {
     return;
   }
   
-  std::unique_ptr<Table> masterTable = Table::getMasterTable(context.database.peek());
-  std::vector<Field> record;
-  record.push_back({"name", node->getName()});
-  record.push_back({"type", std::to_string(VerdantObjectType::TABLE)});
-  record.push_back({"create_statement", *context.statement.peek()});
-  masterTable->addRecord(record);
-  Columns columns = std::move(node->columns);
-
-  Table newTable(&context, node->getName(), std::move(columns));
-
-  masterTable->save();
-  newTable.save();
+  if (context.catalog->hasTable(node->getName())) {
+    std::cerr << "[ERROR] Table '" << node->getName() << "' already exists" << std::endl;
+    this->status = VerdantStatus::INVALID_SYNTAX;
+    return;
+  }
+  TableSchema schema;
+  schema.columns = node->columns;
+  schema.layout = node->layout;
+  if (schema.layout == PAX_LAYOUT) {
+    RecordLayout layout(schema.columns);
+    if (!PaxLayout(layout).isUsable()) {
+      std::cerr << "[ERROR] A row of '" << node->getName() << "' does not fit in a PAX page" << std::endl;
+      this->status = VerdantStatus::INVALID_SYNTAX;
+      return;
+    }
+  }
+  if (!context.catalog->addTable(node->getName(), schema, *context.statement.peek())) {
+    std::cerr << "[ERROR] Cannot create the table '" << node->getName() << "'" << std::endl;
+    this->status = VerdantStatus::INVALID_SYNTAX;
+    return;
+  }
+
+  context.tables->open(context.database.peek(), node->getName(), schema)->save();
 
   this->status = VerdantStatus::SUCCESS;
 }
@@ -1,14 +1,21 @@
 #include "sql_parser.h"
 #include "ast_node.h"
 #include "create_stmt.h"
+#include "execute_stmt.h"
+#include "insert_stmt.h"
+#include "prepare_stmt.h"
+#include "select_stmt.h"
 #include "status.h"
 #include "database_node.h"
+#include "parameters.h"
 #include "table_node.h"
+#include "util.h"
 #include <algorithm>
 #include <cstdio>
 #include <memory>
 
-SQLParser::SQLParser(const std::vector<Token>& tokens) : tokens(tokens) {}
+SQLParser::SQLParser(const std::vector<Token>& tokens, bool parameterizeLiterals)
+    : tokens(tokens), parameterizeLiterals(parameterizeLiterals), isPreparing(false) {}
 
 const Token* const SQLParser::eat() {
   return &tokens[this->ptr++];
@@ -41,7 +48,8 @@ Optional<const Token*> SQLParser::peek() const {
 }
 
 OptionalNode SQLParser::error(const std::string& message) {
-  std::cerr << "[ERROR] Line " << tokens[this->ptr].line << ": " << message << std::endl;
+  const Token& token = this->ptr < tokens.size() ? tokens[this->ptr] : tokens.back();
+  std::cerr << "[ERROR] Line " << token.line << ": " << message << std::endl;
   return OptionalNode(nullptr);
 }
 
@@ -81,7 +89,7 @@ OptionalNode SQLParser::createStmt() {
         return OptionalNode(VerdantStatus::INVALID_SYNTAX);
       }
 
-      return std::unique_ptr<ASTNode>(new CreateStmt(std::unique_ptr<VerdantObject>(new DatabaseNode(eat()->value))));
+      return std::unique_ptr<ASTNode>(new CreateStmt(std::unique_ptr<VerdantObject>(new DatabaseNode(std::string(eat()->value)))));
     }
     case (Token::TOKEN_TABLE): {
       this->eat(); // TABLE
@@ -90,7 +98,7 @@ OptionalNode SQLParser::createStmt() {
         std::cerr << "[ERROR] Line " << current()->line << ": " << "Expect identifier after TABLE" << std::endl;
         return OptionalNode(VerdantStatus::INVALID_SYNTAX);
       }
-      std::unique_ptr<TableNode> table(new TableNode(eat()->value));
+      std::unique_ptr<TableNode> table(new TableNode(std::string(eat()->value)));
       if (!this->consume(Token::TOKEN_LEFT_PAREN, "Expected '(' after table identifier").unwrappable()) {
         return OptionalNode(VerdantStatus::INVALID_SYNTAX);
       }
@@ -100,7 +108,7 @@ OptionalNode SQLParser::createStmt() {
         if (!optionalName.unwrappable()) {
           return VerdantStatus::INVALID_SYNTAX;
         }
-        std::string name  = optionalName.unwrap()->value;
+        std::string name(optionalName.unwrap()->value);
         auto optionalTypeToken = multiConsume({ Token::TOKEN_VARCHAR, Token::TOKEN_INT, Token::TOKEN_FLOAT }, "Expect type after column identifier");
         if (!optionalTypeToken.unwrappable()) {
           return VerdantStatus::INVALID_SYNTAX;
@@ -130,7 +138,7 @@ OptionalNode SQLParser::createStmt() {
           if (!optionalLength.unwrappable()) {
             return VerdantStatus::INVALID_SYNTAX;
           }
-          sscanf(optionalLength.unwrap()->value.c_str(), "%zu", &length);
+          sscanf(std::string(optionalLength.unwrap()->value).c_str(), "%zu", &length);
           if (!consume(Token::TOKEN_RIGHT_PAREN, "Expect ')' after integer").unwrappable()) {
             return VerdantStatus::INVALID_SYNTAX;
           }
@@ -140,6 +148,10 @@ OptionalNode SQLParser::createStmt() {
           if (!consume(Token::TOKEN_KEY, "Expect 'KEY' after 'PRIMARY'").unwrappable()) {
             return VerdantStatus::INVALID_SYNTAX;
           }
+          if (type == ColumnInfo::VARCHAR && length > MAX_INDEX_KEY_SIZE) {
+            std::cerr << "[ERROR] Line " << current()->line << ": " << "Primary key cannot be longer than " << MAX_INDEX_KEY_SIZE << " characters" << std::endl;
+            return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+          }
           isPrimaryKey = true;
           numPrimary++;
         } 
@@ -148,11 +160,28 @@ OptionalNode SQLParser::createStmt() {
         if (!addResult) {
           return OptionalNode(VerdantStatus::INVALID_SYNTAX);
         }
-        if (!this->multiConsume({ Token::TOKEN_RIGHT_PAREN, Token::TOKEN_COMMA}, "Expect ')' or ',' after column declaration").unwrappable()) {
+        auto optionalSeparator = this->multiConsume({ Token::TOKEN_RIGHT_PAREN, Token::TOKEN_COMMA}, "Expect ')' or ',' after column declaration");
+        if (!optionalSeparator.unwrappable()) {
           return OptionalNode(VerdantStatus::INVALID_SYNTAX);
         }
+        if (optionalSeparator.unwrap()->type == Token::TOKEN_RIGHT_PAREN) {
+          break;
+        }
       }
       this->match(Token::TOKEN_RIGHT_PAREN); // Optional ',' before ')'
+      if (this->match(Token::TOKEN_LAYOUT)) {
+        auto optionalLayout = consume(Token::TOKEN_IDENTIFIER, "Expect ROW or PAX after LAYOUT");
+        if (!optionalLayout.unwrappable()) {
+          return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+        }
+        std::string_view layout = optionalLayout.unwrap()->value;
+        if (Utility::equalsLower(layout, "pax")) {
+          table->layout = PAX_LAYOUT;
+        } else if (!Utility::equalsLower(layout, "row")) {
+          this->error("Expect ROW or PAX after LAYOUT");
+          return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+        }
+      }
       if (numPrimary > 1) {
         std::cerr << "[ERROR] Too many primary key columns declared" << std::endl;
         return OptionalNode(VerdantStatus::INVALID_SYNTAX);
@@ -160,8 +189,234 @@ OptionalNode SQLParser::createStmt() {
       return std::unique_ptr<ASTNode>(new CreateStmt(std::move(table)));
     }
     default:
-      return this->error("Invalid token " + this->current()->value);
+      return this->error("Invalid token " + std::string(this->current()->value));
+  }
+}
+
+OptionalNode SQLParser::insertStmt() {
+  if (!consume(Token::TOKEN_INTO, "Expect 'INTO' after 'INSERT'").unwrappable()) {
+    return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+  }
+  auto optionalTable = consume(Token::TOKEN_IDENTIFIER, "Expect table identifier after 'INTO'");
+  if (!optionalTable.unwrappable()) {
+    return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+  }
+  std::unique_ptr<InsertStmt> insert(new InsertStmt(std::string(optionalTable.unwrap()->value)));
+
+  if (match(Token::TOKEN_LEFT_PAREN)) {
+    do {
+      auto optionalColumn = consume(Token::TOKEN_IDENTIFIER, "Expect column identifier");
+      if (!optionalColumn.unwrappable()) {
+        return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+      }
+      insert->columns.emplace_back(optionalColumn.unwrap()->value);
+    } while (match(Token::TOKEN_COMMA));
+    if (!consume(Token::TOKEN_RIGHT_PAREN, "Expect ')' after column list").unwrappable()) {
+      return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+    }
+  }
+
+  if (!consume(Token::TOKEN_VALUES, "Expect 'VALUES' after table").unwrappable()) {
+    return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+  }
+  size_t position = 0;
+  do {
+    if (!consume(Token::TOKEN_LEFT_PAREN, "Expect '(' before values").unwrappable()) {
+      return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+    }
+    std::vector<std::string> row;
+    do {
+      auto optionalValue = value(insert->parameters, position++, "Expect value");
+      if (!optionalValue.unwrappable()) {
+        return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+      }
+      row.emplace_back(optionalValue.unwrap()->value);
+    } while (match(Token::TOKEN_COMMA));
+    if (!consume(Token::TOKEN_RIGHT_PAREN, "Expect ')' after values").unwrappable()) {
+      return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+    }
+    if (!insert->columns.empty() && row.size() != insert->columns.size()) {
+      this->error("Expect " + std::to_string(insert->columns.size()) + " values per row");
+      return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+    }
+    insert->rows.push_back(std::move(row));
+  } while (match(Token::TOKEN_COMMA));
+
+  return std::unique_ptr<ASTNode>(std::move(insert));
+}
+
+// A literal, or a '?' parameter inside PREPARE. Parameters, and every literal
+// when literals are parameterized, are recorded at their position.
+Optional<const Token*> SQLParser::value(std::vector<size_t>& parameters, size_t position, const std::string& message) {
+  auto optionalValue = multiConsume({ Token::TOKEN_INT_VALUE, Token::TOKEN_FLOAT_VALUE, Token::TOKEN_STRING_VALUE,
+                                      Token::TOKEN_PARAMETER }, message);
+  if (!optionalValue.unwrappable()) {
+    this->error(message);
+    return Optional<const Token*>(VerdantStatus::INVALID_SYNTAX);
+  }
+  const Token* token = optionalValue.unwrap();
+  if (token->type == Token::TOKEN_PARAMETER && !isPreparing) {
+    this->ptr--;
+    this->error("Parameters are only allowed in PREPARE");
+    return Optional<const Token*>(VerdantStatus::INVALID_SYNTAX);
+  }
+  if (token->type == Token::TOKEN_PARAMETER || parameterizeLiterals) {
+    parameters.push_back(position);
+  }
+  return token;
+}
+
+// COUNT(* | column) or SUM(column), after the function name
+bool SQLParser::aggregate(Aggregate::Function function, std::vector<Aggregate>& aggregates) {
+  if (!consume(Token::TOKEN_LEFT_PAREN, "Expect '(' after aggregate function").unwrappable()) {
+    return false;
+  }
+  Aggregate aggregate = { function, "" };
+  if (function != Aggregate::COUNT || !match(Token::TOKEN_STAR)) {
+    auto optionalColumn = consume(Token::TOKEN_IDENTIFIER, "Expect column identifier in aggregate");
+    if (!optionalColumn.unwrappable()) {
+      return false;
+    }
+    aggregate.column = optionalColumn.unwrap()->value;
+  }
+  if (!consume(Token::TOKEN_RIGHT_PAREN, "Expect ')' after aggregate argument").unwrappable()) {
+    return false;
   }
+  aggregates.push_back(std::move(aggregate));
+  return true;
+}
+
+// SELECT (* | column, ... | aggregate, ...) FROM table
+//   [WHERE column op literal [AND ...]]
+OptionalNode SQLParser::selectStmt() {
+  std::vector<std::string> columns;
+  std::vector<Aggregate> aggregates;
+  if (!match(Token::TOKEN_STAR)) {
+    do {
+      if (match(Token::TOKEN_COUNT) || match(Token::TOKEN_SUM)) {
+        auto function = tokens[this->ptr - 1].type == Token::TOKEN_COUNT ? Aggregate::COUNT : Aggregate::SUM;
+        if (!aggregate(function, aggregates)) {
+          return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+        }
+        continue;
+      }
+      auto optionalColumn = consume(Token::TOKEN_IDENTIFIER, "Expect column identifier or '*' after 'SELECT'");
+      if (!optionalColumn.unwrappable()) {
+        return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+      }
+      columns.emplace_back(optionalColumn.unwrap()->value);
+    } while (match(Token::TOKEN_COMMA));
+  }
+  if (!columns.empty() && !aggregates.empty()) {
+    this->error("Cannot select columns together with aggregates");
+    return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+  }
+  if (!consume(Token::TOKEN_FROM, "Expect 'FROM' after columns").unwrappable()) {
+    return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+  }
+  auto optionalTable = consume(Token::TOKEN_IDENTIFIER, "Expect table identifier after 'FROM'");
+  if (!optionalTable.unwrappable()) {
+    return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+  }
+  std::unique_ptr<SelectStmt> select(new SelectStmt(std::string(optionalTable.unwrap()->value)));
+  select->columns = std::move(columns);
+  select->aggregates = std::move(aggregates);
+
+  if (!match(Token::TOKEN_WHERE)) {
+    return std::unique_ptr<ASTNode>(std::move(select));
+  }
+  do {
+    auto optionalColumn = consume(Token::TOKEN_IDENTIFIER, "Expect column identifier in condition");
+    if (!optionalColumn.unwrappable()) {
+      return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+    }
+    auto optionalOperator = multiConsume({ Token::TOKEN_EQUAL, Token::TOKEN_NOT_EQUAL, Token::TOKEN_LESS, Token::TOKEN_LESS_EQUAL,
+                                           Token::TOKEN_GREATER, Token::TOKEN_GREATER_EQUAL }, "Expect comparison operator");
+    if (!optionalOperator.unwrappable()) {
+      this->error("Expect comparison operator after column");
+      return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+    }
+    auto optionalValue = value(select->parameters, select->conditions.size(), "Expect value after comparison operator");
+    if (!optionalValue.unwrappable()) {
+      return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+    }
+    Condition condition;
+    condition.column = optionalColumn.unwrap()->value;
+    switch (optionalOperator.unwrap()->type) {
+      case Token::TOKEN_EQUAL:
+        condition.op = Condition::EQUAL;
+        break;
+      case Token::TOKEN_NOT_EQUAL:
+        condition.op = Condition::NOT_EQUAL;
+        break;
+      case Token::TOKEN_LESS:
+        condition.op = Condition::LESS;
+        break;
+      case Token::TOKEN_LESS_EQUAL:
+        condition.op = Condition::LESS_EQUAL;
+        break;
+      case Token::TOKEN_GREATER:
+        condition.op = Condition::GREATER;
+        break;
+      default:
+        condition.op = Condition::GREATER_EQUAL;
+        break;
+    }
+    const Token *value = optionalValue.unwrap();
+    condition.value = value->value;
+    condition.isString = value->type == Token::TOKEN_STRING_VALUE;
+    select->conditions.push_back(std::move(condition));
+  } while (match(Token::TOKEN_AND));
+
+  return std::unique_ptr<ASTNode>(std::move(select));
+}
+
+// PREPARE name AS (INSERT ... | SELECT ...)
+OptionalNode SQLParser::prepareStmt() {
+  auto optionalName = consume(Token::TOKEN_IDENTIFIER, "Expect statement identifier after 'PREPARE'");
+  if (!optionalName.unwrappable()) {
+    return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+  }
+  if (!consume(Token::TOKEN_AS, "Expect 'AS' after statement identifier").unwrappable()) {
+    return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+  }
+  if (this->ptr >= tokens.size() || (!checkCurrentType(Token::TOKEN_INSERT) && !checkCurrentType(Token::TOKEN_SELECT))) {
+    this->error("Expect INSERT or SELECT after 'AS'");
+    return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+  }
+  isPreparing = true;
+  OptionalNode optionalStatement = this->stmt();
+  isPreparing = false;
+  if (!optionalStatement.unwrappable()) {
+    return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+  }
+  std::shared_ptr<AST> statement(new AST());
+  statement->addRoot(optionalStatement.unwrap());
+  return std::unique_ptr<ASTNode>(new PrepareStmt(std::string(optionalName.unwrap()->value), std::move(statement)));
+}
+
+// EXECUTE name [(literal, ...)]
+OptionalNode SQLParser::executeStmt() {
+  auto optionalName = consume(Token::TOKEN_IDENTIFIER, "Expect statement identifier after 'EXECUTE'");
+  if (!optionalName.unwrappable()) {
+    return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+  }
+  std::unique_ptr<ExecuteStmt> execute(new ExecuteStmt(std::string(optionalName.unwrap()->value)));
+  if (!match(Token::TOKEN_LEFT_PAREN)) {
+    return std::unique_ptr<ASTNode>(std::move(execute));
+  }
+  do {
+    auto optionalValue = multiConsume({ Token::TOKEN_INT_VALUE, Token::TOKEN_FLOAT_VALUE, Token::TOKEN_STRING_VALUE }, "Expect value");
+    if (!optionalValue.unwrappable()) {
+      this->error("Expect value");
+      return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+    }
+    execute->values.push_back(*optionalValue.unwrap());
+  } while (match(Token::TOKEN_COMMA));
+  if (!consume(Token::TOKEN_RIGHT_PAREN, "Expect ')' after values").unwrappable()) {
+    return OptionalNode(VerdantStatus::INVALID_SYNTAX);
+  }
+  return std::unique_ptr<ASTNode>(std::move(execute));
 }
 
 OptionalNode SQLParser::stmt() {
@@ -170,6 +425,22 @@ OptionalNode SQLParser::stmt() {
       this->eat();
       return this->createStmt();
     }
+    case (Token::TOKEN_INSERT): {
+      this->eat();
+      return this->insertStmt();
+    }
+    case (Token::TOKEN_SELECT): {
+      this->eat();
+      return this->selectStmt();
+    }
+    case (Token::TOKEN_PREPARE): {
+      this->eat();
+      return this->prepareStmt();
+    }
+    case (Token::TOKEN_EXECUTE): {
+      this->eat();
+      return this->executeStmt();
+    }
     default:
       std::cerr << "[ERROR] Invalid token: '" << current()->value << "'" << std::endl;
       return OptionalNode(VerdantStatus::INVALID_SYNTAX);
@@ -195,7 +466,7 @@ Optional<AST> SQLParser::parse() {
     ast.addRoot(std::move(node));
 
     if (this->ptr < tokens.size() and tokens[this->ptr].type != Token::TOKEN_SEMICOLON) {
-      this->error("Invalid token at the end: " + current()->value);
+      this->error("Invalid token at the end: " + std::string(current()->value));
       return Optional<AST>();
     }
   }
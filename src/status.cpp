@@ -26,6 +26,8 @@ const std::string VerdantStatus::errorCodeToString(VerdantStatus::StatusEnum sta
     return "GENERIC_ERROR";
   case VerdantStatus::UNIMPLEMENTED:
     return "UNIMPLEMENTED";
+  case VerdantStatus::OUT_OF_MEMORY:
+    return "OUT_OF_MEMORY";
   }
   return "UNKNOWN_ERROR";
 }
@@ -0,0 +1,7 @@
+#include "stmt.h"
+
+void Stmt::bind(const std::vector<const Token*>& values, size_t first) {}
+
+std::unique_ptr<Stmt> Stmt::clone() const {
+  return nullptr;
+}
@@ -3,75 +3,85 @@
 #include "parameters.h"
 #include "status.h"
 #include "util.h"
+#include "async_io.h"
 #include "verdant_object.h"
+#include "wal.h"
+#include <algorithm>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <ios>
 #include <iosfwd>
 #include <string>
 #include <tuple>
+#include <unordered_set>
 #include <utility>
 
-static size_t getBlockCount(std::fstream &file) {
-  std::streampos currentPosition = file.tellg();
-  file.seekg(0, std::ios::end);
-  std::streampos endPosition = file.tellg();
-  file.seekg(currentPosition);
-  return static_cast<size_t>(endPosition) / BLOCK_SIZE;
-}
-
-static bool openFile(std::fstream &file, const std::string &path) {
-  file.open(path, std::ios::in | std::ios::out | std::ios::binary);
-  if (!file.is_open()) {
-    // Create a new file
-    file.open(path, std::ios::out | std::ios::binary);
-    file.close();
-    file.open(path, std::ios::in | std::ios::out | std::ios::binary);
-  }
-  return true;
-}
-
-TableBlock::TableBlock(std::fstream &file, size_t index)
-    : file(file), index(index) {
-  size_t blockCount = getBlockCount(file);
+TableBlock::TableBlock(BlockFile &file, size_t index, const PaxLayout *pax)
+    : file(file), index(index), lsn(0), pax(pax) {
+  size_t blockCount = file.getBlockCount();
   if (index > blockCount) {
 #ifdef VERDANT_FLAG_DEBUG
     std::cerr << "[ERROR] Trying to create a block out of bound: " << index << "/" << blockCount << std::endl;
 #endif
     VerdantStatus::handleError(VerdantStatus::INTERNAL_ERROR);
   }
-  if (index == blockCount) {
-    std::memset(&this->block, 0, BLOCK_SIZE);
-    recordCount = 0;
-    nextAddress = 0;
+  if (file.isMapped()) {
+    // A view over the mapping; the page guard stays empty
+    block = file.getMappedBlock(index);
+    if (block == nullptr) {
+      VerdantStatus::handleError(VerdantStatus::INTERNAL_ERROR);
+    }
   } else {
-    file.seekg(index * BLOCK_SIZE);
-    file.read(reinterpret_cast<char *>(&this->block), BLOCK_SIZE);
-    recordCount = getRecordCountOnFile();
-    nextAddress = getNextAddressOnFile();
+    Optional<PageGuard> optionalPage = index == blockCount
+                                           ? BufferPool::getInstance().newPage(file)
+                                           : BufferPool::getInstance().fetchPage(file, index);
+    if (!optionalPage.unwrappable()) {
+      VerdantStatus::handleError(optionalPage.status);
+    }
+    page = optionalPage.unwrap();
+    block = page.getData();
   }
+#ifdef VERDANT_FLAG_DEBUG
+  if (index == blockCount) {
+    std::cout << "[DEBUG] New block created" << std::endl;
+  }
+#endif
 }
 
-size_t TableBlock::getRecordCountOnFile() {
+size_t TableBlock::getRecordCount() {
+  if (pax != nullptr) {
+    return PaxLayout::readRowCount(block);
+  }
   size_t num;
   std::memcpy(&num, &block[BLOCK_SIZE - sizeof(size_t)], sizeof(size_t));
   return num;
 }
 
-size_t TableBlock::getNextAddressOnFile() {
+size_t TableBlock::getNextAddress() {
   size_t nextAddress;
   std::memcpy(&nextAddress, &block[BLOCK_SIZE - 2 * sizeof(size_t)],
               sizeof(size_t));
   return nextAddress;
 }
 
+void TableBlock::setRecordCount(size_t recordCount) {
+  std::memcpy(&block[BLOCK_SIZE - sizeof(size_t)], &recordCount, sizeof(size_t));
+  page.markDirty();
+}
+
+void TableBlock::setNextAddress(size_t nextAddress) {
+  std::memcpy(&block[BLOCK_SIZE - 2 * sizeof(size_t)], &nextAddress, sizeof(size_t));
+  page.markDirty();
+}
+
 Optional<size_t> TableBlock::getRecordAddress(size_t index) {
-  size_t numRecords = getRecordCountOnFile();
+  size_t numRecords = getRecordCount();
   if (index > numRecords) {
     return Optional<size_t>();
   }
   if (index == numRecords) {
-    return getNextAddressOnFile();
+    return getNextAddress();
   }
   size_t address;
   std::memcpy(&address, &block[BLOCK_SIZE - (2 + index + 1) * sizeof(size_t)],
@@ -80,102 +90,242 @@ Optional<size_t> TableBlock::getRecordAddress(size_t index) {
 }
 
 bool TableBlock::isEnoughSpace(Buffer &buffer) {
-  size_t bookkeepLocation = getBookkeepLocation();
-  return bookkeepLocation - nextAddress >= sizeof(size_t) + buffer.second;
+  if (pax != nullptr) {
+    return pax->isEnoughSpace(block, buffer.first.get());
+  }
+  return getFreeSpace() >= sizeof(size_t) + buffer.second;
 }
 
+// Records are written straight into the pinned page; the buffer pool writes
+// the whole page back when it is flushed or evicted. The change is logged as
+// the record bytes, its pointer and the two bookkeeping fields, and lsn is
+// left at the log record. A PAX block logs the slots the row took in every
+// minipage instead.
 bool TableBlock::addRecord(Buffer &&buffer) {
   if (!isEnoughSpace(buffer)) {
     return false;
   }
-  size_t size = buffer.second;
-  changes.push_back(std::make_tuple(recordCount++, nextAddress, std::move(buffer)));
-  nextAddress += size;
+  if (pax != nullptr) {
+    lsn = WriteAheadLog::getInstance().append(file.getPath(), index, block, pax->addRow(block, buffer.first.get()));
+    page.markDirty(lsn);
+    return true;
+  }
+  size_t recordCount = getRecordCount();
+  size_t nextAddress = getNextAddress();
+  std::memcpy(&block[nextAddress], buffer.first.get(), buffer.second);
+  saveRecordPointer(recordCount, nextAddress);
+  setRecordCount(recordCount + 1);
+  setNextAddress(nextAddress + buffer.second);
+  lsn = WriteAheadLog::getInstance().append(
+      file.getPath(), index, block,
+      {{nextAddress, buffer.second},
+       {BLOCK_SIZE - (3 + recordCount) * sizeof(size_t), sizeof(size_t)},
+       {BLOCK_SIZE - 2 * sizeof(size_t), 2 * sizeof(size_t)}});
+  page.markDirty(lsn);
   return true;
 }
 
+// Bytes left between the records and the record pointers
+size_t TableBlock::getFreeSpace() {
+  if (pax != nullptr) {
+    return pax->getFreeSpace(block);
+  }
+  return getBookkeepLocation() - getNextAddress();
+}
+
 size_t TableBlock::getBookkeepLocation() {
-  return BLOCK_SIZE - 2 * sizeof(size_t) - recordCount * sizeof(size_t);
+  return BLOCK_SIZE - 2 * sizeof(size_t) - getRecordCount() * sizeof(size_t);
 }
 
 Optional<BinaryRecord> TableBlock::getRecord(size_t index) {
-  size_t numRecords = getRecordCountOnFile();
+  if (pax == nullptr) {
+    return readRecord(block, index);
+  }
+  if (index >= PaxLayout::readRowCount(block)) {
+    return Optional<BinaryRecord>();
+  }
+  pax->readRow(block, index, row);
+  return Optional<BinaryRecord>(std::make_pair(row.data(), row.size()));
+}
+
+// Bookkeeping readers over a raw block, shared with TableScanner, which
+// holds blocks outside of the buffer pool
+size_t TableBlock::readRecordCount(const char *block) {
+  size_t num;
+  std::memcpy(&num, &block[BLOCK_SIZE - sizeof(size_t)], sizeof(size_t));
+  return num;
+}
+
+Optional<BinaryRecord> TableBlock::readRecord(const char *block, size_t index) {
+  size_t numRecords = readRecordCount(block);
   if (index >= numRecords) {
     return Optional<BinaryRecord>();
   }
-  const char *record = &block[getRecordAddress(index).unwrap()];
-  size_t size =
-      getRecordAddress(index + 1).unwrap() - getRecordAddress(index).unwrap();
+  size_t address;
+  std::memcpy(&address, &block[BLOCK_SIZE - (2 + index + 1) * sizeof(size_t)], sizeof(size_t));
+  // The record ends where the next one starts, or at nextAddress for the last
+  size_t endAddress;
+  size_t endOffset = index + 1 == numRecords ? BLOCK_SIZE - 2 * sizeof(size_t)
+                                             : BLOCK_SIZE - (2 + index + 2) * sizeof(size_t);
+  std::memcpy(&endAddress, &block[endOffset], sizeof(size_t));
+
+  return Optional<BinaryRecord>(std::make_pair(&block[address], endAddress - address));
+}
 
-  return Optional<BinaryRecord>(std::make_pair(record, size));
+TableScanner::TableScanner(BlockFile &file, size_t readAhead, size_t ioDepth, const PaxLayout *pax,
+                           size_t firstBlock, size_t endBlock)
+    : file(file), pax(pax), firstBlock(firstBlock), endBlock(endBlock), blocks(nullptr),
+      readAhead(std::max(readAhead, (size_t)1)), nextBlock(firstBlock), bufferedBlocks(0), bufferIndex(0),
+      recordIndex(0), nextRead(firstBlock), currentChunk(0) {
+  if (file.isMapped()) {
+    return;
+  }
+  ioDepth = std::max(ioDepth, (size_t)1);
+  char *memory = static_cast<char *>(std::aligned_alloc(BLOCK_SIZE, ioDepth * this->readAhead * BLOCK_SIZE));
+  if (memory == nullptr) {
+    VerdantStatus::handleError(VerdantStatus::OUT_OF_MEMORY);
+  }
+  buffer = Utility::BufferUniquePtr<char>(memory);
+  if (ioDepth > 1) {
+    io = AsyncIO::create(ioDepth);
+    chunks.resize(ioDepth);
+  }
 }
 
-void TableBlock::saveRecordPointer(size_t changeIndex, size_t pointer) {
-  std::memcpy(&this->block[BLOCK_SIZE - 2 * sizeof(size_t) - (changeIndex + 1) * sizeof(size_t)], reinterpret_cast<char*>(&pointer), sizeof(size_t));
-  file.seekg((this->index + 1) * BLOCK_SIZE - 2 * sizeof(size_t) - (changeIndex + 1) * sizeof(size_t));
-  file.write(reinterpret_cast<char*>(&pointer), sizeof(size_t));
+// Reuses a chunk of the buffer for the next readAhead blocks not requested
+// yet. A chunk left with a zero size marks the end of the file.
+void TableScanner::requestChunk(size_t chunk) {
+  size_t blockCount = getEndBlock();
+  size_t count = nextRead < blockCount ? std::min(readAhead, blockCount - nextRead) : 0;
+  chunks[chunk] = {&file.getDevice(), false, nextRead * BLOCK_SIZE,
+                   &buffer.get()[chunk * readAhead * BLOCK_SIZE], count * BLOCK_SIZE, 0, count == 0};
+  if (count > 0 && !io->submit(&chunks[chunk])) {
+    VerdantStatus::handleError(VerdantStatus::INTERNAL_ERROR);
+  }
+  nextRead += count;
 }
 
-void TableBlock::save() {
-  if (getBlockCount(file) == this->index) {
-    file.seekg(this->index * BLOCK_SIZE);
-    file.write(this->block, 8192);
-#ifdef VERDANT_FLAG_DEBUG
-    std::cout << "[DEBUG] New block created" << std::endl;
-#endif
+// Replaces the buffer content with the next run of blocks. A mapped file is
+// read in place instead. With an I/O engine the buffer is split into chunks
+// that are read in order and kept in flight ahead of the chunk being scanned.
+bool TableScanner::fill() {
+  nextBlock += bufferedBlocks;
+  size_t blockCount = getEndBlock();
+  if (file.isMapped()) {
+    bufferedBlocks = nextBlock < blockCount ? std::min(readAhead, blockCount - nextBlock) : 0;
+    blocks = bufferedBlocks > 0 ? file.getMappedBlock(nextBlock) : nullptr;
+  } else if (io == nullptr) {
+    bufferedBlocks = nextBlock < blockCount ? file.readBlocks(nextBlock, std::min(readAhead, blockCount - nextBlock), buffer.get()) : 0;
+    blocks = buffer.get();
+  } else {
+    if (nextRead == firstBlock) {
+      for (size_t chunk = 0; chunk < chunks.size(); chunk++) {
+        requestChunk(chunk);
+      }
+    } else {
+      // The chunk just scanned is free again
+      requestChunk(currentChunk);
+      currentChunk = (currentChunk + 1) % chunks.size();
+    }
+    io->start();
+    IORequest &chunk = chunks[currentChunk];
+    std::vector<IORequest *> completed;
+    while (!chunk.done && io->reap(completed, 1) > 0) {
+    }
+    bufferedBlocks = chunk.done && chunk.result > 0 ? chunk.result / BLOCK_SIZE : 0;
+    blocks = chunk.data;
   }
+  bufferIndex = 0;
+  recordIndex = 0;
+  return bufferedBlocks > 0;
+}
 
-  for (auto &change : changes) {
-    size_t position = std::get<1>(change);
-    Buffer &buffer = std::get<2>(change);
-    char *changePtr = buffer.first.get();
-    size_t changeSize = buffer.second;
-#ifdef VERDANT_FLAG_DEBUG
-    std::cout << "Position of change relative to block: " << position << std::endl;
-    std::cout << "Size of change: " << changeSize << std::endl;
-#endif
-    std::memcpy(&this->block[position], changePtr, changeSize);
-    file.seekp(this->index * BLOCK_SIZE + position);
-#ifdef VERDANT_FLAG_DEBUG
-    std::cout << "Current position: " << file.tellp() << std::endl;
-#endif
-    file.write(changePtr, changeSize);
+Optional<BinaryRecord> TableScanner::next() {
+  while (true) {
+    if (bufferIndex == bufferedBlocks && !fill()) {
+      return Optional<BinaryRecord>(VerdantStatus::OUT_OF_BOUND);
+    }
+    const char *block = &blocks[bufferIndex * BLOCK_SIZE];
+    if (pax != nullptr) {
+      if (recordIndex < PaxLayout::readRowCount(block)) {
+        pax->readRow(block, recordIndex++, row);
+        return Optional<BinaryRecord>(std::make_pair(row.data(), row.size()));
+      }
+    } else if (recordIndex < TableBlock::readRecordCount(block)) {
+      return TableBlock::readRecord(block, recordIndex++);
+    }
+    bufferIndex++;
+    recordIndex = 0;
   }
-  for (auto& change: changes) {
-    this->saveRecordPointer(std::get<0>(change), std::get<1>(change));
+}
+
+// recordIndex is 1 while the current block has been returned
+Optional<const char *> TableScanner::nextPage() {
+  if (recordIndex > 0) {
+    bufferIndex++;
   }
-  changes.clear();
-  // Write recordCount
-  std::memcpy(&this->block[BLOCK_SIZE - sizeof(size_t)], reinterpret_cast<char*>(&recordCount), sizeof(size_t));
+  if (bufferIndex == bufferedBlocks && !fill()) {
+    return Optional<const char *>(VerdantStatus::OUT_OF_BOUND);
+  }
+  recordIndex = 1;
+  return &blocks[bufferIndex * BLOCK_SIZE];
+}
+
+size_t TableScanner::getEndBlock() const {
+  return std::min(endBlock, file.getBlockCount());
+}
 
-  file.seekp((this->index + 1) * (BLOCK_SIZE) - sizeof(size_t));
-  file.write(reinterpret_cast<char*>(&recordCount), sizeof(size_t));
+// Block of the record returned last
+size_t TableScanner::getBlockIndex() const {
+  return nextBlock + bufferIndex;
+}
 
-  // Write next pointer
-  std::memcpy(&this->block[BLOCK_SIZE - 2 * sizeof(size_t)], reinterpret_cast<char*>(&nextAddress), sizeof(size_t));
-  file.seekp((this->index + 1) * BLOCK_SIZE - 2 * sizeof(size_t));
-  file.write(reinterpret_cast<char*>(&nextAddress), sizeof(size_t));
+void TableBlock::saveRecordPointer(size_t recordIndex, size_t pointer) {
+  std::memcpy(&this->block[BLOCK_SIZE - 2 * sizeof(size_t) - (recordIndex + 1) * sizeof(size_t)], reinterpret_cast<char*>(&pointer), sizeof(size_t));
+  page.markDirty();
+}
+
+// A mapped block is written back by msync, so its log records are made
+// durable first
+void TableBlock::save() {
+  if (file.isMapped() && lsn != 0 && !WriteAheadLog::getInstance().flush(lsn)) {
+    VerdantStatus::handleError(VerdantStatus::INTERNAL_ERROR);
+  }
+  bool saved = file.isMapped() ? file.syncBlock(index) : BufferPool::getInstance().flushPage(file, index);
+  if (!saved) {
+    VerdantStatus::handleError(VerdantStatus::INTERNAL_ERROR);
+  }
 }
 
-Table::Table(Context *context, const std::string &name, Columns &&columns)
-    : columns(std::move(columns)), context(context) {
-  std::string absolutePath =
-      Utility::getDatabasePath(context->database.peek()) + name;
-  if (!openFile(file, absolutePath)) {
+Table::Table(Context *context, const std::string &name, Columns &&columns, BlockFile::Mode mode,
+             PageLayout pageLayout)
+    : log(WriteAheadLog::getInstance()),
+      file(Utility::getDatabasePath(context->database.peek()) + name, mode),
+      freeSpace(file.getPath() + ".vfsm"),
+      columns(std::move(columns)), layout(this->columns),
+      pax(pageLayout == PAX_LAYOUT ? new PaxLayout(layout) : nullptr), context(context),
+      mappedLsn(0) {
+  if (!file.isOpen()) {
     std::cerr << "[ERROR] Cannot create the table '" << name << "'" << std::endl;
     VerdantStatus::handleError(VerdantStatus::INVALID_PERMISSION);
   }
+  loadFreeSpace();
+  openPrimaryIndex();
 }
 
 Table::Table(const std::string &database, const std::string &name,
-             Columns &&columns)
-    : columns(columns),
-      context(Optional<Context *>(VerdantStatus::UNSPECIFIED_DATABASE)) {
-  std::string absolutePath = Utility::getDatabasePath(database) + name;
-  if (!openFile(file, absolutePath)) {
+             Columns &&columns, BlockFile::Mode mode, PageLayout pageLayout)
+    : log(WriteAheadLog::getInstance()),
+      file(Utility::getDatabasePath(database) + name, mode),
+      freeSpace(file.getPath() + ".vfsm"), columns(columns), layout(this->columns),
+      pax(pageLayout == PAX_LAYOUT ? new PaxLayout(layout) : nullptr),
+      context(Optional<Context *>(VerdantStatus::UNSPECIFIED_DATABASE)), mappedLsn(0) {
+  if (!file.isOpen()) {
     std::cerr << "[ERROR] Cannot create the table '" << name << "'" << std::endl;
     VerdantStatus::handleError(VerdantStatus::INVALID_PERMISSION);
   }
+  loadFreeSpace();
+  openPrimaryIndex();
 }
 
 std::unique_ptr<Table> Table::createMasterTable(const std::string &database) {
@@ -208,72 +358,313 @@ std::unique_ptr<Table> Table::getMasterTable(const std::string &database) {
   return verdantMaster;
 }
 
-Table::~Table() { file.close(); }
+Table::~Table() {
+  // Every statement has committed, so the index is saved clean. It flushes
+  // its own pages; drop it before the table file.
+  if (primaryIndex != nullptr) {
+    primaryIndex->save();
+    primaryIndex = nullptr;
+  }
+  freeSpace.save();
+  flushLog();
+  BufferPool::getInstance().evictFile(file);
+}
+
+void Table::openPrimaryIndex() {
+  for (auto &column : columns) {
+    if (!column.second.second.isPrimary) {
+      continue;
+    }
+    primaryColumn = column.first;
+    primaryIndex = PrimaryIndex::create(file.getPath() + ".vidx", column.second.second);
+    if (primaryIndex == nullptr) {
+      VerdantStatus::handleError(VerdantStatus::INVALID_TYPE);
+    }
+    if (primaryIndex->isDirty()) {
+      rebuildPrimaryIndex(column.second.second);
+    }
+    return;
+  }
+}
+
+// An index left dirty may miss changes or hold keys of records the log never
+// made durable. The table itself has been recovered from the log by now, so
+// the index is built again from a scan of it.
+void Table::rebuildPrimaryIndex(const ColumnInfo &column) {
+  std::string path = file.getPath() + ".vidx";
+  primaryIndex = nullptr;
+  std::remove(path.c_str());
+  primaryIndex = PrimaryIndex::create(path, column);
+  size_t keyColumn = columns[primaryColumn].first;
+  auto scanner = scan();
+  size_t blockIndex = SIZE_MAX;
+  size_t recordIndex = 0;
+  while (true) {
+    auto optionalRecord = scanner->next();
+    if (!optionalRecord.unwrappable()) {
+      break;
+    }
+    if (scanner->getBlockIndex() != blockIndex) {
+      blockIndex = scanner->getBlockIndex();
+      recordIndex = 0;
+    }
+    auto value = layout.getValue(optionalRecord.unwrap().first, keyColumn);
+    primaryIndex->insert(value, std::make_pair(blockIndex, recordIndex++));
+  }
+  primaryIndex->save();
+#ifdef VERDANT_FLAG_DEBUG
+  std::cout << "[DEBUG] Rebuilt the primary index of " << file.getPath() << std::endl;
+#endif
+}
+
+// A mapped file is written back by msync, which must not run ahead of the log
+// records of the blocks. The kernel may still write a changed block back on
+// its own before the statement commits; commit keeps that window to one
+// statement.
+void Table::flushLog() {
+  if (mappedLsn != 0 && !log.flush(mappedLsn)) {
+    VerdantStatus::handleError(VerdantStatus::INTERNAL_ERROR);
+  }
+}
 
 void Table::save() {
-  for (auto &idxAndBlock : loadedBlocks) {
-    idxAndBlock.second->save();
+  if (primaryIndex != nullptr) {
+    primaryIndex->save();
+  }
+  freeSpace.save();
+  flushLog();
+  if (!BufferPool::getInstance().flushFile(file)) {
+    VerdantStatus::handleError(VerdantStatus::INTERNAL_ERROR);
   }
 }
 
-Optional<TableBlock *> Table::getBlock(size_t index) {
-  size_t blockCount = getBlockCount(file);
-  if (index < 0 || index > blockCount) {
-    return Optional<TableBlock *>(VerdantStatus::OUT_OF_BOUND);
+// A block the free space map says has room for the record, or a new block.
+// Entries found to be wrong are corrected on the way.
+std::unique_ptr<TableBlock> Table::findBlock(Buffer &buffer) {
+  while (true) {
+    auto candidate = freeSpace.find(getRequiredSpace(buffer));
+    if (!candidate.unwrappable()) {
+      return getBlock(file.getBlockCount()).unwrap();
+    }
+    std::unique_ptr<TableBlock> block = getBlock(candidate.unwrap()).unwrap();
+    if (block->isEnoughSpace(buffer)) {
+      return block;
+    }
+    freeSpace.update(block->index, block->getFreeSpace());
+  }
+}
+
+// Free space the record takes in a block, in the units of getFreeSpace
+size_t Table::getRequiredSpace(Buffer &buffer) {
+  return pax != nullptr ? pax->getRequiredSpace(buffer.first.get()) : sizeof(size_t) + buffer.second;
+}
+
+// Rebuilds the entries of the blocks missing from the map from the blocks
+// themselves, e.g. when the map was lost or not saved before a crash
+void Table::loadFreeSpace() {
+  if (freeSpace.getBlockCount() > file.getBlockCount()) {
+    freeSpace.clear();
+  }
+  for (size_t index = freeSpace.getBlockCount(); index < file.getBlockCount(); index++) {
+    freeSpace.update(index, getBlock(index).unwrap()->getFreeSpace());
   }
-  if (loadedBlocks.find(index) == loadedBlocks.end()) {
-    loadedBlocks[index] =
-        std::unique_ptr<TableBlock>(new TableBlock(file, index));
+}
+
+Optional<std::unique_ptr<TableBlock>> Table::getBlock(size_t index) {
+  size_t blockCount = file.getBlockCount();
+  if (index > blockCount) {
+    return Optional<std::unique_ptr<TableBlock>>(VerdantStatus::OUT_OF_BOUND);
   }
-  return loadedBlocks[index].get();
+  return std::unique_ptr<TableBlock>(new TableBlock(file, index, pax.get()));
 }
 
 bool Table::addRecord(std::vector<Field> &fields) {
-  size_t blockCount = getBlockCount(file);
   OptionalBuffer optionalBuffer = createBuffer(fields);
   if (!optionalBuffer.unwrappable()) {
     return false;
   }
   Buffer buffer = optionalBuffer.unwrap();
+  if (!checkRecord(fields, buffer)) {
+    return false;
+  }
+  std::unique_ptr<TableBlock> block;
+  placeRecord(fields, std::move(buffer), block);
+  commit(block);
+  return true;
+}
 
-  if (blockCount > 0) {
-    TableBlock *lastBlock = getBlock(blockCount - 1).unwrap();
-
-    if (lastBlock->isEnoughSpace(buffer)) {
-      lastBlock->addRecord(std::move(buffer));
-#ifdef VERDANT_FLAG_DEBUG
-      std::cout << "Number of changes: " << lastBlock->changes.size() << std::endl;
-#endif
-      
-      return true;
+// Every record is validated before the first one is written, so a batch is
+// added either whole or not at all. The tail block stays pinned while it
+// fills up, so each page is packed in memory and later written back by the
+// buffer pool with a single block write.
+size_t Table::addRecords(std::vector<std::vector<Field>> &records) {
+  std::vector<Buffer> buffers;
+  buffers.reserve(records.size());
+  // Encoded keys of the batch, so keys of equal value but different text,
+  // like 7 and 07, are duplicates just as in the index
+  std::unordered_set<std::string> keys;
+  for (auto &fields : records) {
+    OptionalBuffer optionalBuffer = createBuffer(fields);
+    if (!optionalBuffer.unwrappable()) {
+      return 0;
     }
+    Buffer buffer = optionalBuffer.unwrap();
+    if (!checkRecord(fields, buffer)) {
+      return 0;
+    }
+    if (primaryIndex != nullptr) {
+      auto key = layout.getValue(buffer.first.get(), columns[primaryColumn].first);
+      if (!keys.emplace(key.first, key.second).second) {
+        std::cerr << "[ERROR] Duplicate primary key '" << getPrimaryField(fields)->value << "'" << std::endl;
+        return 0;
+      }
+    }
+    buffers.push_back(std::move(buffer));
+  }
+
+  std::unique_ptr<TableBlock> block;
+  for (size_t i = 0; i < records.size(); i++) {
+    placeRecord(records[i], std::move(buffers[i]), block);
+  }
+  commit(block);
+  return records.size();
+}
+
+// Waits for the log records of the statement to be durable. Log records are
+// numbered in order, so the last block written carries the highest LSN of the
+// statement. Checkpoints run between statements, once the log grows large.
+void Table::commit(std::unique_ptr<TableBlock> &block) {
+  if (block == nullptr || block->lsn == 0) {
+    return;
+  }
+  if (!log.flush(block->lsn)) {
+    VerdantStatus::handleError(VerdantStatus::INTERNAL_ERROR);
+  }
+  block = nullptr;
+  if (log.getSize() >= WAL_CHECKPOINT_SIZE && !log.checkpoint()) {
+    VerdantStatus::handleError(VerdantStatus::INTERNAL_ERROR);
   }
+}
 
-  TableBlock *newBlock = getBlock(blockCount).unwrap();
+// nullptr for a table without a primary key. createBuffer makes sure the
+// fields of a record include the key.
+Field *Table::getPrimaryField(std::vector<Field> &fields) {
+  if (primaryIndex == nullptr) {
+    return nullptr;
+  }
+  for (Field &field : fields) {
+    if (field.name == primaryColumn) {
+      return &field;
+    }
+  }
+  return nullptr;
+}
 
-  newBlock->addRecord(std::move(buffer));
+// Whether the record can be placed: it fits in a block and its key is not
+// taken yet
+bool Table::checkRecord(std::vector<Field> &fields, Buffer &buffer) {
+  // Record, its pointer, nextAddress and recordCount, or a row of an empty
+  // PAX block
+  bool isFitting = pax != nullptr ? pax->isFitting(buffer.first.get())
+                                  : buffer.second + 3 * sizeof(size_t) <= BLOCK_SIZE;
+  if (!isFitting) {
+    std::cerr << "[ERROR] Record does not fit in a block" << std::endl;
+    return false;
+  }
+  Field *primaryField = getPrimaryField(fields);
+  if (primaryField != nullptr && primaryIndex->search(*primaryField).unwrappable()) {
+    std::cerr << "[ERROR] Duplicate primary key '" << primaryField->value << "'" << std::endl;
+    return false;
+  }
   return true;
 }
 
-bool addRecordToField(std::vector<Field> &fields, Location location) {
-  return false;
+// Places a record that passed checkRecord
+void Table::placeRecord(std::vector<Field> &fields, Buffer &&buffer,
+                        std::unique_ptr<TableBlock> &block) {
+  if (block == nullptr || !block->isEnoughSpace(buffer)) {
+    block = findBlock(buffer);
+  }
+
+  Location location = std::make_pair(block->index, block->getRecordCount());
+  block->addRecord(std::move(buffer));
+  if (file.isMapped()) {
+    mappedLsn = block->lsn;
+  }
+  freeSpace.update(block->index, block->getFreeSpace());
+  Field *primaryField = getPrimaryField(fields);
+  if (primaryField != nullptr) {
+    primaryIndex->insert(*primaryField, location);
+  }
 }
 
-OptionalBuffer Table::createBuffer(std::vector<Field> &fields) {
-  if (fields.size() != columns.size()) {
-    std::cerr << "[ERROR] Invalid number of fields provided" << std::endl;
-    return OptionalBuffer(VerdantStatus::INVALID_TYPE);
+// Dirty pages are written back first, since the scan reads the file directly
+std::unique_ptr<TableScanner> Table::scan() {
+  flushBlocks();
+  return std::unique_ptr<TableScanner>(new TableScanner(file, TABLE_SCAN_READ_AHEAD, TABLE_SCAN_IO_DEPTH, pax.get()));
+}
+
+void Table::flushBlocks() {
+  flushLog();
+  if (!BufferPool::getInstance().flushFile(file)) {
+    VerdantStatus::handleError(VerdantStatus::INTERNAL_ERROR);
   }
+}
 
-  std::vector<std::pair<Field *, const ColumnInfo *>> orderedFields;
-  orderedFields.resize(fields.size());
+std::unique_ptr<TableScanner> Table::scanBlocks(size_t firstBlock, size_t endBlock) {
+  return std::unique_ptr<TableScanner>(
+      new TableScanner(file, endBlock - firstBlock, 1, pax.get(), firstBlock, endBlock));
+}
 
-  std::vector<bool> filled;
-  filled.resize(fields.size());
-  for (size_t i = 0; i < filled.size(); i++) {
-    filled[i] = false;
+size_t Table::getBlockCount() {
+  return file.getBlockCount();
+}
+
+size_t Table::getFileCount() const {
+  return primaryIndex != nullptr ? 2 : 1;
+}
+
+const RecordLayout &Table::getLayout() const {
+  return layout;
+}
+
+const PaxLayout *Table::getPaxLayout() const {
+  return pax.get();
+}
+
+Optional<Location> Table::findRecord(Field &key) {
+  if (primaryIndex == nullptr || key.name != primaryColumn) {
+    std::cerr << "[ERROR] Column '" << key.name << "' is not the primary key" << std::endl;
+    return Optional<Location>(VerdantStatus::INVALID_TYPE);
+  }
+  return primaryIndex->search(key);
+}
+
+Optional<std::vector<Field>> Table::getRecord(Location location) {
+  // getBlock hands out the block just past the end for appending, so the
+  // bound has to be checked before it would allocate one
+  if (location.first >= file.getBlockCount()) {
+    return Optional<std::vector<Field>>(VerdantStatus::OUT_OF_BOUND);
+  }
+  std::unique_ptr<TableBlock> block = getBlock(location.first).unwrap();
+  auto optionalRecord = block->getRecord(location.second);
+  if (!optionalRecord.unwrappable()) {
+    return Optional<std::vector<Field>>(VerdantStatus::OUT_OF_BOUND);
   }
-  size_t totalSize = 0;
+  return parseRecord(optionalRecord.unwrap());
+}
+
+bool addRecordToField(std::vector<Field> &fields, Location location) {
+  return false;
+}
+
+// Columns without a field are stored as NULL, except the primary key
+OptionalBuffer Table::createBuffer(std::vector<Field> &fields) {
+  std::vector<std::pair<const char *, size_t>> values;
+  values.resize(layout.getColumnCount(), std::make_pair(nullptr, 0));
+  std::vector<bool> filled;
+  filled.resize(layout.getColumnCount(), false);
+  std::vector<size_t> variableLengths;
   for (Field &field : fields) {
     if (columns.find(field.name) == columns.end()) {
       std::cerr << "[ERROR] Field name not found: " << field.name << std::endl;
@@ -290,46 +681,63 @@ OptionalBuffer Table::createBuffer(std::vector<Field> &fields) {
       std::cerr << "[ERROR] Invalid value for type " << std::endl;
       return OptionalBuffer(VerdantStatus::INVALID_TYPE);
     }
-    totalSize += sizeof(size_t) + info.getSize();
-    filled[index] = true;
-    orderedFields[index] = std::make_pair(&field, &info);
-  }
-
-  Utility::BufferUniquePtr<char> buffer((char *)calloc(totalSize, sizeof(char)));
-  size_t ptr = 0;
-  for (auto &pair : orderedFields) {
-    Field *field;
-    const ColumnInfo *info;
-    std::tie(field, info) = pair;
-    auto optionalSerialization = field->serialize(*info);
+    auto optionalSerialization = field.serialize(info);
     if (!optionalSerialization.unwrappable()) {
 #ifdef VERDANT_FLAG_DEBUG
       std::cerr << "[ERROR] Unreachable" << std::endl;
       VerdantStatus::handleError(VerdantStatus::INTERNAL_ERROR);
 #endif
+      return OptionalBuffer(VerdantStatus::INTERNAL_ERROR);
+    }
+    filled[index] = true;
+    values[index] = optionalSerialization.unwrap();
+  }
+
+  for (size_t i = 0; i < layout.getColumnCount(); i++) {
+    if (!filled[i] && layout.getInfo(i).isPrimary) {
+      std::cerr << "[ERROR] Missing value for the primary key '" << layout.getName(i) << "'"
+                << std::endl;
+      return OptionalBuffer(VerdantStatus::INVALID_TYPE);
     }
-    const char *serializedValue;
-    size_t valueSize;
-    std::tie(serializedValue, valueSize) = optionalSerialization.unwrap();
-    size_t fieldSize = info->getSize();
-    std::memcpy(&buffer.get()[ptr], &fieldSize, sizeof(size_t));
-    ptr += sizeof(size_t);
-    std::memcpy(&buffer.get()[ptr], &info->type,
-                sizeof(ColumnInfo::ColumnType));
-    ptr += sizeof(ColumnInfo::ColumnType);
-    switch (info->type) {
-    case ColumnInfo::INT:
-    case ColumnInfo::FLOAT:
-      std::memcpy(&buffer.get()[ptr], serializedValue, valueSize);
-      ptr += valueSize;
+    if (layout.getInfo(i).type == ColumnInfo::VARCHAR) {
+      variableLengths.push_back(filled[i] ? values[i].second : 0);
+    }
+  }
+
+  size_t totalSize = layout.getSize(variableLengths);
+  Utility::BufferUniquePtr<char> buffer((char *)malloc(totalSize));
+  layout.encode(values, buffer.get());
+  return std::make_pair(std::move(buffer), totalSize);
+}
+
+// NULL columns have no field
+std::vector<Field> Table::parseRecord(BinaryRecord record) {
+  std::vector<Field> fields;
+  const char *data = record.first;
+  for (size_t i = 0; i < layout.getColumnCount(); i++) {
+    if (layout.isNull(data, i)) {
+      continue;
+    }
+    const char *value;
+    size_t size;
+    std::tie(value, size) = layout.getValue(data, i);
+    switch (layout.getInfo(i).type) {
+    case ColumnInfo::INT: {
+      int intVal;
+      std::memcpy(&intVal, value, sizeof(int));
+      fields.push_back({layout.getName(i), std::to_string(intVal)});
+      break;
+    }
+    case ColumnInfo::FLOAT: {
+      float floatVal;
+      std::memcpy(&floatVal, value, sizeof(float));
+      fields.push_back({layout.getName(i), std::to_string(floatVal)});
       break;
+    }
     case ColumnInfo::VARCHAR:
-      std::memcpy(&buffer.get()[ptr], &valueSize, sizeof(size_t));
-      ptr += sizeof(size_t);
-      std::memcpy(&buffer.get()[ptr], serializedValue, valueSize);
-      ptr += valueSize;
+      fields.push_back({layout.getName(i), std::string(value, size)});
       break;
     }
   }
-  return std::make_pair(std::move(buffer), totalSize);
+  return fields;
 }
@@ -0,0 +1,69 @@
+#include "table_cache.h"
+
+#include <iostream>
+
+TableCache::TableCache(size_t capacity) : capacity(capacity), reserved(0), files(0) {}
+
+std::string TableCache::getKey(const std::string& database, const std::string& name) {
+  return database + "/" + name;
+}
+
+std::shared_ptr<Table> TableCache::open(const std::string& database, const std::string& name,
+                                        const TableSchema& schema) {
+  std::string key = getKey(database, name);
+  auto found = index.find(key);
+  if (found != index.end()) {
+    entries.splice(entries.begin(), entries, found->second);
+    return found->second->table;
+  }
+
+  Columns columns = schema.columns;
+  std::shared_ptr<Table> table(new Table(database, name, std::move(columns), TABLE_STORAGE_MODE, schema.layout));
+  entries.push_front({key, table, table->getFileCount()});
+  index[key] = entries.begin();
+  files += entries.front().files;
+  evict();
+#ifdef VERDANT_FLAG_DEBUG
+  std::cout << "[DEBUG] Opened table " << key << ", " << entries.size() << " tables and " << files
+            << " files open" << std::endl;
+#endif
+  return table;
+}
+
+// Tables still held by a statement are skipped, so the cache may stay over
+// capacity until they are released
+void TableCache::evict() {
+  auto it = entries.end();
+  while (files + reserved > capacity && it != entries.begin()) {
+    --it;
+    if (it->table.use_count() > 1) {
+      continue;
+    }
+    files -= it->files;
+    index.erase(it->key);
+    it = entries.erase(it);
+  }
+}
+
+bool TableCache::isOpen(const std::string& database, const std::string& name) const {
+  return index.find(getKey(database, name)) != index.end();
+}
+
+size_t TableCache::getSize() const {
+  return entries.size();
+}
+
+size_t TableCache::getFileCount() const {
+  return files;
+}
+
+void TableCache::reserve(size_t files) {
+  reserved = files;
+  evict();
+}
+
+void TableCache::clear() {
+  index.clear();
+  entries.clear();
+  files = 0;
+}
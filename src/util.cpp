@@ -2,6 +2,7 @@
 #include "parameters.h"
 #include <assert.h>
 #include <cctype>
+#include <charconv>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -83,11 +84,28 @@ bool isDirectoryExist(const std::string &userPath) {
     return false;
   }
 }
+std::string getDataPath() {
+  std::string userPath = DATA_PATH;
+  return userPath[0] == '~' ? expandUser(userPath) : userPath;
+}
+
 std::string getDatabasePath(const std::string &database) {
   std::string userPath = DATA_PATH + database + "/";
   return userPath[0] == '~' ? expandUser(userPath) : userPath;
 }
 
+bool equalsLower(std::string_view str, std::string_view lower) {
+  if (str.size() != lower.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < str.size(); i++) {
+    if (std::tolower(static_cast<unsigned char>(str[i])) != lower[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool isAlpha(const char c) {
   return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z');
 }
@@ -112,4 +130,16 @@ bool isInteger(const std::string &str) {
   }
   return true;
 }
+
+bool parseInt(std::string_view str, int &value) {
+  const char *last = str.data() + str.size();
+  auto result = std::from_chars(str.data(), last, value);
+  return result.ec == std::errc() && result.ptr == last;
+}
+
+bool parseFloat(std::string_view str, float &value) {
+  const char *last = str.data() + str.size();
+  auto result = std::from_chars(str.data(), last, value);
+  return result.ec == std::errc() && result.ptr == last;
+}
 } // namespace Utility
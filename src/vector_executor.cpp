@@ -0,0 +1,421 @@
+#include "vector_executor.h"
+#include "parameters.h"
+#include "status.h"
+#include "util.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iostream>
+
+void ColumnVector::clear() {
+  ints.clear();
+  floats.clear();
+  bytes.clear();
+  offsets.assign(1, 0);
+  nulls.clear();
+}
+
+void ColumnVector::append(const char* value, size_t size) {
+  switch (type) {
+    case ColumnInfo::INT: {
+      int intVal;
+      std::memcpy(&intVal, value, sizeof(int));
+      ints.push_back(intVal);
+      break;
+    }
+    case ColumnInfo::FLOAT: {
+      float floatVal;
+      std::memcpy(&floatVal, value, sizeof(float));
+      floats.push_back(floatVal);
+      break;
+    }
+    case ColumnInfo::VARCHAR:
+      bytes.append(value, size);
+      offsets.push_back(bytes.size());
+      break;
+  }
+  nulls.push_back(0);
+}
+
+void ColumnVector::appendNull() {
+  switch (type) {
+    case ColumnInfo::INT:
+      ints.push_back(0);
+      break;
+    case ColumnInfo::FLOAT:
+      floats.push_back(0);
+      break;
+    case ColumnInfo::VARCHAR:
+      offsets.push_back(bytes.size());
+      break;
+  }
+  nulls.push_back(1);
+}
+
+std::string_view ColumnVector::getString(size_t row) const {
+  return std::string_view(&bytes.data()[offsets[row]], offsets[row + 1] - offsets[row]);
+}
+
+std::string ColumnVector::toString(size_t row) const {
+  if (nulls[row]) {
+    return "NULL";
+  }
+  switch (type) {
+    case ColumnInfo::INT:
+      return std::to_string(ints[row]);
+    case ColumnInfo::FLOAT:
+      return std::to_string(floats[row]);
+    case ColumnInfo::VARCHAR:
+      return std::string(getString(row));
+  }
+  return "";
+}
+
+// Parses the literal of the condition to the type of the column
+static bool setValue(Predicate& predicate, const ColumnInfo& info, const Condition& condition) {
+  bool isValid = false;
+  switch (info.type) {
+    case ColumnInfo::INT:
+      isValid = !condition.isString && Utility::parseInt(condition.value, predicate.intValue);
+      break;
+    case ColumnInfo::FLOAT:
+      isValid = !condition.isString && Utility::parseFloat(condition.value, predicate.floatValue);
+      break;
+    case ColumnInfo::VARCHAR:
+      isValid = condition.isString;
+      predicate.stringValue = condition.value;
+      break;
+  }
+  if (!isValid) {
+    std::cerr << "[ERROR] Invalid value for type in condition on '" << condition.column << "'" << std::endl;
+  }
+  return isValid;
+}
+
+// Resolves the column names and parses the literals. A column read by both
+// the projection and a predicate is decoded once.
+Optional<SelectPlan> SelectPlan::create(const RecordLayout& layout, const SelectStmt& stmt) {
+  SelectPlan plan;
+  auto resolve = [&](const std::string& name) -> Optional<size_t> {
+    for (size_t column = 0; column < layout.getColumnCount(); column++) {
+      if (layout.getName(column) != name) {
+        continue;
+      }
+      auto position = std::find(plan.columns.begin(), plan.columns.end(), column);
+      if (position == plan.columns.end()) {
+        plan.columns.push_back(column);
+        return plan.columns.size() - 1;
+      }
+      return static_cast<size_t>(position - plan.columns.begin());
+    }
+    std::cerr << "[ERROR] Column '" << name << "' does not exist" << std::endl;
+    return Optional<size_t>(VerdantStatus::INVALID_SYNTAX);
+  };
+
+  if (stmt.columns.empty() && stmt.aggregates.empty()) {
+    for (size_t column = 0; column < layout.getColumnCount(); column++) {
+      plan.projection.push_back(resolve(layout.getName(column)).unwrap());
+    }
+  }
+  for (auto& name : stmt.columns) {
+    auto position = resolve(name);
+    if (!position.unwrappable()) {
+      return Optional<SelectPlan>(position.status);
+    }
+    plan.projection.push_back(position.unwrap());
+  }
+
+  for (auto& aggregate : stmt.aggregates) {
+    AggregatePlan aggregatePlan = { aggregate.function, AggregatePlan::NO_COLUMN };
+    if (!aggregate.column.empty()) {
+      auto position = resolve(aggregate.column);
+      if (!position.unwrappable()) {
+        return Optional<SelectPlan>(position.status);
+      }
+      aggregatePlan.column = position.unwrap();
+      if (aggregate.function == Aggregate::SUM &&
+          layout.getInfo(plan.columns[aggregatePlan.column]).type == ColumnInfo::VARCHAR) {
+        std::cerr << "[ERROR] Cannot sum the VARCHAR column '" << aggregate.column << "'" << std::endl;
+        return Optional<SelectPlan>(VerdantStatus::INVALID_TYPE);
+      }
+    }
+    plan.aggregates.push_back(aggregatePlan);
+  }
+
+  for (auto& condition : stmt.conditions) {
+    auto position = resolve(condition.column);
+    if (!position.unwrappable()) {
+      return Optional<SelectPlan>(position.status);
+    }
+    Predicate predicate = { position.unwrap(), condition.op, 0, 0, "" };
+    if (!setValue(predicate, layout.getInfo(plan.columns[predicate.column]), condition)) {
+      return Optional<SelectPlan>(VerdantStatus::INVALID_TYPE);
+    }
+    plan.predicates.push_back(std::move(predicate));
+  }
+  return plan;
+}
+
+// Predicate i comes from condition i
+bool SelectPlan::bind(const RecordLayout& layout, const std::vector<Condition>& conditions) {
+  for (size_t i = 0; i < predicates.size(); i++) {
+    if (!setValue(predicates[i], layout.getInfo(columns[predicates[i].column]), conditions[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string SelectPlan::getAggregateName(const RecordLayout& layout, size_t aggregate) const {
+  const AggregatePlan& aggregatePlan = aggregates[aggregate];
+  return std::string(aggregatePlan.function == Aggregate::COUNT ? "COUNT(" : "SUM(") +
+         (aggregatePlan.column == AggregatePlan::NO_COLUMN ? "*" : layout.getName(columns[aggregatePlan.column])) + ")";
+}
+
+// A SUM over no value is NULL
+std::string SelectPlan::formatAggregate(const RecordLayout& layout, size_t aggregate, const AggregateValue& value) const {
+  const AggregatePlan& aggregatePlan = aggregates[aggregate];
+  if (aggregatePlan.function == Aggregate::COUNT) {
+    return std::to_string(value.count);
+  }
+  if (value.count == 0) {
+    return "NULL";
+  }
+  return layout.getInfo(columns[aggregatePlan.column]).type == ColumnInfo::INT ? std::to_string(value.intSum)
+                                                                               : std::to_string(value.floatSum);
+}
+
+void AggregateValue::merge(const AggregateValue& value) {
+  count += value.count;
+  intSum += value.intSum;
+  floatSum += value.floatSum;
+}
+
+VectorExecutor::VectorExecutor(Table& table, const SelectPlan& plan)
+    : VectorExecutor(table, plan, table.scan()) {}
+
+VectorExecutor::VectorExecutor(Table& table, const SelectPlan& plan, std::unique_ptr<TableScanner> scanner)
+    : plan(plan), layout(table.getLayout()), pax(table.getPaxLayout()), scanner(std::move(scanner)),
+      page(nullptr), pageRow(0) {}
+
+// Row pages: each record is decoded for the columns of the plan only
+void VectorExecutor::fillRows(Batch& batch) {
+  while (batch.size < VECTOR_BATCH_SIZE) {
+    auto optionalRecord = scanner->next();
+    if (!optionalRecord.unwrappable()) {
+      return;
+    }
+    const char* record = optionalRecord.unwrap().first;
+    for (size_t i = 0; i < plan.columns.size(); i++) {
+      size_t column = plan.columns[i];
+      if (layout.isNull(record, column)) {
+        batch.columns[i].appendNull();
+      } else {
+        auto value = layout.getValue(record, column);
+        batch.columns[i].append(value.first, value.second);
+      }
+    }
+    batch.size++;
+  }
+}
+
+// PAX pages: INT and FLOAT minipages are copied as arrays, a block at a time
+void VectorExecutor::fillPages(Batch& batch) {
+  while (batch.size < VECTOR_BATCH_SIZE) {
+    if (page == nullptr || pageRow == PaxLayout::readRowCount(page)) {
+      auto optionalPage = scanner->nextPage();
+      if (!optionalPage.unwrappable()) {
+        page = nullptr;
+        return;
+      }
+      page = optionalPage.unwrap();
+      pageRow = 0;
+      continue;
+    }
+    size_t count = std::min(PaxLayout::readRowCount(page) - pageRow, VECTOR_BATCH_SIZE - batch.size);
+    for (size_t i = 0; i < plan.columns.size(); i++) {
+      size_t column = plan.columns[i];
+      ColumnVector& vector = batch.columns[i];
+      const char* values = pax->getColumn(page, column);
+      switch (vector.type) {
+        case ColumnInfo::INT:
+          vector.ints.resize(batch.size + count);
+          std::memcpy(&vector.ints[batch.size], &values[pageRow * sizeof(int)], count * sizeof(int));
+          break;
+        case ColumnInfo::FLOAT:
+          vector.floats.resize(batch.size + count);
+          std::memcpy(&vector.floats[batch.size], &values[pageRow * sizeof(float)], count * sizeof(float));
+          break;
+        case ColumnInfo::VARCHAR:
+          for (size_t row = pageRow; row < pageRow + count; row++) {
+            auto value = pax->getValue(page, row, column);
+            vector.bytes.append(value.first, value.second);
+            vector.offsets.push_back(vector.bytes.size());
+          }
+          break;
+      }
+      for (size_t row = pageRow; row < pageRow + count; row++) {
+        vector.nulls.push_back(pax->isNull(page, row, column));
+      }
+    }
+    batch.size += count;
+    pageRow += count;
+  }
+}
+
+// Keeps the selected rows whose value is not NULL and passes compare. The
+// selection is narrowed in place; while it still holds every row, rows are
+// indexed directly so the loop has no indirection.
+template <bool Dense, typename T, typename Compare>
+static size_t selectRows(const T* values, const uint8_t* nulls, uint32_t* selection, size_t count,
+                         const T& constant, Compare compare) {
+  size_t selected = 0;
+  for (size_t i = 0; i < count; i++) {
+    uint32_t row = Dense ? i : selection[i];
+    selection[selected] = row;
+    selected += !nulls[row] & compare(values[row], constant);
+  }
+  return selected;
+}
+
+template <bool Dense, typename T>
+static size_t selectRows(const T* values, const uint8_t* nulls, uint32_t* selection, size_t count,
+                         const T& constant, Condition::Operator op) {
+  switch (op) {
+    case Condition::EQUAL:
+      return selectRows<Dense>(values, nulls, selection, count, constant, std::equal_to<T>());
+    case Condition::NOT_EQUAL:
+      return selectRows<Dense>(values, nulls, selection, count, constant, std::not_equal_to<T>());
+    case Condition::LESS:
+      return selectRows<Dense>(values, nulls, selection, count, constant, std::less<T>());
+    case Condition::LESS_EQUAL:
+      return selectRows<Dense>(values, nulls, selection, count, constant, std::less_equal<T>());
+    case Condition::GREATER:
+      return selectRows<Dense>(values, nulls, selection, count, constant, std::greater<T>());
+    case Condition::GREATER_EQUAL:
+      return selectRows<Dense>(values, nulls, selection, count, constant, std::greater_equal<T>());
+  }
+  return 0;
+}
+
+template <typename T>
+static size_t selectRows(const T* values, const uint8_t* nulls, uint32_t* selection, size_t count,
+                         bool isDense, const T& constant, Condition::Operator op) {
+  return isDense ? selectRows<true>(values, nulls, selection, count, constant, op)
+                 : selectRows<false>(values, nulls, selection, count, constant, op);
+}
+
+void VectorExecutor::filter(Batch& batch) const {
+  batch.selection.resize(batch.size);
+  size_t selected = batch.size;
+  bool isDense = true;
+  std::vector<std::string_view> strings;
+  for (const Predicate& predicate : plan.predicates) {
+    const ColumnVector& vector = batch.columns[predicate.column];
+    uint32_t* selection = batch.selection.data();
+    switch (vector.type) {
+      case ColumnInfo::INT:
+        selected = selectRows(vector.ints.data(), vector.nulls.data(), selection, selected, isDense,
+                              predicate.intValue, predicate.op);
+        break;
+      case ColumnInfo::FLOAT:
+        selected = selectRows(vector.floats.data(), vector.nulls.data(), selection, selected, isDense,
+                              predicate.floatValue, predicate.op);
+        break;
+      case ColumnInfo::VARCHAR: {
+        strings.resize(batch.size);
+        for (size_t row = 0; row < batch.size; row++) {
+          strings[row] = vector.getString(row);
+        }
+        selected = selectRows(strings.data(), vector.nulls.data(), selection, selected, isDense,
+                              std::string_view(predicate.stringValue), predicate.op);
+        break;
+      }
+    }
+    isDense = false;
+  }
+  if (isDense) {
+    for (size_t row = 0; row < batch.size; row++) {
+      batch.selection[row] = row;
+    }
+  }
+  batch.selection.resize(selected);
+}
+
+template <typename T, typename Sum>
+static size_t sumRows(const T* values, const uint8_t* nulls, const std::vector<uint32_t>& selection, Sum& sum) {
+  size_t count = 0;
+  for (uint32_t row : selection) {
+    sum += nulls[row] ? 0 : values[row];
+    count += !nulls[row];
+  }
+  return count;
+}
+
+// NULLs are left out of COUNT(column) and SUM
+void VectorExecutor::aggregate(const Batch& batch, std::vector<AggregateValue>& values) const {
+  values.resize(plan.aggregates.size());
+  for (size_t i = 0; i < plan.aggregates.size(); i++) {
+    const AggregatePlan& aggregatePlan = plan.aggregates[i];
+    if (aggregatePlan.column == AggregatePlan::NO_COLUMN) {
+      values[i].count += batch.selection.size();
+      continue;
+    }
+    const ColumnVector& vector = batch.columns[aggregatePlan.column];
+    if (aggregatePlan.function == Aggregate::COUNT || vector.type == ColumnInfo::VARCHAR) {
+      for (uint32_t row : batch.selection) {
+        values[i].count += !vector.nulls[row];
+      }
+    } else if (vector.type == ColumnInfo::INT) {
+      values[i].count += sumRows(vector.ints.data(), vector.nulls.data(), batch.selection, values[i].intSum);
+    } else {
+      values[i].count += sumRows(vector.floats.data(), vector.nulls.data(), batch.selection, values[i].floatSum);
+    }
+  }
+}
+
+bool VectorExecutor::next(Batch& batch) {
+  batch.columns.resize(plan.columns.size());
+  for (size_t i = 0; i < plan.columns.size(); i++) {
+    batch.columns[i].type = layout.getInfo(plan.columns[i]).type;
+  }
+  while (true) {
+    batch.size = 0;
+    for (auto& vector : batch.columns) {
+      vector.clear();
+    }
+    if (pax != nullptr) {
+      fillPages(batch);
+    } else {
+      fillRows(batch);
+    }
+    if (batch.size == 0) {
+      return false;
+    }
+    filter(batch);
+    if (!batch.selection.empty()) {
+      return true;
+    }
+  }
+}
+
+size_t VectorExecutor::run(std::ostream& out) {
+  for (size_t i = 0; i < plan.projection.size(); i++) {
+    out << (i == 0 ? "" : " | ") << layout.getName(plan.columns[plan.projection[i]]);
+  }
+  out << std::endl;
+  size_t count = 0;
+  Batch batch;
+  while (next(batch)) {
+    for (uint32_t row : batch.selection) {
+      for (size_t i = 0; i < plan.projection.size(); i++) {
+        out << (i == 0 ? "" : " | ") << batch.columns[plan.projection[i]].toString(row);
+      }
+      out << '\n';
+    }
+    count += batch.selection.size();
+  }
+  out.flush();
+  return count;
+}
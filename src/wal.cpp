@@ -0,0 +1,307 @@
+#include "wal.h"
+#include "buffer_pool.h"
+#include "parameters.h"
+#include "util.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <map>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// recordSize | checksum | lsn | blockIndex | pathLength | path | rangeCount
+// followed by offset | length | bytes for every range. The checksum covers
+// everything after itself, so a record torn by a crash is detected on replay.
+static const size_t RECORD_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint64_t);
+
+template <typename T> static void put(std::string& buffer, T value) {
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T> static T get(const char* data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+static bool writeAll(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    ssize_t written = write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    size -= written;
+  }
+  return true;
+}
+
+static bool syncFile(const std::string& path) {
+  int fd = open(path.c_str(), O_RDWR);
+  if (fd < 0) {
+    // Nothing to sync if the file is gone
+    return errno == ENOENT;
+  }
+  bool result = fsync(fd) == 0;
+  close(fd);
+  return result;
+}
+
+WriteAheadLog::WriteAheadLog(const std::string& path, BufferPool* pool)
+    : path(path), pool(pool), nextLsn(1), durableLsn(0), flushing(false), failed(false), failureCount(0), logSize(0), syncCount(0) {
+  fd = open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+  if (fd < 0) {
+    std::cerr << "[ERROR] Cannot open the log at " << path << std::endl;
+    return;
+  }
+  struct stat sb;
+  if (fstat(fd, &sb) == 0) {
+    logSize = sb.st_size;
+  }
+  if (pool != nullptr) {
+    recover();
+    pool->setLog(this);
+  }
+}
+
+// Only makes the records durable; they are replayed on the next start
+WriteAheadLog::~WriteAheadLog() {
+  if (fd < 0) {
+    return;
+  }
+  flushAll();
+  if (pool != nullptr) {
+    pool->setLog(nullptr);
+  }
+  close(fd);
+}
+
+// Created after the buffer pool, so it is destroyed before the pool and can
+// detach itself from it
+WriteAheadLog& WriteAheadLog::getInstance() {
+  static WriteAheadLog instance(Utility::getDataPath() + WAL_FILE_NAME, &BufferPool::getInstance());
+  return instance;
+}
+
+bool WriteAheadLog::isOpen() const {
+  return fd >= 0;
+}
+
+// FNV-1a
+uint64_t WriteAheadLog::checksum(const char* data, size_t size) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// Copies the current bytes of every range of block into a new record and
+// returns its LSN. The record is durable only after a flush.
+uint64_t WriteAheadLog::append(const std::string& file, size_t blockIndex, const char* block,
+                               const std::vector<PageRange>& ranges) {
+  std::string record(RECORD_HEADER_SIZE, '\0');
+  std::lock_guard<std::mutex> lock(mutex);
+  uint64_t lsn = nextLsn++;
+  put<uint64_t>(record, lsn);
+  put<uint64_t>(record, blockIndex);
+  put<uint32_t>(record, file.size());
+  record.append(file);
+  put<uint32_t>(record, ranges.size());
+  for (auto& range : ranges) {
+    put<uint32_t>(record, range.first);
+    put<uint32_t>(record, range.second);
+    record.append(&block[range.first], range.second);
+  }
+  uint32_t recordSize = record.size();
+  uint64_t recordChecksum = checksum(&record[RECORD_HEADER_SIZE], record.size() - RECORD_HEADER_SIZE);
+  std::memcpy(&record[0], &recordSize, sizeof(uint32_t));
+  std::memcpy(&record[sizeof(uint32_t)], &recordChecksum, sizeof(uint64_t));
+  pending.append(record);
+  files.insert(file);
+  return lsn;
+}
+
+// Returns once every record up to lsn is durable. One caller at a time writes
+// out everything pending and syncs it; the others wait and usually find their
+// records covered by that sync. When a round fails, every caller waiting on it
+// fails too.
+bool WriteAheadLog::flush(uint64_t lsn) {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (durableLsn < lsn) {
+    if (failed) {
+      return false;
+    }
+    if (flushing) {
+      size_t failures = failureCount;
+      flushed.wait(lock);
+      if (failureCount != failures) {
+        return false;
+      }
+      continue;
+    }
+    flushing = true;
+    std::string batch;
+    batch.swap(pending);
+    uint64_t batchLsn = nextLsn - 1;
+    lock.unlock();
+    bool written = writeAll(fd, batch.data(), batch.size()) && fdatasync(fd) == 0;
+    int error = errno;
+    lock.lock();
+    flushing = false;
+    if (!written) {
+      std::cerr << "[ERROR] Cannot write the log at " << path << ": " << std::strerror(error) << std::endl;
+      // Cut off whatever part of the batch reached the file and put the batch
+      // back in front of the records appended since, so the next flush writes
+      // it again in order. If the log cannot be cut, a torn record would hide
+      // every later one from replay, so the log takes no more records.
+      if (ftruncate(fd, logSize) != 0) {
+        std::cerr << "[ERROR] Cannot truncate the log at " << path << std::endl;
+        failed = true;
+      }
+      pending.insert(0, batch);
+      failureCount++;
+      flushed.notify_all();
+      return false;
+    }
+    durableLsn = batchLsn;
+    logSize += batch.size();
+    syncCount++;
+    flushed.notify_all();
+  }
+  return true;
+}
+
+bool WriteAheadLog::flushAll() {
+  uint64_t lsn;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    lsn = nextLsn - 1;
+  }
+  return flush(lsn);
+}
+
+// Applies every intact record to its file, stopping at the first torn one,
+// then syncs the files and empties the log. Returns the number of records
+// applied. Must run before the files are opened.
+size_t WriteAheadLog::recover() {
+  std::string log(logSize, '\0');
+  ssize_t readSize = pread(fd, &log[0], logSize, 0);
+  if (readSize < 0) {
+    return 0;
+  }
+  log.resize(readSize);
+
+  std::map<std::string, int> targets;
+  size_t applied = 0;
+  size_t position = 0;
+  while (position + RECORD_HEADER_SIZE <= log.size()) {
+    const char* record = &log[position];
+    uint32_t recordSize = get<uint32_t>(record);
+    if (recordSize < RECORD_HEADER_SIZE || position + recordSize > log.size() ||
+        get<uint64_t>(&record[sizeof(uint32_t)]) != checksum(&record[RECORD_HEADER_SIZE], recordSize - RECORD_HEADER_SIZE)) {
+#ifdef VERDANT_FLAG_DEBUG
+      std::cout << "[DEBUG] Log ends with a torn record at " << position << std::endl;
+#endif
+      break;
+    }
+    const char* cursor = &record[RECORD_HEADER_SIZE + sizeof(uint64_t)];
+    uint64_t blockIndex = get<uint64_t>(cursor);
+    cursor += sizeof(uint64_t);
+    uint32_t pathLength = get<uint32_t>(cursor);
+    cursor += sizeof(uint32_t);
+    std::string file(cursor, pathLength);
+    cursor += pathLength;
+    uint32_t rangeCount = get<uint32_t>(cursor);
+    cursor += sizeof(uint32_t);
+
+    auto target = targets.find(file);
+    if (target == targets.end()) {
+      target = targets.emplace(file, open(file.c_str(), O_RDWR)).first;
+    }
+    for (uint32_t i = 0; i < rangeCount; i++) {
+      uint32_t offset = get<uint32_t>(cursor);
+      uint32_t length = get<uint32_t>(&cursor[sizeof(uint32_t)]);
+      cursor += 2 * sizeof(uint32_t);
+      // Changes to files removed since are dropped
+      if (target->second >= 0 && pwrite(target->second, cursor, length, blockIndex * BLOCK_SIZE + offset) != static_cast<ssize_t>(length)) {
+        std::cerr << "[ERROR] Cannot replay the log onto " << file << std::endl;
+      }
+      cursor += length;
+    }
+    applied++;
+    position += recordSize;
+  }
+
+  for (auto& target : targets) {
+    if (target.second < 0) {
+      continue;
+    }
+    // A record may be the first one written to a fresh block
+    struct stat sb;
+    if (fstat(target.second, &sb) == 0 && sb.st_size % BLOCK_SIZE != 0) {
+      if (ftruncate(target.second, (sb.st_size / BLOCK_SIZE + 1) * BLOCK_SIZE) != 0) {
+        std::cerr << "[ERROR] Cannot extend " << target.first << std::endl;
+      }
+    }
+    fsync(target.second);
+    close(target.second);
+  }
+#ifdef VERDANT_FLAG_DEBUG
+  if (applied > 0) {
+    std::cout << "[DEBUG] Replayed " << applied << " log records" << std::endl;
+  }
+#endif
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (ftruncate(fd, 0) != 0 || fsync(fd) != 0) {
+    std::cerr << "[ERROR] Cannot truncate the log at " << path << std::endl;
+  }
+  logSize = 0;
+  return applied;
+}
+
+// Writes back every dirty page, syncs the files changed since the last
+// checkpoint and empties the log. Must not run concurrently with writers.
+bool WriteAheadLog::checkpoint() {
+  if (!flushAll()) {
+    return false;
+  }
+  if (pool != nullptr && !pool->flushAll()) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto& file : files) {
+    if (!syncFile(file)) {
+      std::cerr << "[ERROR] Cannot sync " << file << std::endl;
+      return false;
+    }
+  }
+  if (ftruncate(fd, 0) != 0 || fsync(fd) != 0) {
+    std::cerr << "[ERROR] Cannot truncate the log at " << path << std::endl;
+    return false;
+  }
+  files.clear();
+  logSize = 0;
+#ifdef VERDANT_FLAG_DEBUG
+  std::cout << "[DEBUG] Log checkpoint at LSN " << durableLsn << std::endl;
+#endif
+  return true;
+}
+
+// Durable bytes in the log
+size_t WriteAheadLog::getSize() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return logSize;
+}
+
+size_t WriteAheadLog::getSyncCount() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return syncCount;
+}
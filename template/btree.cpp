@@ -10,6 +10,7 @@
 
 #include "optional.h"
 #include "parameters.h"
+#include "simd_search.h"
 #include "status.h"
 #include "btree.h"
 
@@ -18,14 +19,16 @@
 // M = (block_size - 2 * ptr_size - used_size) / (2 * (key + ptr_size))
 // M = (block_size - 3 * sizeof(size_t)) / (2 * (key + ptr_size))
 
-template <typename T> BTree<T>::BTree() {
+template <typename T> BTree<T>::BTree() : BTree(std::unique_ptr<BTreeNodeAllocator<T>>(new BTreeNodeArena<T>())) {}
+
+template <typename T> BTree<T>::BTree(std::unique_ptr<BTreeNodeAllocator<T>> allocator) {
 #ifdef VERDANT_FLAG_DEBUG
   std::cout << "[DEBUG] Size of pointer: " << sizeof(size_t) << std::endl;
   std::cout << "[DEBUG] Size of block: " << BLOCK_SIZE << std::endl;
 #endif
-  assert(BLOCK_SIZE > 2 * sizeof(size_t));
-  this->order = std::floor((BLOCK_SIZE - 3 * sizeof(size_t)) / (2 * (sizeof(T) + sizeof(size_t))));
-  assert(this->order > 0);
+  static_assert(BLOCK_SIZE > 2 * sizeof(size_t), "Block too small for a BTree node");
+  static_assert(BTreeNode<T>::order > 0, "Key too large for a BTree node");
+  this->allocator = std::move(allocator);
 #ifdef VERDANT_FLAG_DEBUG
   std::cout << "[DEBUG] B-Tree order: " << this->order << std::endl;
 #endif
@@ -43,9 +46,9 @@ template <typename T> BTree<T>::~BTree() {
 
 template <typename T> bool BTree<T>::insert(T value) {
   if (this->root == nullptr) {
-    this->root = std::unique_ptr<BTreeNode<T>>(new BTreeNode<T>(this->order));
+    this->root = BTreeNode<T>::create(this->allocator.get(), true);
   }
-  std::pair<Optional<T>, std::unique_ptr<BTreeNode<T>>> result = this->root->insert(value);
+  std::pair<Optional<T>, BTreeNodePtr<T>> result = this->root->insert(value);
   if (!result.first.unwrappable()) { // Nothing to add
     return true;
   }
@@ -53,25 +56,115 @@ template <typename T> bool BTree<T>::insert(T value) {
   std::cout << "[DEBUG] BTree: Starting root replacement." << std::endl;
 #endif
   T newValue = result.first.unwrap();
-  std::unique_ptr<BTreeNode<T>> newNode = std::move(result.second);
-  std::unique_ptr<BTreeNode<T>> newRoot(new BTreeNode<T>(order, nullptr));
+  BTreeNodePtr<T> newNode = std::move(result.second);
+  BTreeNodePtr<T> newRoot = BTreeNode<T>::create(this->allocator.get(), false);
   this->root->parent = newRoot.get();
   newNode->parent = newRoot.get();
-  newRoot->children.push_back(std::move(this->root));
-  newRoot->children.push_back(std::move(newNode));
+  newRoot->getChildren().push_back(std::move(this->root));
+  newRoot->getChildren().push_back(std::move(newNode));
   newRoot->values.push_back(newValue);
   this->root = std::move(newRoot);
 #ifdef VERDANT_FLAG_DEBUG
-  assert(this->root->children[0]->values[this->root->children[0]->values.size() - 1] < newValue);
-  assert(newValue <= this->root->children[1]->values[0]);
+  assert(this->root->getChildren()[0]->values[this->root->getChildren()[0]->values.size() - 1] < newValue);
+  assert(newValue <= this->root->getChildren()[1]->values[0]);
   std::cout << "[DEBUG] Current root ID: " << this->root->index << std::endl;
-  std::cout << "[DEBUG] Old root ID: " << this->root->children[0]->index << std::endl;
-  std::cout << "[DEBUG] New node ID: " << this->root->children[1]->index << std::endl;
+  std::cout << "[DEBUG] Old root ID: " << this->root->getChildren()[0]->index << std::endl;
+  std::cout << "[DEBUG] New node ID: " << this->root->getChildren()[1]->index << std::endl;
   std::cout << "[DEBUG] BTree: Finished root replacement." << std::endl;
 #endif
   return true;
 }
 
+// Splits count entries into groups of about target entries, each holding
+// between minSize and maxSize entries. A count that fits into a single group
+// becomes the root and is exempt from the lower bound.
+template <typename T> std::vector<size_t> BTree<T>::splitEvenly(size_t count, size_t target, size_t minSize, size_t maxSize) {
+  if (count <= maxSize) {
+    return { count };
+  }
+  size_t groupCount = (count + target - 1) / target;
+  if (count / groupCount < minSize) {
+    groupCount = count / minSize;
+  }
+  std::vector<size_t> sizes(groupCount, count / groupCount);
+  for (size_t i = 0; i < count % groupCount; i++) {
+    sizes[i]++;
+  }
+  return sizes;
+}
+
+template <typename T> template <typename Iterator> bool BTree<T>::bulkLoad(Iterator first, Iterator last, double fillFactor) {
+  if (fillFactor <= 0 || fillFactor > 1) {
+    return false;
+  }
+  std::vector<T> sorted;
+  for (; first != last; ++first) {
+    if (!sorted.empty() && *first < sorted[sorted.size() - 1]) {
+      return false;
+    }
+    // Same as insert, a repeated value replaces the previous one
+    if (!sorted.empty() && *first == sorted[sorted.size() - 1]) {
+      sorted[sorted.size() - 1] = *first;
+      continue;
+    }
+    sorted.push_back(*first);
+  }
+  if (sorted.size() == 0) {
+    this->root = nullptr;
+    return true;
+  }
+
+  size_t target = std::min(std::max((size_t)std::round(2 * this->order * fillFactor), this->order), 2 * this->order);
+
+  // Leaf level, chained through next
+  std::vector<BTreeNodePtr<T>> level;
+  std::vector<T> minValues;
+  BTreeNode<T>* prevLeaf = nullptr;
+  size_t offset = 0;
+  for (size_t size : splitEvenly(sorted.size(), target, this->order, 2 * this->order)) {
+    BTreeNodePtr<T> leaf = BTreeNode<T>::create(this->allocator.get(), true);
+    leaf->values.assign(sorted.begin() + offset, sorted.begin() + offset + size);
+    if (prevLeaf != nullptr) {
+      prevLeaf->setNext(leaf.get());
+    }
+    prevLeaf = leaf.get();
+    minValues.push_back(sorted[offset]);
+    level.push_back(std::move(leaf));
+    offset += size;
+  }
+#ifdef VERDANT_FLAG_DEBUG
+  std::cout << "[DEBUG] BTree: Bulk loaded " << sorted.size() << " values into " << level.size() << " leaves" << std::endl;
+#endif
+  sorted = std::vector<T>();
+
+  // Internal levels. The separator before each child is the smallest value of
+  // its subtree
+  while (level.size() > 1) {
+    std::vector<BTreeNodePtr<T>> parentLevel;
+    std::vector<T> parentMinValues;
+    offset = 0;
+    for (size_t size : splitEvenly(level.size(), target + 1, this->order + 1, 2 * this->order + 1)) {
+      BTreeNodePtr<T> node = BTreeNode<T>::create(this->allocator.get(), false);
+      for (size_t i = offset; i < offset + size; i++) {
+        if (i != offset) {
+          node->values.push_back(minValues[i]);
+        }
+        level[i]->parent = node.get();
+        node->getChildren().push_back(std::move(level[i]));
+      }
+      parentMinValues.push_back(minValues[offset]);
+      parentLevel.push_back(std::move(node));
+      offset += size;
+    }
+    level = std::move(parentLevel);
+    minValues = std::move(parentMinValues);
+  }
+
+  this->root = std::move(level[0]);
+  this->root->parent = nullptr;
+  return true;
+}
+
 template <typename T> Optional<T> BTree<T>::remove(const T& value) {
   if (this->root == nullptr) {
     return Optional<T>();
@@ -89,7 +182,7 @@ template <typename T> Optional<T> BTree<T>::remove(const T& value) {
     if (this->root->isLeaf()) {
       this->root = nullptr;
     } else {
-      this->root = std::move(this->root->children[0]);
+      this->root = std::move(this->root->getChildren()[0]);
       this->root->parent = nullptr;
     }
   }
@@ -110,6 +203,47 @@ template <typename T>  Optional<std::vector<T>> BTree<T>::searchRange(const T& m
   return this->root->searchRange(minVal, maxVal);
 }
 
+template <typename T> typename BTree<T>::Cursor BTree<T>::begin() {
+  if (this->root == nullptr) {
+    return this->end();
+  }
+  BTreeNode<T>* node = this->root.get();
+  while (!node->isLeaf()) {
+    node = node->getChildren()[0].get();
+  }
+  Cursor cursor(node, 0);
+  cursor.skipExhaustedLeaf();
+  return cursor;
+}
+
+template <typename T> typename BTree<T>::Cursor BTree<T>::end() {
+  return Cursor(nullptr, 0);
+}
+
+template <typename T> typename BTree<T>::Cursor BTree<T>::lowerBound(const T& value) {
+  if (this->root == nullptr) {
+    return this->end();
+  }
+  BTreeNode<T>* leaf = this->root->findLeaf(value);
+  Cursor cursor(leaf, leaf->insertIndexSearch(value));
+  cursor.skipExhaustedLeaf();
+  return cursor;
+}
+
+template <typename T> typename BTree<T>::Cursor BTree<T>::upperBound(const T& value) {
+  if (this->root == nullptr) {
+    return this->end();
+  }
+  BTreeNode<T>* leaf = this->root->findLeaf(value);
+  size_t index = leaf->insertIndexSearch(value);
+  if (index < leaf->values.size() && leaf->values[index] == value) {
+    index++;
+  }
+  Cursor cursor(leaf, index);
+  cursor.skipExhaustedLeaf();
+  return cursor;
+}
+
 template <typename T> bool BTree<T>::validate() {
 #ifdef VERDANT_FLAG_DEBUG
   std::cout << "[DEBUG] BTree Validation process started" << std::endl;
@@ -159,6 +293,50 @@ template <typename T> double BTree<T>::getAverageKeyPerNode() {
 }
 
 
+// NOTE: Cursor section
+
+template <typename T> BTree<T>::Cursor::Cursor(BTreeNode<T>* node, size_t index) {
+  this->node = node;
+  this->index = index;
+}
+
+// Moves past the end of the current leaf onto the next non-empty one, or to
+// the end position after the last leaf
+template <typename T> void BTree<T>::Cursor::skipExhaustedLeaf() {
+  while (this->node != nullptr && this->index >= this->node->values.size()) {
+    this->node = this->node->getNext();
+    this->index = 0;
+  }
+}
+
+template <typename T> bool BTree<T>::Cursor::valid() const {
+  return this->node != nullptr;
+}
+
+template <typename T> const T& BTree<T>::Cursor::operator*() const {
+  assert(this->valid());
+  return this->node->values[this->index];
+}
+
+template <typename T> const T* BTree<T>::Cursor::operator->() const {
+  return &**this;
+}
+
+template <typename T> typename BTree<T>::Cursor& BTree<T>::Cursor::operator++() {
+  assert(this->valid());
+  this->index++;
+  this->skipExhaustedLeaf();
+  return *this;
+}
+
+template <typename T> bool BTree<T>::Cursor::operator==(const Cursor& other) const {
+  return this->node == other.node && this->index == other.index;
+}
+
+template <typename T> bool BTree<T>::Cursor::operator!=(const Cursor& other) const {
+  return !(*this == other);
+}
+
 // NOTE: BTreeNode section
 
 #ifdef VERDANT_FLAG_DEBUG
@@ -166,23 +344,59 @@ template <typename T> size_t BTreeNode<T>::nextIndex = 0;
 #endif
 
 // B-Tree Node Anatomy
-// ptr -- key -- ptr -- key -- ... -- key -- ptr -- next_block_ptr
-// 2M + 1 ptr, 2M key, 1 next_block_ptr
-// -> 2M + 2 ptr, 2M key
+// header -- key -- key -- ... -- key, followed by
+// leaf: next_block_ptr
+// internal: ptr -- ptr -- ... -- ptr
+// 2M key, 2M + 1 ptr on internal nodes, 1 next_block_ptr on leaves
 
-template <typename T> BTreeNode<T>::BTreeNode(size_t order, BTreeNode<T>* parent) {
-  this->order = order;
-  this->next = nullptr;
+template <typename T> BTreeNode<T>::BTreeNode(BTreeNodeAllocator<T>* allocator, bool leaf, BTreeNode<T>* parent) : leaf(leaf) {
+  this->allocator = allocator;
   this->parent = parent;
 #ifdef VERDANT_FLAG_DEBUG
   this->index = BTreeNode<T>::nextIndex;
   BTreeNode<T>::nextIndex++;
 #endif
-  this->children.reserve(2 * this->order + 1);
-  this->values.reserve(2 * this->order);
+}
+
+template <typename T> BTreeLeafNode<T>::BTreeLeafNode(BTreeNodeAllocator<T>* allocator, BTreeNode<T>* parent) : BTreeNode<T>(allocator, true, parent) {
+  this->next = nullptr;
+}
+
+template <typename T> BTreeInternalNode<T>::BTreeInternalNode(BTreeNodeAllocator<T>* allocator, BTreeNode<T>* parent) : BTreeNode<T>(allocator, false, parent) {}
+
+template <typename T> BTreeNodePtr<T> BTreeNode<T>::create(BTreeNodeAllocator<T>* allocator, bool leaf, BTreeNode<T>* parent) {
+  static_assert(sizeof(BTreeNodePtr<T>) == sizeof(BTreeNode<T>*), "Child pointers must stay plain pointers");
+  if (leaf) {
+    return BTreeNodePtr<T>(new (allocator->allocate(sizeof(BTreeLeafNode<T>))) BTreeLeafNode<T>(allocator, parent));
+  }
+  return BTreeNodePtr<T>(new (allocator->allocate(sizeof(BTreeInternalNode<T>))) BTreeInternalNode<T>(allocator, parent));
+}
+
+template <typename T> InlineVector<BTreeNodePtr<T>, 2 * BTreeNode<T>::order + 1>& BTreeNode<T>::getChildren() {
+#ifdef VERDANT_FLAG_DEBUG
+  assert(!this->leaf);
+#endif
+  return static_cast<BTreeInternalNode<T>*>(this)->children;
+}
+
+template <typename T> BTreeNode<T>* BTreeNode<T>::getNext() {
+#ifdef VERDANT_FLAG_DEBUG
+  assert(this->leaf);
+#endif
+  return static_cast<BTreeLeafNode<T>*>(this)->next;
+}
+
+template <typename T> void BTreeNode<T>::setNext(BTreeNode<T>* next) {
+#ifdef VERDANT_FLAG_DEBUG
+  assert(this->leaf);
+#endif
+  static_cast<BTreeLeafNode<T>*>(this)->next = next;
 }
 
 template <typename T> size_t BTreeNode<T>::insertIndexSearch(const T& value) {
+  if constexpr (SimdSearchable<T>::value) {
+    return simdLowerBound(this->values.data(), this->values.size(), value);
+  }
   // Find the location to insert the value
   // Empty node
   if (this->values.size() == 0) {
@@ -221,7 +435,7 @@ template <typename T> size_t BTreeNode<T>::insertIndexSearch(const T& value) {
 }
 
 template <typename T> bool BTreeNode<T>::isLeaf() {
-  return this->children.size() == 0;
+  return this->leaf;
 }
 
 template <typename T> bool BTreeNode<T>::isRoot() {
@@ -244,8 +458,8 @@ template <typename T> bool BTreeNode<T>::isLeast() {
 }
 
 template <typename T> size_t BTreeNode<T>::findChildIndex(BTreeNode<T>* child) {
-  for (size_t i = 0; i < this->children.size(); i++) {
-    if (this->children[i].get() == child) {
+  for (size_t i = 0; i < this->getChildren().size(); i++) {
+    if (this->getChildren()[i].get() == child) {
       return i;
     }
   }
@@ -260,9 +474,9 @@ template <typename T> Optional<BTreeNode<T>*> BTreeNode<T>::getPrevChild(BTreeNo
 #ifdef VERDANT_FLAG_DEBUG
   assert(curChild->parent == this);
 #endif
-  for (auto childItr = this->children.begin(); childItr != this->children.end(); childItr++) {
+  for (auto childItr = this->getChildren().begin(); childItr != this->getChildren().end(); childItr++) {
     if ((*childItr).get() == curChild) {
-      return childItr != this->children.begin() ? Optional<BTreeNode<T>*>((childItr - 1)->get()) : Optional<BTreeNode<T>*>();
+      return childItr != this->getChildren().begin() ? Optional<BTreeNode<T>*>((childItr - 1)->get()) : Optional<BTreeNode<T>*>();
     }
   }
   std::cout << "[ERROR] Internal Error occurred" << std::endl;
@@ -277,9 +491,9 @@ template <typename T> Optional<BTreeNode<T>*> BTreeNode<T>::getNextChild(BTreeNo
 #ifdef VERDANT_FLAG_DEBUG
   assert(curChild->parent == this);
 #endif
-  for (auto childItr = this->children.begin(); childItr != this->children.end(); childItr++) {
+  for (auto childItr = this->getChildren().begin(); childItr != this->getChildren().end(); childItr++) {
     if ((*childItr).get() == curChild) {
-      return childItr != this->children.end() - 1 ? Optional<BTreeNode<T>*>((childItr + 1)->get()) : Optional<BTreeNode<T>*>();
+      return childItr != this->getChildren().end() - 1 ? Optional<BTreeNode<T>*>((childItr + 1)->get()) : Optional<BTreeNode<T>*>();
     }
   }
   std::cout << "[ERROR] Internal Error occurred" << std::endl;
@@ -294,12 +508,12 @@ template <typename T> Optional<BTreeNode<T>*> BTreeNode<T>::getNextChild(BTreeNo
 // Add 2 -> insertIndex = 1
 // | 1 | 3 |
 
-template <typename T> std::pair<Optional<T>, std::unique_ptr<BTreeNode<T>>> BTreeNode<T>::insert(T value) {
+template <typename T> std::pair<Optional<T>, BTreeNodePtr<T>> BTreeNode<T>::insert(T value) {
   size_t insertIndex = this->insertIndexSearch(value);
-  std::unique_ptr<BTreeNode<T>> ptr = nullptr;
+  BTreeNodePtr<T> ptr = nullptr;
   if (!this->isLeaf()) {
-    BTreeNode<T>* recursiveChild = this->children[(insertIndex < this->values.size() && this->values[insertIndex] == value) ? insertIndex + 1 : insertIndex].get();
-    std::pair<Optional<T>, std::unique_ptr<BTreeNode<T>>> recursiveResult = recursiveChild->insert(value);
+    BTreeNode<T>* recursiveChild = this->getChildren()[(insertIndex < this->values.size() && this->values[insertIndex] == value) ? insertIndex + 1 : insertIndex].get();
+    std::pair<Optional<T>, BTreeNodePtr<T>> recursiveResult = recursiveChild->insert(value);
     if (!recursiveResult.first.unwrappable()) { // Nothing to add/execute. Return
       return recursiveResult;
     }
@@ -318,7 +532,7 @@ template <typename T> std::pair<Optional<T>, std::unique_ptr<BTreeNode<T>>> BTre
       assert(this->values.size() < 2 * this->order);
       this->values.insert(this->values.begin() + insertIndex, value);
       if (ptr != nullptr) {
-        this->children.insert(this->children.begin() + insertIndex + 1, std::move(ptr));
+        this->getChildren().insert(this->getChildren().begin() + insertIndex + 1, std::move(ptr));
       }
     }
     return { Optional<T>(), nullptr };
@@ -335,19 +549,19 @@ template <typename T> std::pair<Optional<T>, std::unique_ptr<BTreeNode<T>>> BTre
         auto prevSibling = optionalPrevSibling.unwrap();
         size_t middleIndex = this->parent->findChildIndex(this) - 1;
         prevSibling->values.push_back(this->parent->values[middleIndex]);
-        this->children[0]->parent = prevSibling;
-        prevSibling->children.push_back(std::move(this->children[0]));
-        this->children.erase(this->children.begin());
+        this->getChildren()[0]->parent = prevSibling;
+        prevSibling->getChildren().push_back(std::move(this->getChildren()[0]));
+        this->getChildren().erase(this->getChildren().begin());
         if (insertIndex == 0) {
           this->parent->values[middleIndex] = value;
           ptr->parent = this;
-          this->children.insert(this->children.begin(), std::move(ptr));
+          this->getChildren().insert(this->getChildren().begin(), std::move(ptr));
         } else {
           this->parent->values[middleIndex] = this->values[0];
           this->values.erase(this->values.begin());
           this->values.insert(this->values.begin() + insertIndex - 1, value);
           ptr->parent = this;
-          this->children.insert(this->children.begin() + insertIndex, std::move(ptr));
+          this->getChildren().insert(this->getChildren().begin() + insertIndex, std::move(ptr));
         }
         return std::make_pair(Optional<T>(), nullptr);
       }
@@ -364,16 +578,16 @@ template <typename T> std::pair<Optional<T>, std::unique_ptr<BTreeNode<T>>> BTre
         if (insertIndex == this->values.size()) {
           this->parent->values[middleIndex] = value;
           ptr->parent = nextSibling;
-          nextSibling->children.insert(nextSibling->children.begin(), std::move(ptr));
+          nextSibling->getChildren().insert(nextSibling->getChildren().begin(), std::move(ptr));
         } else {
           this->parent->values[middleIndex] = this->values[this->values.size() - 1];
           this->values.pop_back();
           this->values.insert(this->values.begin() + insertIndex, value);
-          this->children[this->children.size() - 1]->parent = nextSibling;
-          nextSibling->children.insert(nextSibling->children.begin(), std::move(this->children[this->children.size() - 1]));
-          this->children.pop_back();
+          this->getChildren()[this->getChildren().size() - 1]->parent = nextSibling;
+          nextSibling->getChildren().insert(nextSibling->getChildren().begin(), std::move(this->getChildren()[this->getChildren().size() - 1]));
+          this->getChildren().pop_back();
           ptr->parent = this;
-          this->children.insert(this->children.begin() + insertIndex + 1, std::move(ptr));
+          this->getChildren().insert(this->getChildren().begin() + insertIndex + 1, std::move(ptr));
         }
     
         return std::make_pair(Optional<T>(), nullptr);
@@ -425,10 +639,11 @@ template <typename T> std::pair<Optional<T>, std::unique_ptr<BTreeNode<T>>> BTre
   s.insert(value);
   assert(s.size() == this->values.size() + 1);
 #endif
-  std::unique_ptr<BTreeNode<T>> newNode(new BTreeNode<T>(this->order, this->parent));
-  auto oldNext = this->next;
-  this->next = newNode.get();
-  newNode->next = oldNext;
+  BTreeNodePtr<T> newNode = BTreeNode<T>::create(this->allocator, this->isLeaf(), this->parent);
+  if (this->isLeaf()) {
+    newNode->setNext(this->getNext());
+    this->setNext(newNode.get());
+  }
 
   // Add value
   T median;
@@ -469,7 +684,7 @@ template <typename T> std::pair<Optional<T>, std::unique_ptr<BTreeNode<T>>> BTre
         std::cout << "[DEBUG] New child pointer added to the new node" << std::endl; 
 #endif
         ptr->parent = newNode.get();
-        newNode->children.push_back(std::move(ptr));
+        newNode->getChildren().push_back(std::move(ptr));
       }
       valueAdded = true;
     } 
@@ -477,8 +692,8 @@ template <typename T> std::pair<Optional<T>, std::unique_ptr<BTreeNode<T>>> BTre
     // Onward: values[i] >= median
     if (!this->isLeaf()) {
       // if values[i] == median -> not add value, and only add the right child
-      this->children[i + 1]->parent = newNode.get();
-      newNode->children.push_back(std::move(this->children[i + 1]));
+      this->getChildren()[i + 1]->parent = newNode.get();
+      newNode->getChildren().push_back(std::move(this->getChildren()[i + 1]));
       childrenMoved++;
     }
 
@@ -501,22 +716,22 @@ template <typename T> std::pair<Optional<T>, std::unique_ptr<BTreeNode<T>>> BTre
       std::cout << "[DEBUG] New child pointer added to the new node" << std::endl; 
 #endif
       ptr->parent = newNode.get();
-      newNode->children.push_back(std::move(ptr));
+      newNode->getChildren().push_back(std::move(ptr));
     }
     valueAdded = true;
   }
 
   this->values.resize(this->values.size() - valuesMoved);
 #ifdef VERDANT_FLAG_DEBUG
-  size_t numChildrenOld = this->children.size();
+  size_t numChildrenOld = this->isLeaf() ? 0 : this->getChildren().size();
 #endif
   if (!this->isLeaf()) {
-    this->children.resize(this->children.size() - childrenMoved);
+    this->getChildren().resize(this->getChildren().size() - childrenMoved);
   }
 #ifdef VERDANT_FLAG_DEBUG
   if (!this->isLeaf()) {
-    assert(childrenMoved == newNode->children.size() - (valueAdded ? 1 : 0));
-    assert(this->children.size() + newNode->children.size() + (valueAdded ? -1 : 0) == numChildrenOld);
+    assert(childrenMoved == newNode->getChildren().size() - (valueAdded ? 1 : 0));
+    assert(this->getChildren().size() + newNode->getChildren().size() + (valueAdded ? -1 : 0) == numChildrenOld);
   }
 #endif
   if (!valueAdded) {
@@ -525,7 +740,7 @@ template <typename T> std::pair<Optional<T>, std::unique_ptr<BTreeNode<T>>> BTre
     valueAdded = true;
     if (!this->isLeaf()) {
       ptr->parent = this;
-      this->children.insert(this->children.begin() + insertIndex + 1, std::move(ptr));
+      this->getChildren().insert(this->getChildren().begin() + insertIndex + 1, std::move(ptr));
     }
   }
   if (!this->isLeaf() && this->values[this->values.size() - 1] == median) {
@@ -622,7 +837,7 @@ template <typename T> std::pair<Optional<T>, Optional<size_t>> BTreeNode<T>::rem
 template <typename T> std::pair<Optional<T>, Optional<size_t>> BTreeNode<T>::removeOnInternal(const T& value) {
   size_t insertIndex = this->insertIndexSearch(value);
   size_t childIndex = insertIndex + (insertIndex < this->values.size() && this->values[insertIndex] == value ? 1 : 0);
-  auto recursiveResult = this->children[childIndex]->remove(value);
+  auto recursiveResult = this->getChildren()[childIndex]->remove(value);
   auto result = std::move(recursiveResult.first);
   auto optionalRemovedIndex = std::move(recursiveResult.second);
   if (!optionalRemovedIndex.unwrappable()) {
@@ -632,7 +847,7 @@ template <typename T> std::pair<Optional<T>, Optional<size_t>> BTreeNode<T>::rem
   size_t removedIndex = optionalRemovedIndex.unwrap();
 
   this->values.erase(this->values.begin() + removedIndex);
-  this->children.erase(this->children.begin() + removedIndex + 1);
+  this->getChildren().erase(this->getChildren().begin() + removedIndex + 1);
 
   if (this->isRoot() || this->values.size() >= this->order) {
     return std::make_pair(std::move(result), Optional<size_t>());
@@ -651,9 +866,9 @@ template <typename T> std::pair<Optional<T>, Optional<size_t>> BTreeNode<T>::rem
     this->values.insert(this->values.begin(), this->parent->values[middleIndex]);
     this->parent->values[middleIndex] = prevSibling->values[prevSibling->values.size() - 1];
     prevSibling->values.pop_back();
-    this->children.insert(this->children.begin(), std::move(prevSibling->children[prevSibling->children.size() - 1]));
-    this->children[0]->parent = this;
-    prevSibling->children.pop_back();
+    this->getChildren().insert(this->getChildren().begin(), std::move(prevSibling->getChildren()[prevSibling->getChildren().size() - 1]));
+    this->getChildren()[0]->parent = this;
+    prevSibling->getChildren().pop_back();
     return std::make_pair(std::move(result), Optional<size_t>());
   }
   if (optionalNextSibling.unwrappable() && !optionalNextSibling.unwrap()->isLeast()) {
@@ -662,9 +877,9 @@ template <typename T> std::pair<Optional<T>, Optional<size_t>> BTreeNode<T>::rem
     this->values.push_back(this->parent->values[middleIndex]);
     this->parent->values[middleIndex] = nextSibling->values[0];
     nextSibling->values.erase(nextSibling->values.begin());
-    this->children.push_back(std::move(nextSibling->children[0]));
-    this->children[this->children.size() - 1]->parent = this;
-    nextSibling->children.erase(nextSibling->children.begin());
+    this->getChildren().push_back(std::move(nextSibling->getChildren()[0]));
+    this->getChildren()[this->getChildren().size() - 1]->parent = this;
+    nextSibling->getChildren().erase(nextSibling->getChildren().begin());
     return std::make_pair(std::move(result), Optional<size_t>());
   }
 
@@ -690,11 +905,11 @@ template <typename T> std::pair<Optional<T>, Optional<size_t>> BTreeNode<T>::rem
 }
 
 template <typename T> void BTreeNode<T>::mergeLeafNodes(BTreeNode<T>* first, BTreeNode<T>* second) {
-  assert(first->next == second);
+  assert(first->getNext() == second);
   for (auto value: second->values) {
     first->values.push_back(value);
   }
-  first->next = second->next;
+  first->setNext(second->getNext());
 }
 
 template <typename T> void BTreeNode<T>::mergeInternalNodes(BTreeNode<T>* first, const T middleValue, BTreeNode<T>* second) {
@@ -702,9 +917,9 @@ template <typename T> void BTreeNode<T>::mergeInternalNodes(BTreeNode<T>* first,
   for (auto value: second->values) {
     first->values.push_back(value);
   }
-  for (size_t i = 0; i < second->children.size(); i++) {
-    second->children[i]->parent = first;
-    first->children.push_back(std::move(second->children[i]));
+  for (size_t i = 0; i < second->getChildren().size(); i++) {
+    second->getChildren()[i]->parent = first;
+    first->getChildren().push_back(std::move(second->getChildren()[i]));
   }
 }
 
@@ -719,7 +934,7 @@ template <typename T> Optional<T> BTreeNode<T>::search(const T& value) {
     if (this->isLeaf()) {
       return this->values[insertIndex];
     }
-    return this->children[insertIndex + 1]->search(value);
+    return this->getChildren()[insertIndex + 1]->search(value);
   } else {
     if (this->isLeaf()) {
       return Optional<T>();
@@ -729,8 +944,22 @@ template <typename T> Optional<T> BTreeNode<T>::search(const T& value) {
     assert(insertIndex == 0 || this->values[insertIndex - 1] < value);
 #endif
 
-    return this->children[insertIndex]->search(value);
+    return this->getChildren()[insertIndex]->search(value);
+  }
+}
+
+// Leaf whose range covers the value. Keys equal to a separator live in the
+// right subtree
+template <typename T> BTreeNode<T>* BTreeNode<T>::findLeaf(const T& value) {
+  BTreeNode<T>* node = this;
+  while (!node->isLeaf()) {
+    size_t insertIndex = node->insertIndexSearch(value);
+    if (insertIndex != node->values.size() && node->values[insertIndex] == value) {
+      insertIndex++;
+    }
+    node = node->getChildren()[insertIndex].get();
   }
+  return node;
 }
 
 template <typename T>  Optional<std::vector<T>> BTreeNode<T>::searchRange(const T& minVal, const T& maxVal) {
@@ -742,7 +971,7 @@ template <typename T>  Optional<std::vector<T>> BTreeNode<T>::searchRange(const
     while (curNode != nullptr) {
       if (curIndex == curNode->values.size()) {
         curIndex = 0;
-        curNode = curNode->next;
+        curNode = curNode->getNext();
         continue;
       }
       if (curNode->values[curIndex] > maxVal) {
@@ -754,9 +983,9 @@ template <typename T>  Optional<std::vector<T>> BTreeNode<T>::searchRange(const
     return rangeResult;
   }
   if (insertIndex != this->values.size() && this->values[insertIndex] == minVal) {
-    return this->children[insertIndex + 1]->searchRange(minVal, maxVal);
+    return this->getChildren()[insertIndex + 1]->searchRange(minVal, maxVal);
   } else {
-    return this->children[insertIndex]->searchRange(minVal, maxVal);
+    return this->getChildren()[insertIndex]->searchRange(minVal, maxVal);
   }
 }
 
@@ -825,10 +1054,10 @@ template <typename T> std::pair<bool, size_t> BTreeNode<T>::validate(bool root,
   }
 
   // NOTE: Rule 3: All non-leaf node have at least 2 children
-  if (!this->isLeaf() && this->children.size() < 2) {
+  if (!this->isLeaf() && this->getChildren().size() < 2) {
 #ifdef VERDANT_FLAG_DEBUG
     std::cout << "[ERROR] Non-leaf node has less than 2 children" << std::endl;
-    std::cout << "[DEBUG] Number of children: " << this->children.size() << std::endl;
+    std::cout << "[DEBUG] Number of children: " << this->getChildren().size() << std::endl;
     std::cout << "[DEBUG] Node ID: " << this->index << std::endl;
     if (this->isRoot()) {
       std::cout << "[DEBUG] Node is root" << std::endl;
@@ -838,17 +1067,17 @@ template <typename T> std::pair<bool, size_t> BTreeNode<T>::validate(bool root,
   }
 
   size_t childDepth = 0;
-  for (size_t i = 0; i < this->children.size(); i++) {
-    if (this->children[i] == nullptr) {
+  for (size_t i = 0; !this->isLeaf() && i < this->getChildren().size(); i++) {
+    if (this->getChildren()[i] == nullptr) {
 #ifdef VERDANT_FLAG_DEBUG
       std::cout << "[ERROR] Null node detected at node ID " << this->index << std::endl;
       std::cout << "[DEBUG] Number of values: " << this->values.size() << std::endl;
-      std::cout << "[DEBUG] Number of children: " << this->children.size() << std::endl;
+      std::cout << "[DEBUG] Number of children: " << this->getChildren().size() << std::endl;
       std::cout << "[DEBUG] Null child index: " << i << std::endl;
       exit(VerdantStatus::INTERNAL_ERROR);
 #endif
     }
-    std::pair<bool, size_t> childResult = this->children[i]->validate(false, this, (i == 0 ? minVal : &this->values[i - 1]), (i == this->children.size() - 1 ? maxVal : &this->values[i]));
+    std::pair<bool, size_t> childResult = this->getChildren()[i]->validate(false, this, (i == 0 ? minVal : &this->values[i - 1]), (i == this->getChildren().size() - 1 ? maxVal : &this->values[i]));
     if (childResult.first == false) {
       return { false, SIZE_MAX };
     }
@@ -864,11 +1093,11 @@ template <typename T> std::pair<bool, size_t> BTreeNode<T>::validate(bool root,
   }
 
   // NOTE: Rule 5: A non-leaf node with n keys has exactly n + 1 children
-  if (!this->isLeaf() && this->children.size() != this->values.size() + 1) {
+  if (!this->isLeaf() && this->getChildren().size() != this->values.size() + 1) {
 #ifdef VERDANT_FLAG_DEBUG
     std::cout << "[ERROR] Mismatched keys-children values" << std::endl;
     std::cout << "[DEBUG] Number of keys: " << this->values.size() << std::endl;
-    std::cout << "[DEBUG] Number of children: " << this->children.size() << std::endl;
+    std::cout << "[DEBUG] Number of children: " << this->getChildren().size() << std::endl;
 #endif
     return { false, SIZE_MAX };
   }
@@ -881,27 +1110,30 @@ template <typename T> Optional<T> BTreeNode<T>::getMinValue() {
   if (this->isLeaf()) {
     return this->values[0];
   }
-  return this->children[0]->getMinValue();
+  return this->getChildren()[0]->getMinValue();
 }
 
 template <typename T> Optional<T> BTreeNode<T>::getMaxValue() {
   if (this->isLeaf()) {
     return this->values[this->values.size() - 1];
   }
-  return this->children[this->children.size() - 1]->getMaxValue();
+  return this->getChildren()[this->getChildren().size() - 1]->getMaxValue();
 }
 
 template <typename T> size_t BTreeNode<T>::getHeight() {
   if (this->isLeaf()) {
     return 1;
   }
-  return this->children[0]->getHeight() + 1;
+  return this->getChildren()[0]->getHeight() + 1;
 }
 
 template <typename T> size_t BTreeNode<T>::countNodes() {
   size_t total = 1; // Including itself
-  
-  for (auto child = this->children.begin(); child != this->children.end(); child++) {
+  if (this->isLeaf()) {
+    return total;
+  }
+
+  for (auto child = this->getChildren().begin(); child != this->getChildren().end(); child++) {
     total += (*child)->countNodes();
   }
 
@@ -910,8 +1142,11 @@ template <typename T> size_t BTreeNode<T>::countNodes() {
 
 template <typename T> size_t BTreeNode<T>::countKeys() {
   size_t total = this->values.size(); // Including itself
-  
-  for (auto child = this->children.begin(); child != this->children.end(); child++) {
+  if (this->isLeaf()) {
+    return total;
+  }
+
+  for (auto child = this->getChildren().begin(); child != this->getChildren().end(); child++) {
     total += (*child)->countKeys();
   }
 
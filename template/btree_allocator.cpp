@@ -0,0 +1,80 @@
+#pragma once
+
+#include "btree_allocator.h"
+#include "parameters.h"
+#include "status.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+template <typename T> void BTreeNodeDeleter<T>::operator()(BTreeNode<T>* node) const {
+  BTreeNodeAllocator<T>* allocator = node->allocator;
+  if (node->leaf) {
+    static_cast<BTreeLeafNode<T>*>(node)->~BTreeLeafNode();
+    allocator->deallocate(node, sizeof(BTreeLeafNode<T>));
+  } else {
+    static_cast<BTreeInternalNode<T>*>(node)->~BTreeInternalNode();
+    allocator->deallocate(node, sizeof(BTreeInternalNode<T>));
+  }
+}
+
+template <typename T> void* BTreeNodeHeapAllocator<T>::allocate(size_t size) {
+  return ::operator new(size);
+}
+
+template <typename T> void BTreeNodeHeapAllocator<T>::deallocate(void* memory, size_t size) {
+  ::operator delete(memory);
+}
+
+template <typename T> size_t BTreeNodeArena<T>::alignment() {
+  return std::max({ alignof(BTreeLeafNode<T>), alignof(BTreeInternalNode<T>), alignof(FreeNode) });
+}
+
+template <typename T> typename BTreeNodeArena<T>::SizeClass& BTreeNodeArena<T>::getSizeClass(size_t size) {
+  size = (std::max(size, sizeof(FreeNode)) + alignment() - 1) / alignment() * alignment();
+  for (auto& sizeClass : this->sizeClasses) {
+    if (sizeClass.size == size) {
+      return sizeClass;
+    }
+  }
+  this->sizeClasses.push_back({ size, {}, BTREE_ARENA_SLAB_NODES, nullptr });
+  return this->sizeClasses[this->sizeClasses.size() - 1];
+}
+
+template <typename T> void* BTreeNodeArena<T>::allocate(size_t size) {
+  SizeClass& sizeClass = this->getSizeClass(size);
+  if (sizeClass.freeList != nullptr) {
+    FreeNode* node = sizeClass.freeList;
+    sizeClass.freeList = node->next;
+    return node;
+  }
+  if (sizeClass.slabUsed == BTREE_ARENA_SLAB_NODES) {
+    char* slab = static_cast<char*>(std::aligned_alloc(alignment(), sizeClass.size * BTREE_ARENA_SLAB_NODES));
+    if (slab == nullptr) {
+      std::cerr << "[ERROR] Cannot allocate BTree nodes" << std::endl;
+      VerdantStatus::handleError(VerdantStatus::OUT_OF_MEMORY);
+    }
+    sizeClass.slabs.emplace_back(slab);
+    sizeClass.slabUsed = 0;
+  }
+  void* memory = sizeClass.slabs[sizeClass.slabs.size() - 1].get() + sizeClass.slabUsed * sizeClass.size;
+  sizeClass.slabUsed++;
+  return memory;
+}
+
+template <typename T> void BTreeNodeArena<T>::deallocate(void* memory, size_t size) {
+  SizeClass& sizeClass = this->getSizeClass(size);
+  FreeNode* node = static_cast<FreeNode*>(memory);
+  node->next = sizeClass.freeList;
+  sizeClass.freeList = node;
+}
+
+template <typename T> size_t BTreeNodeArena<T>::getSlabCount() const {
+  size_t count = 0;
+  for (auto& sizeClass : this->sizeClasses) {
+    count += sizeClass.slabs.size();
+  }
+  return count;
+}
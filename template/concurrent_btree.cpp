@@ -0,0 +1,485 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <thread>
+
+#include "concurrent_btree.h"
+#include "simd_search.h"
+
+// Node anatomy
+// leaf:  lock | leaf | count | next | key[capacity]
+// inner: lock | leaf | count | key[capacity] | child[capacity + 1]
+// Both kinds fit in one BLOCK_SIZE. Keys under child[i] are greater than
+// key[i - 1] and at most key[i].
+
+template <typename T> static size_t concurrentLowerBound(const T* keys, size_t count, const T& key) {
+  if constexpr (SimdSearchable<T>::value) {
+    return simdLowerBound(keys, count, key);
+  }
+  return std::lower_bound(keys, keys + count, key) - keys;
+}
+
+// NOTE: Node section
+
+template <typename T> ConcurrentBTreeNode<T>::ConcurrentBTreeNode(bool leaf) : leaf(leaf) {
+  this->count = 0;
+}
+
+template <typename T> ConcurrentBTreeLeaf<T>::ConcurrentBTreeLeaf() : ConcurrentBTreeNode<T>(true) {
+  this->next = nullptr;
+}
+
+template <typename T> bool ConcurrentBTreeLeaf<T>::isFull() const {
+  return this->count >= capacity;
+}
+
+// The count may be read while a writer changes it, so it is clamped to the
+// capacity. The caller validates the version before trusting the result.
+template <typename T> size_t ConcurrentBTreeLeaf<T>::lowerBound(const T& key) const {
+  return concurrentLowerBound(this->keys, std::min(this->count, capacity), key);
+}
+
+template <typename T> bool ConcurrentBTreeLeaf<T>::insert(const T& key) {
+  assert(this->count < capacity);
+  size_t pos = this->lowerBound(key);
+  if (pos < this->count && this->keys[pos] == key) {
+    this->keys[pos] = key;
+    return false;
+  }
+  std::copy_backward(this->keys + pos, this->keys + this->count, this->keys + this->count + 1);
+  this->keys[pos] = key;
+  this->count++;
+  return true;
+}
+
+// Moves the upper half into a new right sibling. The separator is the
+// largest key left behind.
+template <typename T> ConcurrentBTreeLeaf<T>* ConcurrentBTreeLeaf<T>::split(T& separator) {
+  ConcurrentBTreeLeaf<T>* right = new ConcurrentBTreeLeaf<T>();
+  size_t leftCount = this->count - this->count / 2;
+  right->count = this->count - leftCount;
+  std::copy(this->keys + leftCount, this->keys + this->count, right->keys);
+  right->next = this->next;
+  this->count = leftCount;
+  this->next = right;
+  separator = this->keys[leftCount - 1];
+  return right;
+}
+
+template <typename T> ConcurrentBTreeInner<T>::ConcurrentBTreeInner() : ConcurrentBTreeNode<T>(false) {}
+
+template <typename T> bool ConcurrentBTreeInner<T>::isFull() const {
+  return this->count >= capacity;
+}
+
+template <typename T> size_t ConcurrentBTreeInner<T>::lowerBound(const T& key) const {
+  return concurrentLowerBound(this->keys, std::min(this->count, capacity), key);
+}
+
+// child is the new right half of the child that was split at key
+template <typename T> void ConcurrentBTreeInner<T>::insert(const T& key, ConcurrentBTreeNode<T>* child) {
+  assert(this->count < capacity);
+  size_t pos = this->lowerBound(key);
+  std::copy_backward(this->keys + pos, this->keys + this->count, this->keys + this->count + 1);
+  std::copy_backward(this->children + pos + 1, this->children + this->count + 1, this->children + this->count + 2);
+  this->keys[pos] = key;
+  this->children[pos + 1] = child;
+  this->count++;
+}
+
+// Keeps keys [0, middle) and pushes keys[middle] up as the separator
+template <typename T> ConcurrentBTreeInner<T>* ConcurrentBTreeInner<T>::split(T& separator) {
+  ConcurrentBTreeInner<T>* right = new ConcurrentBTreeInner<T>();
+  size_t middle = this->count / 2;
+  right->count = this->count - middle - 1;
+  std::copy(this->keys + middle + 1, this->keys + this->count, right->keys);
+  std::copy(this->children + middle + 1, this->children + this->count + 1, right->children);
+  separator = this->keys[middle];
+  this->count = middle;
+  return right;
+}
+
+// NOTE: Tree section
+
+template <typename T> ConcurrentBTree<T>::ConcurrentBTree() {
+#ifdef VERDANT_FLAG_DEBUG
+  std::cout << "[DEBUG] ConcurrentBTree leaf capacity: " << ConcurrentBTreeLeaf<T>::capacity << ", inner capacity: " << ConcurrentBTreeInner<T>::capacity << std::endl;
+#endif
+  static_assert(sizeof(ConcurrentBTreeLeaf<T>) <= BLOCK_SIZE && sizeof(ConcurrentBTreeInner<T>) <= BLOCK_SIZE, "Node exceeds a block");
+  static_assert(ConcurrentBTreeInner<T>::capacity >= 2, "Key too large for a ConcurrentBTree node");
+  this->root.store(new ConcurrentBTreeLeaf<T>());
+}
+
+template <typename T> ConcurrentBTree<T>::~ConcurrentBTree() {
+  freeNode(this->root.load());
+}
+
+template <typename T> void ConcurrentBTree<T>::freeNode(ConcurrentBTreeNode<T>* node) {
+  if (node->leaf) {
+    delete static_cast<ConcurrentBTreeLeaf<T>*>(node);
+    return;
+  }
+  auto inner = static_cast<ConcurrentBTreeInner<T>*>(node);
+  for (size_t i = 0; i <= inner->count; i++) {
+    freeNode(inner->children[i]);
+  }
+  delete inner;
+}
+
+// Back off before retrying so that the thread holding the latch can finish
+template <typename T> void ConcurrentBTree<T>::yield(size_t restartCount) {
+  if (restartCount > 0) {
+    std::this_thread::yield();
+  }
+}
+
+// Called with the old root write-latched, so no other writer can race the
+// replacement
+template <typename T> void ConcurrentBTree<T>::makeRoot(const T& separator, ConcurrentBTreeNode<T>* left, ConcurrentBTreeNode<T>* right) {
+  ConcurrentBTreeInner<T>* newRoot = new ConcurrentBTreeInner<T>();
+  newRoot->count = 1;
+  newRoot->keys[0] = separator;
+  newRoot->children[0] = left;
+  newRoot->children[1] = right;
+  this->root.store(newRoot);
+}
+
+// Optimistic descent to the leaf covering key. Each child pointer is only
+// followed after its parent's version was validated. On success the leaf is
+// returned with the version it was read at, which the caller validates or
+// upgrades.
+template <typename T> ConcurrentBTreeLeaf<T>* ConcurrentBTree<T>::findLeaf(const T& key, uint64_t& leafVersion, bool& needRestart) {
+  ConcurrentBTreeNode<T>* node = this->root.load();
+  uint64_t version = node->lock.readLockOrRestart(needRestart);
+  if (needRestart || node != this->root.load()) {
+    needRestart = true;
+    return nullptr;
+  }
+
+  ConcurrentBTreeInner<T>* parent = nullptr;
+  uint64_t parentVersion = 0;
+  while (!node->leaf) {
+    auto inner = static_cast<ConcurrentBTreeInner<T>*>(node);
+    if (parent != nullptr) {
+      parent->lock.readUnlockOrRestart(parentVersion, needRestart);
+      if (needRestart) {
+        return nullptr;
+      }
+    }
+    parent = inner;
+    parentVersion = version;
+
+    node = inner->children[inner->lowerBound(key)];
+    inner->lock.checkOrRestart(version, needRestart);
+    if (needRestart) {
+      return nullptr;
+    }
+    version = node->lock.readLockOrRestart(needRestart);
+    if (needRestart) {
+      return nullptr;
+    }
+  }
+  if (parent != nullptr) {
+    parent->lock.readUnlockOrRestart(parentVersion, needRestart);
+    if (needRestart) {
+      return nullptr;
+    }
+  }
+  leafVersion = version;
+  return static_cast<ConcurrentBTreeLeaf<T>*>(node);
+}
+
+template <typename T> bool ConcurrentBTree<T>::insert(const T& key) {
+  for (size_t restartCount = 0;; restartCount++) {
+    yield(restartCount);
+    bool needRestart = false;
+    ConcurrentBTreeNode<T>* node = this->root.load();
+    uint64_t version = node->lock.readLockOrRestart(needRestart);
+    if (needRestart || node != this->root.load()) {
+      continue;
+    }
+
+    ConcurrentBTreeInner<T>* parent = nullptr;
+    uint64_t parentVersion = 0;
+    while (!needRestart) {
+      // A full node is split before descending further, holding the latches
+      // of the node and its parent. The insert then starts over.
+      bool full = node->leaf ? static_cast<ConcurrentBTreeLeaf<T>*>(node)->isFull()
+                             : static_cast<ConcurrentBTreeInner<T>*>(node)->isFull();
+      if (full) {
+        if (parent != nullptr) {
+          parent->lock.upgradeToWriteLockOrRestart(parentVersion, needRestart);
+          if (needRestart) {
+            break;
+          }
+        }
+        node->lock.upgradeToWriteLockOrRestart(version, needRestart);
+        if (needRestart) {
+          if (parent != nullptr) {
+            parent->lock.writeUnlock();
+          }
+          break;
+        }
+        if (parent == nullptr && node != this->root.load()) {
+          node->lock.writeUnlock();
+          needRestart = true;
+          break;
+        }
+
+        T separator;
+        ConcurrentBTreeNode<T>* right;
+        if (node->leaf) {
+          right = static_cast<ConcurrentBTreeLeaf<T>*>(node)->split(separator);
+        } else {
+          right = static_cast<ConcurrentBTreeInner<T>*>(node)->split(separator);
+        }
+        if (parent != nullptr) {
+          parent->insert(separator, right);
+        } else {
+          this->makeRoot(separator, node, right);
+        }
+        node->lock.writeUnlock();
+        if (parent != nullptr) {
+          parent->lock.writeUnlock();
+        }
+        needRestart = true;
+        break;
+      }
+
+      if (node->leaf) {
+        break;
+      }
+
+      auto inner = static_cast<ConcurrentBTreeInner<T>*>(node);
+      if (parent != nullptr) {
+        parent->lock.readUnlockOrRestart(parentVersion, needRestart);
+        if (needRestart) {
+          break;
+        }
+      }
+      parent = inner;
+      parentVersion = version;
+      node = inner->children[inner->lowerBound(key)];
+      inner->lock.checkOrRestart(version, needRestart);
+      if (needRestart) {
+        break;
+      }
+      version = node->lock.readLockOrRestart(needRestart);
+    }
+    if (needRestart) {
+      continue;
+    }
+
+    auto leaf = static_cast<ConcurrentBTreeLeaf<T>*>(node);
+    leaf->lock.upgradeToWriteLockOrRestart(version, needRestart);
+    if (needRestart) {
+      continue;
+    }
+    if (parent != nullptr) {
+      parent->lock.readUnlockOrRestart(parentVersion, needRestart);
+      if (needRestart) {
+        leaf->lock.writeUnlock();
+        continue;
+      }
+    }
+    bool inserted = leaf->insert(key);
+    leaf->lock.writeUnlock();
+    return inserted;
+  }
+}
+
+template <typename T> Optional<T> ConcurrentBTree<T>::remove(const T& key) {
+  for (size_t restartCount = 0;; restartCount++) {
+    yield(restartCount);
+    bool needRestart = false;
+    uint64_t version;
+    ConcurrentBTreeLeaf<T>* leaf = this->findLeaf(key, version, needRestart);
+    if (needRestart) {
+      continue;
+    }
+    size_t pos = leaf->lowerBound(key);
+    bool found = pos < std::min(leaf->count, ConcurrentBTreeLeaf<T>::capacity) && leaf->keys[pos] == key;
+    if (!found) {
+      leaf->lock.readUnlockOrRestart(version, needRestart);
+      if (needRestart) {
+        continue;
+      }
+      return Optional<T>();
+    }
+
+    // An unchanged version also means the leaf still covers the key
+    leaf->lock.upgradeToWriteLockOrRestart(version, needRestart);
+    if (needRestart) {
+      continue;
+    }
+    T removed = leaf->keys[pos];
+    std::copy(leaf->keys + pos + 1, leaf->keys + leaf->count, leaf->keys + pos);
+    leaf->count--;
+    leaf->lock.writeUnlock();
+    return removed;
+  }
+}
+
+template <typename T> Optional<T> ConcurrentBTree<T>::search(const T& key) {
+  for (size_t restartCount = 0;; restartCount++) {
+    yield(restartCount);
+    bool needRestart = false;
+    uint64_t version;
+    ConcurrentBTreeLeaf<T>* leaf = this->findLeaf(key, version, needRestart);
+    if (needRestart) {
+      continue;
+    }
+    size_t pos = leaf->lowerBound(key);
+    bool found = pos < std::min(leaf->count, ConcurrentBTreeLeaf<T>::capacity) && leaf->keys[pos] == key;
+    T value = found ? leaf->keys[pos] : key;
+    leaf->lock.readUnlockOrRestart(version, needRestart);
+    if (needRestart) {
+      continue;
+    }
+    return found ? Optional<T>(value) : Optional<T>();
+  }
+}
+
+// Walks the leaf chain, validating every leaf before its keys are kept. After
+// a failed validation the scan resumes from the last key already collected,
+// so the result stays sorted and free of duplicates.
+template <typename T> Optional<std::vector<T>> ConcurrentBTree<T>::searchRange(const T& minKey, const T& maxKey) {
+  std::vector<T> result;
+  T from = minKey;
+  bool resumed = false;
+  for (size_t restartCount = 0;; restartCount++) {
+    yield(restartCount);
+    bool needRestart = false;
+    uint64_t version;
+    ConcurrentBTreeLeaf<T>* leaf = this->findLeaf(from, version, needRestart);
+    bool done = false;
+    while (!needRestart) {
+      size_t mark = result.size();
+      size_t count = std::min(leaf->count, ConcurrentBTreeLeaf<T>::capacity);
+      ConcurrentBTreeLeaf<T>* next = leaf->next;
+      bool pastMax = false;
+      for (size_t pos = leaf->lowerBound(from); pos < count; pos++) {
+        T key = leaf->keys[pos];
+        if (maxKey < key) {
+          pastMax = true;
+          break;
+        }
+        if (!resumed || from < key) {
+          result.push_back(key);
+        }
+      }
+      leaf->lock.readUnlockOrRestart(version, needRestart);
+      if (needRestart) {
+        result.resize(mark);
+        break;
+      }
+      if (result.size() > mark) {
+        from = result[result.size() - 1];
+        resumed = true;
+      }
+      if (pastMax || next == nullptr) {
+        done = true;
+        break;
+      }
+      version = next->lock.readLockOrRestart(needRestart);
+      leaf = next;
+    }
+    if (done) {
+      return result;
+    }
+  }
+}
+
+template <typename T> bool ConcurrentBTree<T>::validate() {
+  size_t leafDepth = 0;
+  if (!this->validate(this->root.load(), 1, leafDepth, nullptr, nullptr)) {
+    return false;
+  }
+
+  // The leaf chain must visit every key in ascending order
+  ConcurrentBTreeNode<T>* node = this->root.load();
+  while (!node->leaf) {
+    node = static_cast<ConcurrentBTreeInner<T>*>(node)->children[0];
+  }
+  const T* previous = nullptr;
+  for (auto leaf = static_cast<ConcurrentBTreeLeaf<T>*>(node); leaf != nullptr; leaf = leaf->next) {
+    for (size_t i = 0; i < leaf->count; i++) {
+      if (previous != nullptr && !(*previous < leaf->keys[i])) {
+#ifdef VERDANT_FLAG_DEBUG
+        std::cout << "[ERROR] ConcurrentBTree leaf chain is out of order" << std::endl;
+#endif
+        return false;
+      }
+      previous = &leaf->keys[i];
+    }
+  }
+  return true;
+}
+
+template <typename T> bool ConcurrentBTree<T>::validate(ConcurrentBTreeNode<T>* node, size_t depth, size_t& leafDepth, const T* minKey, const T* maxKey) {
+  const T* keys = node->leaf ? static_cast<ConcurrentBTreeLeaf<T>*>(node)->keys : static_cast<ConcurrentBTreeInner<T>*>(node)->keys;
+  for (size_t i = 0; i < node->count; i++) {
+    if ((i > 0 && !(keys[i - 1] < keys[i])) || (minKey != nullptr && !(*minKey < keys[i])) || (maxKey != nullptr && *maxKey < keys[i])) {
+#ifdef VERDANT_FLAG_DEBUG
+      std::cout << "[ERROR] ConcurrentBTree key out of range at depth " << depth << std::endl;
+#endif
+      return false;
+    }
+  }
+  if (node->leaf) {
+    if (leafDepth == 0) {
+      leafDepth = depth;
+    }
+    if (leafDepth != depth) {
+#ifdef VERDANT_FLAG_DEBUG
+      std::cout << "[ERROR] ConcurrentBTree is not balanced" << std::endl;
+#endif
+      return false;
+    }
+    return true;
+  }
+
+  auto inner = static_cast<ConcurrentBTreeInner<T>*>(node);
+  if (inner->count == 0) {
+#ifdef VERDANT_FLAG_DEBUG
+    std::cout << "[ERROR] ConcurrentBTree inner node without keys" << std::endl;
+#endif
+    return false;
+  }
+  for (size_t i = 0; i <= inner->count; i++) {
+    const T* childMin = i == 0 ? minKey : &inner->keys[i - 1];
+    const T* childMax = i == inner->count ? maxKey : &inner->keys[i];
+    if (!this->validate(inner->children[i], depth + 1, leafDepth, childMin, childMax)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T> size_t ConcurrentBTree<T>::getHeight() {
+  size_t height = 1;
+  ConcurrentBTreeNode<T>* node = this->root.load();
+  while (!node->leaf) {
+    node = static_cast<ConcurrentBTreeInner<T>*>(node)->children[0];
+    height++;
+  }
+  return height;
+}
+
+template <typename T> size_t ConcurrentBTree<T>::countNodes() {
+  return this->countNodes(this->root.load());
+}
+
+template <typename T> size_t ConcurrentBTree<T>::countNodes(ConcurrentBTreeNode<T>* node) {
+  if (node->leaf) {
+    return 1;
+  }
+  auto inner = static_cast<ConcurrentBTreeInner<T>*>(node);
+  size_t total = 1;
+  for (size_t i = 0; i <= inner->count; i++) {
+    total += this->countNodes(inner->children[i]);
+  }
+  return total;
+}
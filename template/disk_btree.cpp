@@ -0,0 +1,569 @@
+#pragma once
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <tuple>
+#include <type_traits>
+
+#include "buffer_pool.h"
+#include "disk_btree.h"
+#include "optional.h"
+#include "parameters.h"
+#include "status.h"
+
+// Index page anatomy
+// Meta page (page 0): magic | keySize | valueSize | root | pageCount | height
+// Node page: isLeaf | count | next | key[capacity] | value[capacity]      (leaf)
+//            isLeaf | count | next | key[capacity] | child[capacity + 1]  (internal)
+// `next` links the leaves left to right, children are page numbers.
+
+constexpr size_t DISK_BTREE_MAGIC = 0x5844495654524556; // "VERTVIDX"
+constexpr size_t DISK_BTREE_HEADER_SIZE = 3 * sizeof(size_t);
+
+// NOTE: DiskBTreeNode section
+
+template <typename K, typename V> DiskBTreeNode<K, V>::DiskBTreeNode(char* page) : page(page) {}
+
+template <typename K, typename V> size_t DiskBTreeNode<K, V>::leafCapacity() {
+  return (BLOCK_SIZE - DISK_BTREE_HEADER_SIZE) / (sizeof(K) + sizeof(V));
+}
+
+template <typename K, typename V> size_t DiskBTreeNode<K, V>::internalCapacity() {
+  return (BLOCK_SIZE - DISK_BTREE_HEADER_SIZE - sizeof(size_t)) / (sizeof(K) + sizeof(size_t));
+}
+
+template <typename K, typename V> void DiskBTreeNode<K, V>::init(bool leaf) {
+  std::memset(this->page, 0, BLOCK_SIZE);
+  size_t isLeaf = leaf ? 1 : 0;
+  std::memcpy(&this->page[0], &isLeaf, sizeof(size_t));
+}
+
+template <typename K, typename V> bool DiskBTreeNode<K, V>::isLeaf() const {
+  size_t isLeaf;
+  std::memcpy(&isLeaf, &this->page[0], sizeof(size_t));
+  return isLeaf != 0;
+}
+
+template <typename K, typename V> size_t DiskBTreeNode<K, V>::size() const {
+  size_t count;
+  std::memcpy(&count, &this->page[sizeof(size_t)], sizeof(size_t));
+  return count;
+}
+
+template <typename K, typename V> void DiskBTreeNode<K, V>::setSize(size_t size) {
+  std::memcpy(&this->page[sizeof(size_t)], &size, sizeof(size_t));
+}
+
+template <typename K, typename V> size_t DiskBTreeNode<K, V>::getNext() const {
+  size_t next;
+  std::memcpy(&next, &this->page[2 * sizeof(size_t)], sizeof(size_t));
+  return next;
+}
+
+template <typename K, typename V> void DiskBTreeNode<K, V>::setNext(size_t next) {
+  std::memcpy(&this->page[2 * sizeof(size_t)], &next, sizeof(size_t));
+}
+
+template <typename K, typename V> K DiskBTreeNode<K, V>::getKey(size_t index) const {
+  K key;
+  std::memcpy(static_cast<void*>(&key), &this->page[DISK_BTREE_HEADER_SIZE + index * sizeof(K)], sizeof(K));
+  return key;
+}
+
+template <typename K, typename V> void DiskBTreeNode<K, V>::setKey(size_t index, const K& key) {
+  std::memcpy(&this->page[DISK_BTREE_HEADER_SIZE + index * sizeof(K)], &key, sizeof(K));
+}
+
+template <typename K, typename V> V DiskBTreeNode<K, V>::getValue(size_t index) const {
+  V value;
+  size_t offset = DISK_BTREE_HEADER_SIZE + leafCapacity() * sizeof(K) + index * sizeof(V);
+  std::memcpy(static_cast<void*>(&value), &this->page[offset], sizeof(V));
+  return value;
+}
+
+template <typename K, typename V> void DiskBTreeNode<K, V>::setValue(size_t index, const V& value) {
+  size_t offset = DISK_BTREE_HEADER_SIZE + leafCapacity() * sizeof(K) + index * sizeof(V);
+  std::memcpy(&this->page[offset], &value, sizeof(V));
+}
+
+template <typename K, typename V> size_t DiskBTreeNode<K, V>::getChild(size_t index) const {
+  size_t child;
+  size_t offset = DISK_BTREE_HEADER_SIZE + internalCapacity() * sizeof(K) + index * sizeof(size_t);
+  std::memcpy(&child, &this->page[offset], sizeof(size_t));
+  return child;
+}
+
+template <typename K, typename V> void DiskBTreeNode<K, V>::setChild(size_t index, size_t child) {
+  size_t offset = DISK_BTREE_HEADER_SIZE + internalCapacity() * sizeof(K) + index * sizeof(size_t);
+  std::memcpy(&this->page[offset], &child, sizeof(size_t));
+}
+
+// Index of the first key that is not less than `key`
+template <typename K, typename V> size_t DiskBTreeNode<K, V>::lowerBound(const K& key) const {
+  size_t left = 0;
+  size_t right = this->size();
+  while (left < right) {
+    size_t mid = (right - left) / 2 + left;
+    if (this->getKey(mid) < key) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+// Index of the first key that is larger than `key`, i.e. the child to descend into
+template <typename K, typename V> size_t DiskBTreeNode<K, V>::upperBound(const K& key) const {
+  size_t left = 0;
+  size_t right = this->size();
+  while (left < right) {
+    size_t mid = (right - left) / 2 + left;
+    if (key < this->getKey(mid)) {
+      right = mid;
+    } else {
+      left = mid + 1;
+    }
+  }
+  return left;
+}
+
+template <typename K, typename V> void DiskBTreeNode<K, V>::insertLeafEntry(size_t index, const K& key, const V& value) {
+  size_t count = this->size();
+  assert(count < leafCapacity());
+  size_t keyOffset = DISK_BTREE_HEADER_SIZE + index * sizeof(K);
+  size_t valueOffset = DISK_BTREE_HEADER_SIZE + leafCapacity() * sizeof(K) + index * sizeof(V);
+  std::memmove(&this->page[keyOffset + sizeof(K)], &this->page[keyOffset], (count - index) * sizeof(K));
+  std::memmove(&this->page[valueOffset + sizeof(V)], &this->page[valueOffset], (count - index) * sizeof(V));
+  this->setKey(index, key);
+  this->setValue(index, value);
+  this->setSize(count + 1);
+}
+
+template <typename K, typename V> void DiskBTreeNode<K, V>::insertInternalEntry(size_t index, const K& key, size_t rightChild) {
+  size_t count = this->size();
+  assert(count < internalCapacity());
+  size_t keyOffset = DISK_BTREE_HEADER_SIZE + index * sizeof(K);
+  size_t childOffset = DISK_BTREE_HEADER_SIZE + internalCapacity() * sizeof(K) + (index + 1) * sizeof(size_t);
+  std::memmove(&this->page[keyOffset + sizeof(K)], &this->page[keyOffset], (count - index) * sizeof(K));
+  std::memmove(&this->page[childOffset + sizeof(size_t)], &this->page[childOffset], (count - index) * sizeof(size_t));
+  this->setKey(index, key);
+  this->setChild(index + 1, rightChild);
+  this->setSize(count + 1);
+}
+
+template <typename K, typename V> void DiskBTreeNode<K, V>::removeLeafEntry(size_t index) {
+  size_t count = this->size();
+  assert(index < count);
+  size_t keyOffset = DISK_BTREE_HEADER_SIZE + index * sizeof(K);
+  size_t valueOffset = DISK_BTREE_HEADER_SIZE + leafCapacity() * sizeof(K) + index * sizeof(V);
+  std::memmove(&this->page[keyOffset], &this->page[keyOffset + sizeof(K)], (count - index - 1) * sizeof(K));
+  std::memmove(&this->page[valueOffset], &this->page[valueOffset + sizeof(V)], (count - index - 1) * sizeof(V));
+  this->setSize(count - 1);
+}
+
+// NOTE: DiskBTree section
+
+template <typename K, typename V> DiskBTree<K, V>::DiskBTree(const std::string& path) : file(path) {
+  static_assert(std::is_trivially_copy_constructible<K>::value && std::is_trivially_destructible<K>::value,
+                "DiskBTree keys are copied into pages byte by byte");
+  static_assert(std::is_trivially_copy_constructible<V>::value && std::is_trivially_destructible<V>::value,
+                "DiskBTree values are copied into pages byte by byte");
+  assert((DiskBTreeNode<K, V>::leafCapacity() >= 2));
+  assert((DiskBTreeNode<K, V>::internalCapacity() >= 2));
+
+  if (!this->file.isOpen()) {
+    std::cerr << "[ERROR] Cannot open the index file '" << path << "'" << std::endl;
+    VerdantStatus::handleError(VerdantStatus::INVALID_PERMISSION);
+  }
+
+  if (this->file.getBlockCount() == 0) {
+    PageGuard meta = this->newPage();
+    PageGuard rootPage = this->newPage();
+    DiskBTreeNode<K, V>(rootPage.getData()).init(true);
+    rootPage.markDirty();
+    this->root = rootPage.getIndex();
+    this->height = 1;
+    this->dirty = true;
+    meta.release();
+    this->writeMeta();
+  } else {
+    this->readMeta();
+  }
+#ifdef VERDANT_FLAG_DEBUG
+  std::cout << "[DEBUG] DiskBTree leaf capacity: " << DiskBTreeNode<K, V>::leafCapacity()
+            << ", internal capacity: " << DiskBTreeNode<K, V>::internalCapacity() << std::endl;
+#endif
+}
+
+template <typename K, typename V> DiskBTree<K, V>::~DiskBTree() {
+  this->writeMeta();
+  BufferPool::getInstance().evictFile(this->file);
+}
+
+template <typename K, typename V> PageGuard DiskBTree<K, V>::fetchPage(size_t index) {
+  auto optionalPage = BufferPool::getInstance().fetchPage(this->file, index);
+  if (!optionalPage.unwrappable()) {
+#ifdef VERDANT_FLAG_DEBUG
+    std::cerr << "[ERROR] Cannot read index page " << index << std::endl;
+#endif
+    VerdantStatus::handleError(optionalPage.status);
+  }
+  return optionalPage.unwrap();
+}
+
+template <typename K, typename V> PageGuard DiskBTree<K, V>::newPage() {
+  auto optionalPage = BufferPool::getInstance().newPage(this->file);
+  if (!optionalPage.unwrappable()) {
+#ifdef VERDANT_FLAG_DEBUG
+    std::cerr << "[ERROR] Cannot allocate an index page" << std::endl;
+#endif
+    VerdantStatus::handleError(optionalPage.status);
+  }
+  return optionalPage.unwrap();
+}
+
+template <typename K, typename V> void DiskBTree<K, V>::readMeta() {
+  PageGuard page = this->fetchPage(0);
+  size_t meta[7];
+  std::memcpy(meta, page.getData(), sizeof(meta));
+  if (meta[0] != DISK_BTREE_MAGIC || meta[1] != sizeof(K) || meta[2] != sizeof(V)) {
+    std::cerr << "[ERROR] Index file is corrupted or was built for another key type" << std::endl;
+    VerdantStatus::handleError(VerdantStatus::INTERNAL_ERROR);
+  }
+  this->root = meta[3];
+  this->height = meta[5];
+  this->dirty = meta[6] != 0;
+}
+
+template <typename K, typename V> void DiskBTree<K, V>::writeMeta() {
+  PageGuard page = this->fetchPage(0);
+  size_t meta[7] = { DISK_BTREE_MAGIC, sizeof(K), sizeof(V), this->root, this->file.getBlockCount(), this->height, this->dirty };
+  std::memcpy(page.getData(), meta, sizeof(meta));
+  page.markDirty();
+}
+
+// The flag has to be on disk before any changed page can be, so the first
+// change after a save waits for the meta page to be synced
+template <typename K, typename V> void DiskBTree<K, V>::setDirty() {
+  if (this->dirty) {
+    return;
+  }
+  this->dirty = true;
+  this->writeMeta();
+  if (!BufferPool::getInstance().flushPage(this->file, 0) || !this->file.sync()) {
+    VerdantStatus::handleError(VerdantStatus::INTERNAL_ERROR);
+  }
+}
+
+template <typename K, typename V> bool DiskBTree<K, V>::insert(const K& key, const V& value) {
+  if (this->search(key).unwrappable()) {
+    return false;
+  }
+  this->setDirty();
+  auto split = this->insert(this->root, key, value);
+  if (!split.unwrappable()) {
+    return true;
+  }
+#ifdef VERDANT_FLAG_DEBUG
+  std::cout << "[DEBUG] DiskBTree: Starting root replacement." << std::endl;
+#endif
+  K separator;
+  size_t rightPage;
+  std::tie(separator, rightPage) = split.unwrap();
+
+  PageGuard page = this->newPage();
+  DiskBTreeNode<K, V> newRoot(page.getData());
+  newRoot.init(false);
+  newRoot.setChild(0, this->root);
+  newRoot.insertInternalEntry(0, separator, rightPage);
+  page.markDirty();
+
+  this->root = page.getIndex();
+  this->height++;
+  this->writeMeta();
+  return true;
+}
+
+// Returns the separator and page number of the new right sibling when the node splits
+template <typename K, typename V> Optional<std::pair<K, size_t>> DiskBTree<K, V>::insert(size_t pageIndex, const K& key, const V& value) {
+  PageGuard page = this->fetchPage(pageIndex);
+  DiskBTreeNode<K, V> node(page.getData());
+
+  if (node.isLeaf()) {
+    size_t insertIndex = node.lowerBound(key);
+    page.markDirty();
+    if (node.size() < DiskBTreeNode<K, V>::leafCapacity()) {
+      node.insertLeafEntry(insertIndex, key, value);
+      return Optional<std::pair<K, size_t>>();
+    }
+
+    // Leaf is full. Split it and copy the first key of the right half up
+    std::vector<K> keys;
+    std::vector<V> values;
+    keys.reserve(node.size() + 1);
+    values.reserve(node.size() + 1);
+    for (size_t i = 0; i < node.size(); i++) {
+      if (i == insertIndex) {
+        keys.push_back(key);
+        values.push_back(value);
+      }
+      keys.push_back(node.getKey(i));
+      values.push_back(node.getValue(i));
+    }
+    if (insertIndex == node.size()) {
+      keys.push_back(key);
+      values.push_back(value);
+    }
+
+    size_t middle = keys.size() / 2;
+    PageGuard rightPage = this->newPage();
+    DiskBTreeNode<K, V> right(rightPage.getData());
+    right.init(true);
+    for (size_t i = middle; i < keys.size(); i++) {
+      right.setKey(i - middle, keys[i]);
+      right.setValue(i - middle, values[i]);
+    }
+    right.setSize(keys.size() - middle);
+    right.setNext(node.getNext());
+    rightPage.markDirty();
+
+    for (size_t i = 0; i < middle; i++) {
+      node.setKey(i, keys[i]);
+      node.setValue(i, values[i]);
+    }
+    node.setSize(middle);
+    node.setNext(rightPage.getIndex());
+    return std::make_pair(keys[middle], rightPage.getIndex());
+  }
+
+  size_t childIndex = node.upperBound(key);
+  auto childSplit = this->insert(node.getChild(childIndex), key, value);
+  if (!childSplit.unwrappable()) {
+    return Optional<std::pair<K, size_t>>();
+  }
+  K childSeparator;
+  size_t childPage;
+  std::tie(childSeparator, childPage) = childSplit.unwrap();
+
+  page.markDirty();
+  if (node.size() < DiskBTreeNode<K, V>::internalCapacity()) {
+    node.insertInternalEntry(childIndex, childSeparator, childPage);
+    return Optional<std::pair<K, size_t>>();
+  }
+
+  // Internal node is full. Split it and move the middle key up
+  std::vector<K> keys;
+  std::vector<size_t> children;
+  keys.reserve(node.size() + 1);
+  children.reserve(node.size() + 2);
+  for (size_t i = 0; i < node.size(); i++) {
+    if (i == childIndex) {
+      keys.push_back(childSeparator);
+    }
+    keys.push_back(node.getKey(i));
+  }
+  if (childIndex == node.size()) {
+    keys.push_back(childSeparator);
+  }
+  for (size_t i = 0; i <= node.size(); i++) {
+    children.push_back(node.getChild(i));
+    if (i == childIndex) {
+      children.push_back(childPage);
+    }
+  }
+
+  size_t middle = keys.size() / 2;
+  PageGuard rightPage = this->newPage();
+  DiskBTreeNode<K, V> right(rightPage.getData());
+  right.init(false);
+  for (size_t i = middle + 1; i < keys.size(); i++) {
+    right.setKey(i - middle - 1, keys[i]);
+  }
+  for (size_t i = middle + 1; i < children.size(); i++) {
+    right.setChild(i - middle - 1, children[i]);
+  }
+  right.setSize(keys.size() - middle - 1);
+  rightPage.markDirty();
+
+  for (size_t i = 0; i < middle; i++) {
+    node.setKey(i, keys[i]);
+  }
+  for (size_t i = 0; i <= middle; i++) {
+    node.setChild(i, children[i]);
+  }
+  node.setSize(middle);
+  return std::make_pair(keys[middle], rightPage.getIndex());
+}
+
+// Pages are not merged on removal. Underfull leaves stay linked in the leaf
+// chain and are refilled by later inserts.
+template <typename K, typename V> Optional<V> DiskBTree<K, V>::remove(const K& key) {
+  PageGuard page = this->fetchPage(this->root);
+  DiskBTreeNode<K, V> node(page.getData());
+  while (!node.isLeaf()) {
+    page = this->fetchPage(node.getChild(node.upperBound(key)));
+    node = DiskBTreeNode<K, V>(page.getData());
+  }
+  size_t index = node.lowerBound(key);
+  if (index == node.size() || node.getKey(index) != key) {
+    return Optional<V>();
+  }
+  this->setDirty();
+  V value = node.getValue(index);
+  node.removeLeafEntry(index);
+  page.markDirty();
+  return value;
+}
+
+template <typename K, typename V> Optional<V> DiskBTree<K, V>::search(const K& key) {
+  PageGuard page = this->fetchPage(this->root);
+  DiskBTreeNode<K, V> node(page.getData());
+  while (!node.isLeaf()) {
+    page = this->fetchPage(node.getChild(node.upperBound(key)));
+    node = DiskBTreeNode<K, V>(page.getData());
+  }
+  size_t index = node.lowerBound(key);
+  if (index == node.size() || node.getKey(index) != key) {
+    return Optional<V>();
+  }
+  return node.getValue(index);
+}
+
+template <typename K, typename V> Optional<std::vector<std::pair<K, V>>> DiskBTree<K, V>::searchRange(const K& minKey, const K& maxKey) {
+  PageGuard page = this->fetchPage(this->root);
+  DiskBTreeNode<K, V> node(page.getData());
+  while (!node.isLeaf()) {
+    page = this->fetchPage(node.getChild(node.upperBound(minKey)));
+    node = DiskBTreeNode<K, V>(page.getData());
+  }
+
+  std::vector<std::pair<K, V>> rangeResult;
+  size_t index = node.lowerBound(minKey);
+  while (true) {
+    if (index == node.size()) {
+      if (node.getNext() == 0) {
+        break;
+      }
+      page = this->fetchPage(node.getNext());
+      node = DiskBTreeNode<K, V>(page.getData());
+      index = 0;
+      continue;
+    }
+    K key = node.getKey(index);
+    if (maxKey < key) {
+      break;
+    }
+    rangeResult.push_back(std::make_pair(key, node.getValue(index)));
+    index++;
+  }
+  return rangeResult;
+}
+
+template <typename K, typename V> bool DiskBTree<K, V>::validate() {
+  return this->validate(this->root, 1, nullptr, nullptr);
+}
+
+template <typename K, typename V> bool DiskBTree<K, V>::validate(size_t pageIndex, size_t depth, const K* minKey, const K* maxKey) {
+  if (pageIndex == 0 || pageIndex >= this->file.getBlockCount()) {
+#ifdef VERDANT_FLAG_DEBUG
+    std::cout << "[ERROR] DiskBTree page out of bound: " << pageIndex << std::endl;
+#endif
+    return false;
+  }
+  PageGuard page = this->fetchPage(pageIndex);
+  DiskBTreeNode<K, V> node(page.getData());
+  size_t count = node.size();
+
+  if (count > (node.isLeaf() ? DiskBTreeNode<K, V>::leafCapacity() : DiskBTreeNode<K, V>::internalCapacity())) {
+#ifdef VERDANT_FLAG_DEBUG
+    std::cout << "[ERROR] DiskBTree page " << pageIndex << " has more keys than its capacity" << std::endl;
+#endif
+    return false;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    K key = node.getKey(i);
+    if ((minKey != nullptr && key < *minKey) || (maxKey != nullptr && !(key < *maxKey))) {
+#ifdef VERDANT_FLAG_DEBUG
+      std::cout << "[ERROR] DiskBTree page " << pageIndex << " has a key outside of its parent range" << std::endl;
+#endif
+      return false;
+    }
+    if (i > 0 && !(node.getKey(i - 1) < key)) {
+#ifdef VERDANT_FLAG_DEBUG
+      std::cout << "[ERROR] DiskBTree page " << pageIndex << " has non-ascending keys" << std::endl;
+#endif
+      return false;
+    }
+  }
+
+  if (node.isLeaf()) {
+    if (depth != this->height) {
+#ifdef VERDANT_FLAG_DEBUG
+      std::cout << "[ERROR] DiskBTree is not balanced" << std::endl;
+#endif
+      return false;
+    }
+    return true;
+  }
+
+  if (count == 0) {
+#ifdef VERDANT_FLAG_DEBUG
+    std::cout << "[ERROR] DiskBTree internal page " << pageIndex << " has no key" << std::endl;
+#endif
+    return false;
+  }
+
+  for (size_t i = 0; i <= count; i++) {
+    K childMin = i == 0 ? K() : node.getKey(i - 1);
+    K childMax = i == count ? K() : node.getKey(i);
+    if (!this->validate(node.getChild(i), depth + 1, i == 0 ? minKey : &childMin, i == count ? maxKey : &childMax)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename K, typename V> size_t DiskBTree<K, V>::getHeight() {
+  return this->height;
+}
+
+template <typename K, typename V> size_t DiskBTree<K, V>::countNodes() {
+  return this->countNodes(this->root);
+}
+
+template <typename K, typename V> size_t DiskBTree<K, V>::countNodes(size_t pageIndex) {
+  PageGuard page = this->fetchPage(pageIndex);
+  DiskBTreeNode<K, V> node(page.getData());
+  size_t total = 1; // Including itself
+  if (node.isLeaf()) {
+    return total;
+  }
+  for (size_t i = 0; i <= node.size(); i++) {
+    total += this->countNodes(node.getChild(i));
+  }
+  return total;
+}
+
+template <typename K, typename V> bool DiskBTree<K, V>::isDirty() const {
+  return this->dirty;
+}
+
+// Every page is made durable before the tree is marked clean. A clean tree
+// has not changed since it was saved.
+template <typename K, typename V> void DiskBTree<K, V>::save() {
+  if (!this->dirty) {
+    return;
+  }
+  this->writeMeta();
+  if (!BufferPool::getInstance().flushFile(this->file) || !this->file.sync()) {
+    VerdantStatus::handleError(VerdantStatus::INTERNAL_ERROR);
+  }
+  this->dirty = false;
+  this->writeMeta();
+  if (!BufferPool::getInstance().flushPage(this->file, 0) || !this->file.sync()) {
+    VerdantStatus::handleError(VerdantStatus::INTERNAL_ERROR);
+  }
+}
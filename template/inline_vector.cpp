@@ -0,0 +1,119 @@
+#pragma once
+
+#include "inline_vector.h"
+
+#include <cassert>
+#include <new>
+#include <utility>
+
+template <typename T, size_t N> InlineVector<T, N>::InlineVector() {
+  this->count = 0;
+}
+
+template <typename T, size_t N> InlineVector<T, N>::~InlineVector() {
+  this->clear();
+}
+
+template <typename T, size_t N> size_t InlineVector<T, N>::size() const {
+  return this->count;
+}
+
+template <typename T, size_t N> bool InlineVector<T, N>::empty() const {
+  return this->count == 0;
+}
+
+template <typename T, size_t N> T* InlineVector<T, N>::data() {
+  return reinterpret_cast<T*>(this->storage);
+}
+
+template <typename T, size_t N> const T* InlineVector<T, N>::data() const {
+  return reinterpret_cast<const T*>(this->storage);
+}
+
+template <typename T, size_t N> T* InlineVector<T, N>::begin() {
+  return this->data();
+}
+
+template <typename T, size_t N> T* InlineVector<T, N>::end() {
+  return this->data() + this->count;
+}
+
+template <typename T, size_t N> const T* InlineVector<T, N>::begin() const {
+  return this->data();
+}
+
+template <typename T, size_t N> const T* InlineVector<T, N>::end() const {
+  return this->data() + this->count;
+}
+
+template <typename T, size_t N> T& InlineVector<T, N>::operator[](size_t index) {
+  return this->data()[index];
+}
+
+template <typename T, size_t N> const T& InlineVector<T, N>::operator[](size_t index) const {
+  return this->data()[index];
+}
+
+template <typename T, size_t N> T& InlineVector<T, N>::back() {
+  assert(this->count > 0);
+  return this->data()[this->count - 1];
+}
+
+template <typename T, size_t N> void InlineVector<T, N>::push_back(T value) {
+  assert(this->count < N);
+  new (this->data() + this->count) T(std::move(value));
+  this->count++;
+}
+
+template <typename T, size_t N> void InlineVector<T, N>::pop_back() {
+  assert(this->count > 0);
+  this->count--;
+  this->data()[this->count].~T();
+}
+
+template <typename T, size_t N> T* InlineVector<T, N>::insert(T* position, T value) {
+  assert(this->count < N && position >= this->begin() && position <= this->end());
+  if (position == this->end()) {
+    this->push_back(std::move(value));
+    return this->end() - 1;
+  }
+  // Shift the tail one slot to the right, constructing the new last slot
+  T* last = this->end();
+  new (last) T(std::move(*(last - 1)));
+  for (T* item = last - 1; item != position; item--) {
+    *item = std::move(*(item - 1));
+  }
+  *position = std::move(value);
+  this->count++;
+  return position;
+}
+
+template <typename T, size_t N> T* InlineVector<T, N>::erase(T* position) {
+  assert(position >= this->begin() && position < this->end());
+  for (T* item = position; item + 1 != this->end(); item++) {
+    *item = std::move(*(item + 1));
+  }
+  this->pop_back();
+  return position;
+}
+
+template <typename T, size_t N> template <typename Iterator> void InlineVector<T, N>::assign(Iterator first, Iterator last) {
+  this->clear();
+  for (; first != last; ++first) {
+    this->push_back(*first);
+  }
+}
+
+template <typename T, size_t N> void InlineVector<T, N>::resize(size_t size) {
+  assert(size <= N);
+  while (this->count > size) {
+    this->pop_back();
+  }
+  while (this->count < size) {
+    this->push_back(T());
+  }
+}
+
+template <typename T, size_t N> void InlineVector<T, N>::clear() {
+  this->resize(0);
+}
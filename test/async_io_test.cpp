@@ -0,0 +1,143 @@
+#include "async_io.h"
+#include "block_file.h"
+#include "parameters.h"
+#include "util.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+size_t PAGE_COUNT = 512;
+size_t DEPTH = 32;
+const char* FILE_PATH = "async_io_test.vtbl";
+
+// A device without a descriptor, which io_uring has to run inline
+class MemoryBlockDevice final : public BlockDevice {
+private:
+  std::vector<char> memory;
+
+public:
+  bool isOpen() const { return true; }
+  size_t getSize() { return memory.size(); }
+  size_t read(size_t offset, char* data, size_t size) {
+    size = offset < memory.size() ? std::min(size, memory.size() - offset) : 0;
+    std::memcpy(data, memory.data() + offset, size);
+    return size;
+  }
+  bool write(size_t offset, const char* data, size_t size) {
+    memory.resize(std::max(memory.size(), offset + size));
+    std::memcpy(memory.data() + offset, data, size);
+    return true;
+  }
+  bool resize(size_t size) {
+    memory.resize(size);
+    return true;
+  }
+  bool sync() { return true; }
+  int getDescriptor() const { return -1; }
+};
+
+static char* allocatePages(size_t count) {
+  char* pages = static_cast<char*>(std::aligned_alloc(BLOCK_SIZE, count * BLOCK_SIZE));
+  assert(pages != nullptr);
+  return pages;
+}
+
+static std::vector<IORequest> makeRequests(BlockDevice& device, bool write, char* pages) {
+  std::vector<IORequest> requests;
+  for (size_t i = 0; i < PAGE_COUNT; i++) {
+    requests.push_back({&device, write, i * BLOCK_SIZE, &pages[i * BLOCK_SIZE], BLOCK_SIZE, 0, false});
+  }
+  return requests;
+}
+
+static void testEngine(AsyncIO& io, BlockDevice& device) {
+  Utility::BufferUniquePtr<char> pages(allocatePages(PAGE_COUNT));
+  for (size_t i = 0; i < PAGE_COUNT; i++) {
+    std::memset(&pages.get()[i * BLOCK_SIZE], static_cast<int>(i % 251), BLOCK_SIZE);
+  }
+  auto writes = makeRequests(device, true, pages.get());
+  auto start = std::chrono::steady_clock::now();
+  [[maybe_unused]] bool wrote = io.run(writes);
+  assert(wrote);
+  auto writeTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  assert(io.getInFlight() == 0);
+
+  std::memset(pages.get(), 0, PAGE_COUNT * BLOCK_SIZE);
+  auto reads = makeRequests(device, false, pages.get());
+  start = std::chrono::steady_clock::now();
+  [[maybe_unused]] bool readBack = io.run(reads);
+  assert(readBack);
+  auto readTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  for (size_t i = 0; i < PAGE_COUNT; i++) {
+    assert(pages.get()[i * BLOCK_SIZE] == static_cast<char>(i % 251));
+    assert(pages.get()[(i + 1) * BLOCK_SIZE - 1] == static_cast<char>(i % 251));
+  }
+
+  // The queue holds at most depth requests
+  for (size_t i = 0; i < io.getDepth(); i++) {
+    [[maybe_unused]] bool queued = io.submit(&reads[i]);
+    assert(queued);
+  }
+  [[maybe_unused]] bool overflowed = io.submit(&reads[io.getDepth()]);
+  assert(!overflowed);
+  [[maybe_unused]] bool started = io.start();
+  assert(started);
+  std::vector<IORequest*> completed;
+  while (io.getInFlight() > 0) {
+    [[maybe_unused]] size_t reaped = io.reap(completed, 1);
+    assert(reaped > 0);
+  }
+  assert(completed.size() == io.getDepth());
+  for (IORequest* request : completed) {
+    assert(request->done && request->result == BLOCK_SIZE);
+  }
+
+  // Reading past the end is short
+  IORequest past = {&device, false, PAGE_COUNT * BLOCK_SIZE, pages.get(), BLOCK_SIZE, 0, false};
+  std::vector<IORequest> pastRequests = {past};
+  [[maybe_unused]] bool readPast = io.run(pastRequests);
+  assert(!readPast);
+  assert(pastRequests[0].done && pastRequests[0].result == 0);
+
+  std::cout << "[DEBUG] " << io.getName() << ": wrote " << PAGE_COUNT << " pages in " << writeTime.count()
+            << "us, read them in " << readTime.count() << "us" << std::endl;
+}
+
+int main() {
+  std::remove(FILE_PATH);
+  {
+    IoUringIO ring(DEPTH);
+    if (ring.isOpen()) {
+      FileBlockDevice device(FILE_PATH);
+      testEngine(ring, device);
+      MemoryBlockDevice memory;
+      testEngine(ring, memory);
+    } else {
+      std::cout << "[DEBUG] io_uring is not available" << std::endl;
+    }
+  }
+  {
+    ThreadPoolIO threads(DEPTH);
+    FileBlockDevice device(FILE_PATH);
+    testEngine(threads, device);
+    FileBlockDevice direct(FILE_PATH, true);
+    testEngine(threads, direct);
+  }
+  {
+    // The engine picked by default also drives an O_DIRECT file
+    std::unique_ptr<AsyncIO> io = AsyncIO::create(DEPTH);
+    FileBlockDevice direct(FILE_PATH, true);
+    testEngine(*io, direct);
+  }
+
+  BlockFile file(FILE_PATH);
+  assert(file.getBlockCount() == PAGE_COUNT);
+  std::remove(FILE_PATH);
+  return 0;
+}
@@ -1,16 +1,166 @@
 #include "btree.h"
+#include "simd_search.h"
 
+#include <algorithm>
+#include <chrono>
 #include <climits>
+#include <set>
 #include <unordered_map>
 #include <random>
 
 size_t ITERATION_COUNT = 200000;
 size_t SEARCH_TEST_DURATION = 10000;
 size_t RANGE_TEST_DURATION = 10000;
+size_t CURSOR_PROBES = 1000;
 size_t DELETION_TEST_DURATION = 1000;
 size_t DELETIONS_PER_ROUND = 99;
+size_t BULK_LOAD_SIZES[] = { 0, 1, 300, 5000, 200000 };
+double BULK_LOAD_FILL_FACTORS[] = { 0.5, 0.7, 1.0 };
+size_t BULK_LOAD_UPDATES = 2000;
+size_t ALLOCATOR_TEST_VALUES = 100000;
+size_t NODE_SEARCH_KEYS = 510;
+size_t NODE_SEARCH_PROBES = 2000000;
 typedef long long T;
 
+template <typename K> static void verifyNodeSearch(std::vector<K>& sorted, K probe) {
+  size_t expected = std::lower_bound(sorted.begin(), sorted.end(), probe) - sorted.begin();
+  assert(simdLowerBound(sorted.data(), sorted.size(), probe) == expected);
+}
+
+static void testNodeSearch(std::mt19937& rng) {
+  std::uniform_int_distribution<T> uni(-INT_MAX, INT_MAX);
+  for (size_t size = 0; size <= NODE_SEARCH_KEYS; size++) {
+    std::set<T> unique;
+    while (unique.size() < size) {
+      unique.insert(uni(rng));
+    }
+    std::vector<T> sorted(unique.begin(), unique.end());
+    std::vector<int> sortedInt(sorted.begin(), sorted.end());
+    std::vector<double> sortedDouble(sorted.begin(), sorted.end());
+    for (size_t i = 0; i < 20; i++) {
+      T probe = (i % 2 == 0 || size == 0) ? uni(rng) : sorted[uni(rng) % size];
+      verifyNodeSearch(sorted, probe);
+      verifyNodeSearch(sortedInt, (int)probe);
+      verifyNodeSearch(sortedDouble, (double)probe);
+    }
+  }
+
+  // Compare against the scalar binary search on a full node
+  std::set<T> unique;
+  while (unique.size() < NODE_SEARCH_KEYS) {
+    unique.insert(uni(rng));
+  }
+  std::vector<T> sorted(unique.begin(), unique.end());
+  std::vector<T> probes(NODE_SEARCH_PROBES);
+  for (auto& probe : probes) {
+    probe = uni(rng);
+  }
+  size_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (T probe : probes) {
+    checksum += std::lower_bound(sorted.begin(), sorted.end(), probe) - sorted.begin();
+  }
+  auto scalarElapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  start = std::chrono::steady_clock::now();
+  for (T probe : probes) {
+    checksum -= simdLowerBound(sorted.data(), sorted.size(), probe);
+  }
+  auto simdElapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  assert(checksum == 0);
+  std::cout << "[DEBUG] Node search over " << NODE_SEARCH_KEYS << " keys: binary " << (double)scalarElapsed.count() / NODE_SEARCH_PROBES << "ns, SIMD " << (double)simdElapsed.count() / NODE_SEARCH_PROBES << "ns per lookup" << std::endl;
+}
+
+// Runs the same workload on the default arena and on plain heap nodes
+static void testAllocators(std::mt19937& rng) {
+  std::uniform_int_distribution<T> uni(0, INT_MAX);
+  std::vector<T> workload(ALLOCATOR_TEST_VALUES);
+  for (auto& value : workload) {
+    value = uni(rng);
+  }
+  BTree<T> arenaTree;
+  BTree<T> heapTree(std::unique_ptr<BTreeNodeAllocator<T>>(new BTreeNodeHeapAllocator<T>()));
+  BTree<T>* trees[] = { &arenaTree, &heapTree };
+  const char* names[] = { "arena", "heap" };
+  for (size_t t = 0; t < 2; t++) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < workload.size(); i++) {
+      trees[t]->insert(workload[i]);
+      // Remove every third value again to exercise merges and node reuse
+      if (i % 3 == 2) {
+        trees[t]->remove(workload[i - 1]);
+      }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    assert(trees[t]->validate());
+    std::cout << "[DEBUG] Workload on " << names[t] << " nodes took " << elapsed.count() << "ms" << std::endl;
+  }
+  auto arenaCursor = arenaTree.begin();
+  for (auto heapCursor = heapTree.begin(); heapCursor != heapTree.end(); ++heapCursor, ++arenaCursor) {
+    assert(arenaCursor.valid() && *arenaCursor == *heapCursor);
+  }
+  assert(arenaCursor == arenaTree.end());
+}
+
+static void testBulkLoad(std::mt19937& rng) {
+  std::uniform_int_distribution<T> uni(0, INT_MAX);
+  for (size_t size : BULK_LOAD_SIZES) {
+    std::set<T> expected;
+    while (expected.size() < size) {
+      expected.insert(uni(rng));
+    }
+    std::vector<T> sorted(expected.begin(), expected.end());
+    for (double fillFactor : BULK_LOAD_FILL_FACTORS) {
+      BTree<T> btree;
+      auto start = std::chrono::steady_clock::now();
+      [[maybe_unused]] bool loaded = btree.bulkLoad(sorted.begin(), sorted.end(), fillFactor);
+      assert(loaded);
+      auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+      assert(btree.validate());
+      for (T value : sorted) {
+        assert(btree.search(value).unwrappable());
+      }
+      if (size > 0) {
+        assert(btree.searchRange(sorted[0], sorted[size - 1]).unwrap() == sorted);
+      }
+      auto cursor = btree.begin();
+      for (T value : sorted) {
+        assert(cursor.valid() && *cursor == value);
+        ++cursor;
+      }
+      assert(cursor == btree.end());
+
+      // The loaded tree must keep working under regular updates
+      std::set<T> current = expected;
+      for (size_t i = 0; i < BULK_LOAD_UPDATES; i++) {
+        if (i % 2 == 0 || current.empty()) {
+          T value = uni(rng);
+          btree.insert(value);
+          current.insert(value);
+        } else {
+          T value = *current.begin();
+          current.erase(current.begin());
+          btree.remove(value);
+        }
+      }
+      assert(btree.validate());
+      for (T value : current) {
+        assert(btree.search(value).unwrappable());
+      }
+      std::cout << "[DEBUG] Bulk loaded " << size << " values with fill factor " << fillFactor << " in " << elapsed.count() << "us, height " << btree.getHeight() << std::endl;
+    }
+  }
+
+  // Unsorted input is rejected without touching the tree
+  BTree<T> btree;
+  std::vector<T> sorted = { 1, 2, 3 };
+  std::vector<T> unsorted = { 3, 1, 2 };
+  [[maybe_unused]] bool loaded = btree.bulkLoad(sorted.begin(), sorted.end());
+  assert(loaded);
+  loaded = btree.bulkLoad(unsorted.begin(), unsorted.end());
+  assert(!loaded);
+  assert(btree.searchRange(1, 3).unwrap() == sorted);
+}
+
 int main() {
 #ifdef VERDANT_FLAG_DEBUG
   std::cout << "[DEBUG] Debug enabled" << std::endl;
@@ -19,6 +169,10 @@ int main() {
 
   std::random_device dev;
   std::mt19937 rng(dev());
+  testNodeSearch(rng);
+  testAllocators(rng);
+  testBulkLoad(rng);
+
   std::uniform_int_distribution<T> uni(0, INT_MAX);
   std::unordered_map<T, size_t> comparativeStructure;
   std::cout << "[DEBUG] Start fuzzing" << std::endl;
@@ -56,6 +210,24 @@ int main() {
         for (size_t i = 0; i < result.size() - 1; i++) {
           assert(result[i] < result[i + 1]);
         }
+
+        size_t cursorCount = 0;
+        for (auto cursor = btree.begin(); cursor != btree.end(); ++cursor) {
+          assert(*cursor == result[cursorCount]);
+          cursorCount++;
+        }
+        assert(cursorCount == result.size());
+        for (size_t i = 0; i < CURSOR_PROBES; i++) {
+          T probe = i % 2 == 0 ? uni(rng) : result[uni(rng) % result.size()];
+          auto expectedLower = std::lower_bound(result.begin(), result.end(), probe);
+          auto expectedUpper = std::upper_bound(result.begin(), result.end(), probe);
+          auto lower = btree.lowerBound(probe);
+          auto upper = btree.upperBound(probe);
+          assert(lower.valid() == (expectedLower != result.end()));
+          assert(upper.valid() == (expectedUpper != result.end()));
+          assert(!lower.valid() || *lower == *expectedLower);
+          assert(!upper.valid() || *upper == *expectedUpper);
+        }
       }
       std::cout << "[DEBUG] Range queried successfully" << std::endl;
     }
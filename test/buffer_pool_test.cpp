@@ -0,0 +1,90 @@
+#include "block_file.h"
+#include "buffer_pool.h"
+#include "parameters.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+size_t FRAME_COUNT = 4;
+size_t PAGE_COUNT = 64;
+const char* FILE_PATH = "buffer_pool_test.vtbl";
+
+int main() {
+  std::remove(FILE_PATH);
+  {
+    BlockFile file(FILE_PATH);
+    assert(file.isOpen());
+    BufferPool pool(FRAME_COUNT);
+
+    for (size_t i = 0; i < PAGE_COUNT; i++) {
+      PageGuard page = pool.newPage(file).unwrap();
+      assert(page.getIndex() == i);
+      std::memset(page.getData(), static_cast<int>(i), BLOCK_SIZE);
+      page.markDirty();
+      assert(pool.getResidentCount() <= FRAME_COUNT);
+    }
+    std::cout << "[DEBUG] Pages written through " << FRAME_COUNT << " frames" << std::endl;
+
+    for (size_t i = 0; i < PAGE_COUNT; i++) {
+      PageGuard page = pool.fetchPage(file, i).unwrap();
+      for (size_t j = 0; j < BLOCK_SIZE; j++) {
+        assert(page.getData()[j] == static_cast<char>(i));
+      }
+    }
+    std::cout << "[DEBUG] Evicted pages read back successfully" << std::endl;
+
+    // Pinned pages are never evicted
+    std::vector<PageGuard> pinned;
+    for (size_t i = 0; i < FRAME_COUNT; i++) {
+      pinned.push_back(pool.fetchPage(file, i).unwrap());
+    }
+    [[maybe_unused]] VerdantStatus::StatusEnum status = pool.fetchPage(file, FRAME_COUNT).status;
+    assert(status == VerdantStatus::OUT_OF_MEMORY);
+    pinned.pop_back();
+    status = pool.fetchPage(file, FRAME_COUNT).status;
+    assert(status == VerdantStatus::SUCCESS);
+    pinned.clear();
+
+    [[maybe_unused]] bool evicted = pool.evictFile(file);
+    assert(evicted);
+    assert(pool.getResidentCount() == 0);
+  }
+
+  BlockFile reopened(FILE_PATH);
+  assert(reopened.getBlockCount() == PAGE_COUNT);
+  char block[BLOCK_SIZE];
+  [[maybe_unused]] bool read = reopened.readBlock(PAGE_COUNT - 1, block);
+  assert(read);
+  assert(block[0] == static_cast<char>(PAGE_COUNT - 1));
+  std::cout << "[DEBUG] Reopened file compared successfully" << std::endl;
+
+  // The same pages through O_DIRECT, which needs the aligned pool frames;
+  // the unaligned stack block goes through a copy
+  {
+    BlockFile direct(FILE_PATH, BlockFile::DIRECT);
+    assert(direct.isOpen() && direct.getBlockCount() == PAGE_COUNT);
+    BufferPool pool(FRAME_COUNT);
+    for (size_t i = 0; i < PAGE_COUNT; i++) {
+      PageGuard page = pool.fetchPage(direct, i).unwrap();
+      assert(page.getData()[BLOCK_SIZE - 1] == static_cast<char>(i));
+      std::memset(page.getData(), static_cast<int>(PAGE_COUNT - i), BLOCK_SIZE);
+      page.markDirty();
+    }
+    [[maybe_unused]] bool evicted = pool.evictFile(direct);
+    assert(evicted);
+    char unaligned[BLOCK_SIZE + 1];
+    read = direct.readBlock(0, &unaligned[1]);
+    assert(read);
+    assert(unaligned[1] == static_cast<char>(PAGE_COUNT));
+    std::cout << "[DEBUG] Pages rewritten through " << (static_cast<FileBlockDevice&>(direct.getDevice()).isDirect() ? "O_DIRECT" : "the page cache") << std::endl;
+  }
+  read = reopened.readBlock(1, block);
+  assert(read);
+  assert(block[0] == static_cast<char>(PAGE_COUNT - 1));
+
+  std::remove(FILE_PATH);
+  return 0;
+}
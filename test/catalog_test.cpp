@@ -0,0 +1,89 @@
+#include "catalog.h"
+#include "table.h"
+#include "util.h"
+
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+const char* DATABASE = "catalog_test";
+
+static void removeTable(const std::string& tablePath) {
+  std::remove(tablePath.c_str());
+  std::remove((tablePath + ".vidx").c_str());
+  std::remove((tablePath + ".vfsm").c_str());
+}
+
+static void checkItems(const Catalog& catalog) {
+  auto optionalSchema = catalog.getSchema("items");
+  assert(optionalSchema.unwrappable());
+  const TableSchema* schema = optionalSchema.unwrap();
+  assert(schema->layout == ROW_LAYOUT);
+  assert(schema->columns.size() == 3);
+  assert(schema->columns.at("id").first == 0);
+  assert(schema->columns.at("id").second.isPrimary);
+  assert(schema->columns.at("name").second.type == ColumnInfo::VARCHAR);
+  assert(schema->columns.at("name").second.varcharSize == 32);
+  assert(schema->columns.at("price").second.type == ColumnInfo::FLOAT);
+}
+
+static void checkOrders(const Catalog& catalog) {
+  auto optionalSchema = catalog.getSchema("orders");
+  assert(optionalSchema.unwrappable());
+  const TableSchema* schema = optionalSchema.unwrap();
+  assert(schema->layout == PAX_LAYOUT);
+  assert(schema->columns.size() == 2);
+  assert(schema->columns.at("item").first == 1);
+}
+
+static void testCatalog() {
+  std::string itemsStatement = "CREATE TABLE items (id INT PRIMARY KEY, name VARCHAR(32), price FLOAT);";
+  std::string ordersStatement = "CREATE TABLE orders (id INT PRIMARY KEY, item INT) LAYOUT PAX;";
+  {
+    Catalog catalog(DATABASE);
+    assert(catalog.getTableCount() == 0);
+    assert(!catalog.getSchema("items").unwrappable());
+
+    TableSchema items = Catalog::parseSchema("items", itemsStatement).unwrap();
+    TableSchema orders = Catalog::parseSchema("orders", ordersStatement).unwrap();
+    [[maybe_unused]] bool added = catalog.addTable("items", items, itemsStatement);
+    assert(added);
+    added = catalog.addTable("orders", orders, ordersStatement);
+    assert(added);
+    added = catalog.addTable("items", items, itemsStatement);
+    assert(!added);
+    assert(catalog.getTableCount() == 2);
+    checkItems(catalog);
+    checkOrders(catalog);
+  }
+
+  // A new connection reads the tables back from the master table
+  Catalog catalog(DATABASE);
+  assert(catalog.getTableCount() == 2);
+  assert(catalog.hasTable("items"));
+  assert(!catalog.hasTable("missing"));
+  checkItems(catalog);
+  checkOrders(catalog);
+  std::cout << "Catalog reloaded " << catalog.getTableCount() << " tables" << std::endl;
+}
+
+int main() {
+  // Keep the data directory inside the build tree
+  char cwd[PATH_MAX];
+  [[maybe_unused]] char* workingDirectory = getcwd(cwd, sizeof(cwd));
+  assert(workingDirectory != nullptr);
+  setenv("HOME", (std::string(cwd) + "/catalog_test_home").c_str(), 1);
+  std::string databasePath = Utility::getDatabasePath(DATABASE);
+  [[maybe_unused]] bool created = Utility::createDirectory(databasePath);
+  assert(created);
+  std::string masterPath = databasePath + DATABASE + "_verdant_master.vtbl";
+  removeTable(masterPath);
+  Table::createMasterTable(DATABASE);
+
+  testCatalog();
+  removeTable(masterPath);
+  return 0;
+}
@@ -0,0 +1,178 @@
+#include "concurrent_btree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <climits>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+size_t ITERATION_COUNT = 200000;
+size_t VALIDATION_DURATION = 20000;
+size_t DELETION_TEST_DURATION = 1000;
+size_t DELETIONS_PER_ROUND = 99;
+size_t KEYS_PER_WRITER = 100000;
+size_t THREAD_COUNTS[] = { 1, 2, 4, 8 };
+size_t OPERATIONS_PER_THREAD = 200000;
+typedef long long T;
+
+// Wide keys shrink the nodes to a few dozen entries, so concurrent writers
+// keep splitting inner nodes and growing the root
+struct WideKey {
+  T key;
+  char padding[200];
+
+  WideKey() : key(0) {}
+  WideKey(T key) : key(key) {}
+  bool operator<(const WideKey& other) const { return key < other.key; }
+  bool operator==(const WideKey& other) const { return key == other.key; }
+};
+
+template <typename K> static void verify(ConcurrentBTree<K>& btree, std::set<T>& comparativeStructure) {
+  assert(btree.validate());
+  for (T key : comparativeStructure) {
+    if (!btree.search(key).unwrappable()) {
+      std::cout << "[ERROR] Key " << key << " not found" << std::endl;
+      exit(1);
+    }
+  }
+  auto range = btree.searchRange(LLONG_MIN, LLONG_MAX).unwrap();
+  assert(range.size() == comparativeStructure.size());
+  assert(std::equal(range.begin(), range.end(), comparativeStructure.begin(), [](const K& a, T b) { return a == K(b); }));
+}
+
+// Same fuzzing as btree_test, on a single thread
+static void testSequential(std::mt19937& rng) {
+  ConcurrentBTree<T> btree;
+  std::uniform_int_distribution<T> uni(0, INT_MAX);
+  std::set<T> comparativeStructure;
+  for (size_t i = 0; i < ITERATION_COUNT; i++) {
+    size_t round = i + 1;
+    if (round % DELETION_TEST_DURATION == 0) {
+      for (size_t j = 0; j < DELETIONS_PER_ROUND; j++) {
+        T key = *comparativeStructure.begin();
+        comparativeStructure.erase(comparativeStructure.begin());
+        [[maybe_unused]] bool removed = btree.remove(key).unwrappable();
+        assert(removed);
+        assert(!btree.search(key).unwrappable());
+      }
+    } else {
+      T key = uni(rng);
+      [[maybe_unused]] bool inserted = btree.insert(key);
+      [[maybe_unused]] bool expected = comparativeStructure.insert(key).second;
+      assert(inserted == expected);
+    }
+    if (round % VALIDATION_DURATION == 0) {
+      verify(btree, comparativeStructure);
+      std::cout << "[DEBUG] Finished round " << round << std::endl;
+    }
+  }
+  std::cout << "[DEBUG] Tree height: " << btree.getHeight() << std::endl;
+  std::cout << "[DEBUG] Number of nodes: " << btree.countNodes() << std::endl;
+}
+
+// Writers own disjoint keys (key % writerCount == writer) and remove every
+// third key again, while readers keep scanning. Afterwards every writer's
+// outcome must be visible exactly.
+template <typename K> static void testConcurrent(size_t writerCount, size_t readerCount) {
+  ConcurrentBTree<K> btree;
+  std::atomic<bool> writing(true);
+  std::vector<std::thread> threads;
+  for (size_t writer = 0; writer < writerCount; writer++) {
+    threads.emplace_back([&btree, writer, writerCount]() {
+      for (size_t i = 0; i < KEYS_PER_WRITER; i++) {
+        T key = (T)((i * 7919) % KEYS_PER_WRITER * writerCount + writer);
+        [[maybe_unused]] bool inserted = btree.insert(key);
+        assert(inserted);
+        if (i % 3 == 2) {
+          T previous = (T)(((i - 1) * 7919) % KEYS_PER_WRITER * writerCount + writer);
+          [[maybe_unused]] bool removed = btree.remove(previous).unwrappable();
+          assert(removed);
+        }
+      }
+    });
+  }
+  std::atomic<size_t> scans(0);
+  for (size_t reader = 0; reader < readerCount; reader++) {
+    threads.emplace_back([&btree, &writing, &scans, reader]() {
+      std::mt19937 rng(reader);
+      std::uniform_int_distribution<T> uni(0, (T)KEYS_PER_WRITER);
+      while (writing.load()) {
+        T from = uni(rng);
+        auto range = btree.searchRange(from, from + 1000).unwrap();
+        for (size_t i = 1; i < range.size(); i++) {
+          assert(range[i - 1] < range[i]);
+        }
+        assert(range.empty() || (!(range[0] < K(from)) && !(K(from + 1000) < range[range.size() - 1])));
+        btree.search(uni(rng));
+        scans++;
+      }
+    });
+  }
+  for (size_t writer = 0; writer < writerCount; writer++) {
+    threads[writer].join();
+  }
+  writing.store(false);
+  for (size_t i = writerCount; i < threads.size(); i++) {
+    threads[i].join();
+  }
+
+  std::set<T> expected;
+  for (size_t writer = 0; writer < writerCount; writer++) {
+    for (size_t i = 0; i < KEYS_PER_WRITER; i++) {
+      if (i % 3 != 1) {
+        expected.insert((T)((i * 7919) % KEYS_PER_WRITER * writerCount + writer));
+      }
+    }
+  }
+  verify(btree, expected);
+  std::cout << "[DEBUG] " << writerCount << " writers and " << readerCount << " readers agreed, " << scans.load() << " scans" << std::endl;
+}
+
+// Mixed 90% search / 10% insert workload on a preloaded tree
+static void reportThroughput() {
+  ConcurrentBTree<T> btree;
+  for (T key = 0; key < (T)KEYS_PER_WRITER; key++) {
+    btree.insert(key * 2);
+  }
+  for (size_t threadCount : THREAD_COUNTS) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threadCount; t++) {
+      threads.emplace_back([&btree, t]() {
+        std::mt19937 rng(t);
+        std::uniform_int_distribution<T> uni(0, 2 * (T)KEYS_PER_WRITER);
+        for (size_t i = 0; i < OPERATIONS_PER_THREAD; i++) {
+          if (i % 10 == 0) {
+            btree.insert(uni(rng));
+          } else {
+            btree.search(uni(rng));
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    double throughput = (double)(threadCount * OPERATIONS_PER_THREAD) / elapsed.count();
+    std::cout << "[DEBUG] " << threadCount << " threads (" << std::thread::hardware_concurrency() << " cores): " << throughput << " million operations per second" << std::endl;
+  }
+  assert(btree.validate());
+}
+
+int main() {
+  std::random_device dev;
+  std::mt19937 rng(dev());
+  std::cout << "[DEBUG] Start fuzzing" << std::endl;
+  testSequential(rng);
+  testConcurrent<T>(1, 1);
+  testConcurrent<T>(4, 2);
+  testConcurrent<WideKey>(4, 2);
+  reportThroughput();
+  std::cout << "[DEBUG] End fuzzing" << std::endl;
+  return 0;
+}
@@ -0,0 +1,91 @@
+#include "disk_btree.h"
+
+#include <cassert>
+#include <climits>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+
+size_t ITERATION_COUNT = 100000;
+size_t VALIDATION_DURATION = 20000;
+size_t DELETION_TEST_DURATION = 1000;
+size_t DELETIONS_PER_ROUND = 99;
+const char* INDEX_PATH = "disk_btree_test.vidx";
+typedef long long K;
+typedef std::pair<size_t, size_t> V;
+
+static void verify(DiskBTree<K, V>& btree, std::unordered_map<K, V>& comparativeStructure) {
+  assert(btree.validate());
+  for (auto& item : comparativeStructure) {
+    auto result = btree.search(item.first);
+    if (!result.unwrappable() || result.unwrap() != item.second) {
+      std::cout << "[ERROR] Key " << item.first << " not found" << std::endl;
+      exit(1);
+    }
+  }
+  auto range = btree.searchRange(0, INT_MAX).unwrap();
+  assert(range.size() == comparativeStructure.size());
+  for (size_t i = 1; i < range.size(); i++) {
+    assert(range[i - 1].first < range[i].first);
+  }
+}
+
+int main() {
+  std::remove(INDEX_PATH);
+
+  std::random_device dev;
+  std::mt19937 rng(dev());
+  std::uniform_int_distribution<K> uni(0, INT_MAX);
+  std::unordered_map<K, V> comparativeStructure;
+  std::cout << "[DEBUG] Start fuzzing" << std::endl;
+
+  {
+    DiskBTree<K, V> btree(INDEX_PATH);
+    assert(btree.isDirty());
+    for (size_t i = 0; i < ITERATION_COUNT; i++) {
+      size_t round = i + 1;
+      if (round % DELETION_TEST_DURATION == 0) {
+        for (size_t j = 0; j < DELETIONS_PER_ROUND; j++) {
+          auto item = *comparativeStructure.begin();
+          comparativeStructure.erase(item.first);
+          [[maybe_unused]] bool removed = btree.remove(item.first).unwrappable();
+          assert(removed);
+          assert(!btree.search(item.first).unwrappable());
+        }
+      } else {
+        K randomKey = uni(rng);
+        V location = std::make_pair(round / 100, round % 100);
+        bool inserted = btree.insert(randomKey, location);
+        assert(inserted == (comparativeStructure.find(randomKey) == comparativeStructure.end()));
+        if (inserted) {
+          comparativeStructure[randomKey] = location;
+        }
+      }
+      if (round % VALIDATION_DURATION == 0) {
+        verify(btree, comparativeStructure);
+        std::cout << "[DEBUG] Finished round " << round << std::endl;
+      }
+    }
+    btree.save();
+    assert(!btree.isDirty());
+    std::cout << "[DEBUG] Tree height: " << btree.getHeight() << std::endl;
+    std::cout << "[DEBUG] Number of nodes: " << btree.countNodes() << std::endl;
+  }
+
+  // Reopen the index file and make sure nothing was lost
+  {
+    DiskBTree<K, V> reopened(INDEX_PATH);
+    assert(!reopened.isDirty());
+    verify(reopened, comparativeStructure);
+    std::cout << "[DEBUG] Reopened index compared successfully" << std::endl;
+    // Changed and closed without a save, as on a crash
+    [[maybe_unused]] bool inserted = reopened.insert(-1, std::make_pair(0, 0));
+    assert(inserted && reopened.isDirty());
+  }
+  DiskBTree<K, V> unsaved(INDEX_PATH);
+  assert(unsaved.isDirty());
+
+  std::remove(INDEX_PATH);
+  std::cout << "[DEBUG] End fuzzing" << std::endl;
+  return 0;
+}
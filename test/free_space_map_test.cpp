@@ -0,0 +1,159 @@
+#include "free_space_map.h"
+#include "parameters.h"
+#include "table.h"
+#include "util.h"
+
+#include <cassert>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+size_t RECORD_COUNT = 100;
+size_t PAYLOAD = 500;
+// Record of an INT and a PAYLOAD-byte VARCHAR, with its pointer
+size_t RECORD_SIZE = 1 + sizeof(int) + RecordLayout::getVarintSize(PAYLOAD) + PAYLOAD + sizeof(size_t);
+const char* MAP_PATH = "free_space_map_test.vfsm";
+const char* DATABASE = "free_space_map_test";
+const char* TABLE = "items";
+
+static Columns getColumns() {
+  Columns columns;
+  columns["id"] = {0, {ColumnInfo::INT, 0, true}};
+  columns["payload"] = {1, {ColumnInfo::VARCHAR, 1000, false}};
+  return columns;
+}
+
+static std::string readFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void insert(Table& table, size_t first, size_t count, size_t payload) {
+  std::vector<std::vector<Field>> records;
+  for (size_t i = first; i < first + count; i++) {
+    std::vector<Field> record;
+    record.push_back({"id", std::to_string(i)});
+    record.push_back({"payload", std::string(payload, 'a' + i % 26)});
+    records.push_back(std::move(record));
+  }
+  [[maybe_unused]] size_t added = table.addRecords(records);
+  assert(added == count);
+}
+
+static void testMap() {
+  std::remove(MAP_PATH);
+  {
+    FreeSpaceMap map(MAP_PATH);
+    assert(map.getBlockCount() == 0);
+    assert(!map.find(1).unwrappable());
+    map.update(0, 100);
+    map.update(1, 5000);
+    map.update(2, 40);
+    assert(map.getBlockCount() == 3);
+    // Rounded down, never above the real free space
+    assert(map.getFreeSpace(0) <= 100 && map.getFreeSpace(0) > 100 - BLOCK_SIZE / FREE_SPACE_CATEGORIES);
+    // The tightest block that fits
+    assert(map.find(60).unwrap() == 0);
+    assert(map.find(200).unwrap() == 1);
+    assert(!map.find(6000).unwrappable());
+    map.update(1, 0);
+    assert(!map.find(200).unwrappable());
+    map.save();
+  }
+  FreeSpaceMap reloaded(MAP_PATH);
+  assert(reloaded.getBlockCount() == 3);
+  assert(reloaded.find(60).unwrap() == 0);
+  assert(reloaded.getFreeSpace(1) == 0);
+  std::remove(MAP_PATH);
+  std::cout << "[DEBUG] Free space map updated and reloaded successfully" << std::endl;
+}
+
+static void testTable() {
+  std::string databasePath = Utility::getDatabasePath(DATABASE);
+  [[maybe_unused]] bool created = Utility::createDirectory(databasePath);
+  assert(created);
+  std::string tablePath = databasePath + TABLE;
+  std::remove(tablePath.c_str());
+  std::remove((tablePath + ".vidx").c_str());
+  std::remove((tablePath + ".vfsm").c_str());
+
+  size_t blockCount;
+  {
+    Table table(DATABASE, TABLE, getColumns());
+    insert(table, 0, RECORD_COUNT, PAYLOAD);
+    table.save();
+    blockCount = BlockFile(tablePath).getBlockCount();
+    FreeSpaceMap map(tablePath + ".vfsm");
+    assert(map.getBlockCount() == blockCount);
+    // Every full block is left with less than a record
+    for (size_t i = 0; i + 1 < blockCount; i++) {
+      assert(map.getFreeSpace(i) < RECORD_SIZE);
+    }
+  }
+
+  // A map claiming just enough room in a full block, which makes it the
+  // tightest fit, is corrected by the next insert
+  {
+    std::fstream map(tablePath + ".vfsm", std::ios::in | std::ios::out | std::ios::binary);
+    map.put(static_cast<char>(FreeSpaceMap::toCategory(RECORD_SIZE) + 1));
+  }
+  {
+    Table table(DATABASE, TABLE, getColumns());
+    insert(table, RECORD_COUNT, 1, PAYLOAD);
+    table.save();
+    for (size_t i = 0; i <= RECORD_COUNT; i++) {
+      Field key = {"id", std::to_string(i)};
+      auto location = table.findRecord(key);
+      assert(location.unwrappable());
+      assert(i < RECORD_COUNT || location.unwrap().first != 0);
+      auto fields = table.getRecord(location.unwrap());
+      assert(fields.unwrappable() && fields.unwrap()[1].value == std::string(PAYLOAD, 'a' + i % 26));
+    }
+  }
+  assert(FreeSpaceMap(tablePath + ".vfsm").getFreeSpace(0) < RECORD_SIZE);
+  std::cout << "[DEBUG] Stale free space entry corrected successfully" << std::endl;
+
+  // Short records fill the gaps left at the end of full blocks
+  {
+    Table table(DATABASE, TABLE, getColumns());
+    insert(table, RECORD_COUNT + 1, 1, 1);
+    table.save();
+    Field key = {"id", std::to_string(RECORD_COUNT + 1)};
+    auto location = table.findRecord(key);
+    assert(location.unwrappable() && location.unwrap().first + 1 < BlockFile(tablePath).getBlockCount());
+  }
+  std::cout << "[DEBUG] Short record placed in an earlier block successfully" << std::endl;
+
+  // A lost map is rebuilt from the blocks
+  std::string saved = readFile(tablePath + ".vfsm");
+  assert(saved.size() == BlockFile(tablePath).getBlockCount());
+  std::remove((tablePath + ".vfsm").c_str());
+  {
+    Table table(DATABASE, TABLE, getColumns());
+    table.save();
+  }
+  assert(readFile(tablePath + ".vfsm") == saved);
+  std::cout << "[DEBUG] Free space map rebuilt successfully" << std::endl;
+
+  std::remove(tablePath.c_str());
+  std::remove((tablePath + ".vidx").c_str());
+  std::remove((tablePath + ".vfsm").c_str());
+}
+
+int main() {
+  // Keep the data directory inside the build tree
+  char cwd[PATH_MAX];
+  [[maybe_unused]] char* workingDirectory = getcwd(cwd, sizeof(cwd));
+  assert(workingDirectory != nullptr);
+  setenv("HOME", (std::string(cwd) + "/free_space_map_test_home").c_str(), 1);
+
+  testMap();
+  testTable();
+  return 0;
+}
@@ -0,0 +1,147 @@
+#include "parallel_scan.h"
+#include "select_stmt.h"
+#include "table.h"
+#include "util.h"
+#include "vector_executor.h"
+
+#include <cassert>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+size_t RECORD_COUNT = 100000;
+size_t WORKER_COUNTS[] = { 1, 2, 4, 8 };
+const char* DATABASE = "parallel_scan_test";
+const char* TABLE = "items";
+PageLayout LAYOUTS[] = { ROW_LAYOUT, PAX_LAYOUT };
+BlockFile::Mode MODES[] = { BlockFile::BUFFERED, BlockFile::MAPPED };
+
+static Columns getColumns() {
+  Columns columns;
+  columns["id"] = {0, {ColumnInfo::INT, 0, true}};
+  columns["name"] = {1, {ColumnInfo::VARCHAR, 32, false}};
+  columns["price"] = {2, {ColumnInfo::FLOAT, 0, false}};
+  return columns;
+}
+
+static void removeTable(const std::string& tablePath) {
+  std::remove(tablePath.c_str());
+  std::remove((tablePath + ".vidx").c_str());
+  std::remove((tablePath + ".vfsm").c_str());
+}
+
+// Every third row leaves its name NULL; prices are whole numbers so the
+// float sums are exact
+static void insert(Table& table) {
+  std::vector<std::vector<Field>> records;
+  for (size_t i = 0; i < RECORD_COUNT; i++) {
+    std::vector<Field> record;
+    record.push_back({"id", std::to_string(i)});
+    if (i % 3 != 0) {
+      record.push_back({"name", "item" + std::to_string(i % 97)});
+    }
+    record.push_back({"price", std::to_string(i % 10)});
+    records.push_back(std::move(record));
+  }
+  [[maybe_unused]] size_t added = table.addRecords(records);
+  assert(added == RECORD_COUNT);
+}
+
+// SELECT COUNT(*), COUNT(name), SUM(id), SUM(price) FROM items WHERE price >= 5
+static SelectStmt getStatement() {
+  SelectStmt stmt(TABLE);
+  stmt.aggregates.push_back({Aggregate::COUNT, ""});
+  stmt.aggregates.push_back({Aggregate::COUNT, "name"});
+  stmt.aggregates.push_back({Aggregate::SUM, "id"});
+  stmt.aggregates.push_back({Aggregate::SUM, "price"});
+  Condition condition;
+  condition.column = "price";
+  condition.op = Condition::GREATER_EQUAL;
+  condition.value = "5";
+  condition.isString = false;
+  stmt.conditions.push_back(condition);
+  return stmt;
+}
+
+static void testTable(PageLayout layout, BlockFile::Mode mode) {
+  std::string tablePath = Utility::getDatabasePath(DATABASE) + TABLE;
+  removeTable(tablePath);
+  Table table(DATABASE, TABLE, getColumns(), mode, layout);
+  insert(table);
+
+  size_t count = 0;
+  size_t named = 0;
+  long long idSum = 0;
+  double priceSum = 0;
+  for (size_t i = 0; i < RECORD_COUNT; i++) {
+    if (i % 10 < 5) {
+      continue;
+    }
+    count++;
+    named += i % 3 != 0;
+    idSum += i;
+    priceSum += i % 10;
+  }
+
+  SelectStmt stmt = getStatement();
+  auto optionalPlan = SelectPlan::create(table.getLayout(), stmt);
+  assert(optionalPlan.unwrappable());
+  SelectPlan plan = optionalPlan.unwrap();
+  for (size_t workerCount : WORKER_COUNTS) {
+    auto start = std::chrono::steady_clock::now();
+    // Dirty blocks left by the insert are flushed before the first scan
+    std::vector<AggregateValue> values = ParallelScan(table, plan, workerCount).aggregate();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    assert(values.size() == 4);
+    assert(values[0].count == count);
+    assert(values[1].count == named);
+    assert(values[2].intSum == idSum && values[2].count == count);
+    assert(values[3].floatSum == priceSum);
+    std::cout << "[DEBUG] Aggregated " << RECORD_COUNT << (layout == PAX_LAYOUT ? " PAX" : "")
+              << (mode == BlockFile::MAPPED ? " mapped" : "") << " rows in " << table.getBlockCount()
+              << " blocks on " << workerCount << " workers in " << elapsed.count() << "us" << std::endl;
+  }
+
+  std::ostringstream out;
+  ParallelScan(table, plan, 2).run(out);
+  assert(out.str() == "COUNT(*) | COUNT(name) | SUM(id) | SUM(price)\n" + std::to_string(count) + " | " +
+                          std::to_string(named) + " | " + std::to_string(idSum) + " | " +
+                          std::to_string(priceSum) + "\n");
+  table.save();
+}
+
+static void testEmpty() {
+  std::string tablePath = Utility::getDatabasePath(DATABASE) + TABLE;
+  removeTable(tablePath);
+  Table table(DATABASE, TABLE, getColumns());
+  SelectStmt stmt = getStatement();
+  SelectPlan plan = SelectPlan::create(table.getLayout(), stmt).unwrap();
+  std::ostringstream out;
+  ParallelScan(table, plan, 4).run(out);
+  assert(out.str() == "COUNT(*) | COUNT(name) | SUM(id) | SUM(price)\n0 | 0 | NULL | NULL\n");
+  std::cout << "[DEBUG] Empty table aggregated successfully" << std::endl;
+}
+
+int main() {
+  // Keep the data directory inside the build tree
+  char cwd[PATH_MAX];
+  [[maybe_unused]] char* workingDirectory = getcwd(cwd, sizeof(cwd));
+  assert(workingDirectory != nullptr);
+  setenv("HOME", (std::string(cwd) + "/parallel_scan_test_home").c_str(), 1);
+  [[maybe_unused]] bool created = Utility::createDirectory(Utility::getDatabasePath(DATABASE));
+  assert(created);
+
+  for (PageLayout layout : LAYOUTS) {
+    for (BlockFile::Mode mode : MODES) {
+      testTable(layout, mode);
+    }
+  }
+  testEmpty();
+  removeTable(Utility::getDatabasePath(DATABASE) + TABLE);
+  return 0;
+}
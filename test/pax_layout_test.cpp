@@ -0,0 +1,187 @@
+#include "pax_layout.h"
+#include "table.h"
+#include "util.h"
+
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+size_t RECORD_COUNT = 20000;
+BlockFile::Mode MODES[] = { BlockFile::BUFFERED, BlockFile::MAPPED };
+const char* DATABASE = "pax_layout_test";
+const char* TABLE = "items";
+
+static Columns getColumns() {
+  Columns columns;
+  columns["id"] = {0, {ColumnInfo::INT, 0, true}};
+  columns["name"] = {1, {ColumnInfo::VARCHAR, 32, false}};
+  columns["price"] = {2, {ColumnInfo::FLOAT, 0, false}};
+  return columns;
+}
+
+static std::string getName(size_t i) {
+  return "item" + std::to_string(i % 97);
+}
+
+static void removeTable(const std::string& tablePath) {
+  std::remove(tablePath.c_str());
+  std::remove((tablePath + ".vidx").c_str());
+  std::remove((tablePath + ".vfsm").c_str());
+}
+
+// Every seventh row leaves its name NULL
+static void insert(Table& table, size_t first, size_t count) {
+  std::vector<std::vector<Field>> records;
+  for (size_t i = first; i < first + count; i++) {
+    std::vector<Field> record;
+    record.push_back({"id", std::to_string(i)});
+    if (i % 7 != 0) {
+      record.push_back({"name", getName(i)});
+    }
+    record.push_back({"price", std::to_string(i % 13)});
+    records.push_back(std::move(record));
+  }
+  [[maybe_unused]] size_t added = table.addRecords(records);
+  assert(added == count);
+}
+
+static void testLayout() {
+  Columns columns = getColumns();
+  RecordLayout layout(columns);
+  PaxLayout pax(layout);
+  // Three 4-byte minipage entries and half of the VARCHAR per row
+  assert(pax.getCapacity() > 200 && pax.getCapacity() < BLOCK_SIZE / 12);
+  std::vector<char> block(BLOCK_SIZE, 0);
+  assert(pax.getFreeSpace(block.data()) > 0);
+
+  int id = 42;
+  float price = 1.5f;
+  std::string name = "answer";
+  std::vector<char> record(layout.getSize({name.size()}));
+  layout.encode({{reinterpret_cast<const char*>(&id), sizeof(int)}, {name.data(), name.size()},
+                 {reinterpret_cast<const char*>(&price), sizeof(float)}}, record.data());
+  auto ranges = pax.addRow(block.data(), record.data());
+  assert(!ranges.empty());
+  assert(PaxLayout::readRowCount(block.data()) == 1);
+  assert(*reinterpret_cast<const int*>(pax.getColumn(block.data(), 0)) == id);
+  auto value = pax.getValue(block.data(), 0, 1);
+  assert(std::string(value.first, value.second) == name);
+  std::vector<char> readBack;
+  pax.readRow(block.data(), 0, readBack);
+  assert(readBack == record);
+  std::cout << "[DEBUG] PAX page of " << pax.getCapacity() << " rows laid out successfully" << std::endl;
+}
+
+// One row of minipages is larger than a page, so no row ever fits
+static void testOversized() {
+  Columns columns;
+  for (size_t i = 0; i < BLOCK_SIZE / 8; i++) {
+    columns["c" + std::to_string(i)] = {i, {ColumnInfo::INT, 0, false}};
+  }
+  RecordLayout layout(columns);
+  PaxLayout pax(layout);
+  assert(!pax.isUsable());
+  std::vector<char> block(BLOCK_SIZE, 0);
+  assert(pax.getFreeSpace(block.data()) == 0);
+  int value = 0;
+  std::vector<std::pair<const char*, size_t>> values(columns.size(), {reinterpret_cast<const char*>(&value), sizeof(int)});
+  std::vector<char> record(layout.getSize({}));
+  layout.encode(values, record.data());
+  assert(!pax.isFitting(record.data()));
+  assert(!pax.isEnoughSpace(block.data(), record.data()));
+
+  Columns narrow = getColumns();
+  RecordLayout narrowLayout(narrow);
+  assert(PaxLayout(narrowLayout).isUsable());
+  std::cout << "[DEBUG] Oversized PAX rows rejected successfully" << std::endl;
+}
+
+static void testTable(BlockFile::Mode mode) {
+  std::string tablePath = Utility::getDatabasePath(DATABASE) + TABLE;
+  removeTable(tablePath);
+  {
+    Table table(DATABASE, TABLE, getColumns(), mode, PAX_LAYOUT);
+    insert(table, 0, RECORD_COUNT);
+    table.save();
+  }
+
+  Table table(DATABASE, TABLE, getColumns(), mode, PAX_LAYOUT);
+  const PaxLayout* pax = table.getPaxLayout();
+  assert(pax != nullptr);
+  size_t blockCount = BlockFile(tablePath).getBlockCount();
+  assert(blockCount == (RECORD_COUNT + pax->getCapacity() - 1) / pax->getCapacity());
+
+  for (size_t i = 0; i < RECORD_COUNT; i += 997) {
+    Field key = {"id", std::to_string(i)};
+    auto location = table.findRecord(key);
+    assert(location.unwrappable());
+    auto fields = table.getRecord(location.unwrap()).unwrap();
+    assert(fields.size() == (i % 7 == 0 ? 2 : 3));
+    assert(fields[0].value == key.value);
+    assert(i % 7 == 0 || fields[1].value == getName(i));
+  }
+
+  // Rows come back as records
+  auto scanner = table.scan();
+  size_t count = 0;
+  while (true) {
+    auto record = scanner->next();
+    if (!record.unwrappable()) {
+      break;
+    }
+    std::vector<Field> fields = table.parseRecord(record.unwrap());
+    assert(fields[0].value == std::to_string(count));
+    count++;
+  }
+  assert(count == RECORD_COUNT);
+
+  // A column scan reads the INT minipage as an array
+  scanner = table.scan();
+  long long sum = 0;
+  size_t nulls = 0;
+  while (true) {
+    auto page = scanner->nextPage();
+    if (!page.unwrappable()) {
+      break;
+    }
+    const char* block = page.unwrap();
+    size_t rowCount = PaxLayout::readRowCount(block);
+    const int* ids = reinterpret_cast<const int*>(pax->getColumn(block, 0));
+    for (size_t row = 0; row < rowCount; row++) {
+      sum += ids[row];
+      nulls += pax->isNull(block, row, 1);
+    }
+  }
+  assert(sum == (long long)(RECORD_COUNT * (RECORD_COUNT - 1) / 2));
+  assert(nulls == (RECORD_COUNT + 6) / 7);
+
+  // The free space map sends a single row to the partly filled last block
+  insert(table, RECORD_COUNT, 1);
+  table.save();
+  assert(BlockFile(tablePath).getBlockCount() == blockCount);
+  std::cout << "[DEBUG] PAX table of " << count << " rows in " << blockCount << " blocks"
+            << (mode == BlockFile::MAPPED ? " mapped" : "") << " stored and scanned successfully" << std::endl;
+}
+
+int main() {
+  // Keep the data directory inside the build tree
+  char cwd[PATH_MAX];
+  [[maybe_unused]] char* workingDirectory = getcwd(cwd, sizeof(cwd));
+  assert(workingDirectory != nullptr);
+  setenv("HOME", (std::string(cwd) + "/pax_layout_test_home").c_str(), 1);
+  [[maybe_unused]] bool created = Utility::createDirectory(Utility::getDatabasePath(DATABASE));
+  assert(created);
+
+  testLayout();
+  testOversized();
+  for (BlockFile::Mode mode : MODES) {
+    testTable(mode);
+  }
+  removeTable(Utility::getDatabasePath(DATABASE) + TABLE);
+  return 0;
+}
@@ -0,0 +1,147 @@
+#include "execute_stmt.h"
+#include "insert_stmt.h"
+#include "plan_cache.h"
+#include "prepare_stmt.h"
+#include "scanner.h"
+#include "select_stmt.h"
+
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+static std::vector<Token> scan(const std::string& text) {
+  return Scanner(text).scan().unwrap();
+}
+
+static std::shared_ptr<AST> parse(PlanCache& cache, const std::string& text) {
+  auto optionalAst = cache.parse(scan(text));
+  assert(optionalAst.unwrappable());
+  return optionalAst.unwrap();
+}
+
+static SelectStmt* getSelect(const std::shared_ptr<AST>& ast, size_t root = 0) {
+  return static_cast<SelectStmt*>(ast->roots[root].get());
+}
+
+static void testSelect() {
+  PlanCache cache;
+  auto first = parse(cache, "SELECT name FROM items WHERE id >= 1 AND name = 'a';");
+  assert(cache.getSize() == 1);
+  auto second = parse(cache, "select name from items where id >= 25 and name = 'b c';");
+  // Keywords differ in case only, and the tokens are the same. The hit is a
+  // copy sharing the plan, and the cached statement keeps its literals.
+  assert(cache.getSize() == 1);
+  assert(second != first);
+  assert(getSelect(first)->sharedPlan != nullptr);
+  assert(getSelect(second)->sharedPlan == getSelect(first)->sharedPlan);
+  assert(getSelect(first)->conditions[0].value == "1");
+  auto select = getSelect(second);
+  assert(select->conditions[0].value == "25");
+  assert(!select->conditions[0].isString);
+  assert(select->conditions[1].value == "b c");
+  assert(select->conditions[1].isString);
+
+  // Another shape is another entry
+  auto third = parse(cache, "SELECT name FROM items WHERE id < 1;");
+  assert(third != first);
+  assert(cache.getSize() == 2);
+}
+
+static void testInsert() {
+  PlanCache cache;
+  auto first = parse(cache, "INSERT INTO items VALUES (1, 'a', 2.5), (2, 'b', 3);");
+  auto second = parse(cache, "INSERT INTO items VALUES (7, 'x', -1), (8, 'y', 0.5);");
+  assert(second != first);
+  assert(cache.getSize() == 1);
+  auto insert = static_cast<InsertStmt*>(second->roots[0].get());
+  std::vector<std::vector<std::string>> rows = { { "7", "x", "-1" }, { "8", "y", "0.5" } };
+  assert(insert->rows == rows);
+  rows = { { "1", "a", "2.5" }, { "2", "b", "3" } };
+  assert(static_cast<InsertStmt*>(first->roots[0].get())->rows == rows);
+
+  // Several statements on a line bind in order
+  auto line = parse(cache, "INSERT INTO items VALUES (1, 'a', 2); SELECT * FROM items WHERE id = 1;");
+  line = parse(cache, "INSERT INTO items VALUES (4, 'd', 5); SELECT * FROM items WHERE id = 4;");
+  assert(static_cast<InsertStmt*>(line->roots[0].get())->rows[0][0] == "4");
+  assert(getSelect(line, 1)->conditions[0].value == "4");
+  assert(cache.getSize() == 2);
+}
+
+static void testUncached() {
+  PlanCache cache;
+  parse(cache, "CREATE TABLE items (id INT PRIMARY KEY, name VARCHAR(20));");
+  parse(cache, "PREPARE find AS SELECT * FROM items WHERE id = ?;");
+  assert(cache.getSize() == 0);
+  // Parameters only come with PREPARE
+  [[maybe_unused]] bool parsed = cache.parse(scan("SELECT * FROM items WHERE id = ?;")).unwrappable();
+  assert(!parsed);
+}
+
+static void testPrepare() {
+  PlanCache cache;
+  auto ast = parse(cache, "PREPARE find AS SELECT * FROM items WHERE id > ? AND name != 'z' AND price <= ?;");
+  auto prepare = static_cast<PrepareStmt*>(ast->roots[0].get());
+  assert(prepare->name == "find");
+  assert(PlanCache::getParameterCount(*prepare->statement) == 2);
+  cache.prepare(prepare->name, prepare->statement);
+
+  // The values view the statement, which has to outlive them
+  std::string text = "EXECUTE find (3, 9.5);";
+  ast = parse(cache, text);
+  auto execute = static_cast<ExecuteStmt*>(ast->roots[0].get());
+  assert(execute->values.size() == 2);
+  auto statement = cache.getPrepared("find").unwrap();
+  std::vector<const Token*> values = { &execute->values[0], &execute->values[1] };
+  auto optionalBound = PlanCache::bind(*statement, values);
+  assert(optionalBound.unwrappable());
+  auto bound = optionalBound.unwrap();
+  auto select = getSelect(bound);
+  assert(select->conditions[0].value == "3");
+  assert(select->conditions[1].value == "z");
+  assert(select->conditions[2].value == "9.5");
+  // Each execution binds its own copy, sharing the plan of the prepared one
+  assert(getSelect(statement)->conditions[0].value == "?");
+  assert(select->sharedPlan != nullptr && select->sharedPlan == getSelect(statement)->sharedPlan);
+  values.pop_back();
+  [[maybe_unused]] bool isBound = PlanCache::bind(*statement, values).unwrappable();
+  assert(!isBound);
+  assert(!cache.getPrepared("missing").unwrappable());
+  // A number out of range of its type fails the one execution
+  for (const char* invalid : {"EXECUTE find (99999999999, 9.5);", "EXECUTE find (3, 10000000000000000000000000000000000000000.5);"}) {
+    std::string invalidText = invalid;
+    auto invalidAst = parse(cache, invalidText);
+    auto invalidExecute = static_cast<ExecuteStmt*>(invalidAst->roots[0].get());
+    values = { &invalidExecute->values[0], &invalidExecute->values[1] };
+    [[maybe_unused]] auto status = PlanCache::bind(*statement, values).status;
+    assert(status == VerdantStatus::INVALID_TYPE);
+  }
+
+  ast = parse(cache, "PREPARE add AS INSERT INTO items VALUES (?, 'fixed', ?), (?, ?, 1);");
+  prepare = static_cast<PrepareStmt*>(ast->roots[0].get());
+  assert(PlanCache::getParameterCount(*prepare->statement) == 4);
+}
+
+static void testEviction() {
+  PlanCache cache(2);
+  auto first = parse(cache, "SELECT * FROM a WHERE id = 1;");
+  parse(cache, "SELECT * FROM b WHERE id = 1;");
+  parse(cache, "SELECT * FROM a WHERE id = 2;");
+  parse(cache, "SELECT * FROM c WHERE id = 1;");
+  assert(cache.getSize() == 2);
+  // a was used after b, so b went first
+  auto third = parse(cache, "SELECT * FROM a WHERE id = 3;");
+  assert(getSelect(third)->sharedPlan == getSelect(first)->sharedPlan);
+  assert(cache.getSize() == 2);
+}
+
+int main() {
+  testSelect();
+  testInsert();
+  testUncached();
+  testPrepare();
+  testEviction();
+  std::cout << "Plan cache tests passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,169 @@
+#include "record_layout.h"
+#include "table.h"
+#include "util.h"
+
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+const char* DATABASE = "record_layout_test";
+const char* TABLE = "items";
+
+static Columns getColumns() {
+  Columns columns;
+  columns["id"] = {0, {ColumnInfo::INT, 0, true}};
+  columns["name"] = {1, {ColumnInfo::VARCHAR, 32, false}};
+  columns["price"] = {2, {ColumnInfo::FLOAT, 0, false}};
+  columns["note"] = {3, {ColumnInfo::VARCHAR, 300, false}};
+  return columns;
+}
+
+static void testVarint() {
+  size_t values[] = { 0, 1, 127, 128, 300, 16383, 16384, (size_t)1 << 40 };
+  char buffer[16];
+  for (size_t value : values) {
+    size_t size = RecordLayout::writeVarint(buffer, value);
+    assert(size == RecordLayout::getVarintSize(value));
+    size_t read;
+    [[maybe_unused]] size_t readSize = RecordLayout::readVarint(buffer, read);
+    assert(readSize == size && read == value);
+  }
+  assert(RecordLayout::getVarintSize(127) == 1 && RecordLayout::getVarintSize(128) == 2);
+  std::cout << "[DEBUG] Varints encoded and decoded successfully" << std::endl;
+}
+
+static void testLayout() {
+  RecordLayout layout(getColumns());
+  assert(layout.getColumnCount() == 4);
+  assert(layout.getName(2) == "price");
+
+  int id = 7;
+  float price = 2.5f;
+  std::string note(200, 'n');
+  std::vector<std::pair<const char*, size_t>> values = {
+    { reinterpret_cast<const char*>(&id), sizeof(int) },
+    { nullptr, 0 },
+    { reinterpret_cast<const char*>(&price), sizeof(float) },
+    { note.data(), note.size() },
+  };
+  std::vector<size_t> lengths = { 0, note.size() };
+  // Bitmap, two fixed values, two lengths and the note
+  size_t size = layout.getSize(lengths);
+  assert(size == 1 + sizeof(int) + sizeof(float) + 1 + 2 + note.size());
+  assert(size < layout.getMaxSize());
+  std::vector<char> record(size);
+  layout.encode(values, record.data());
+
+  assert(!layout.isNull(record.data(), 0) && layout.isNull(record.data(), 1));
+  assert(!layout.isNull(record.data(), 2) && !layout.isNull(record.data(), 3));
+  auto value = layout.getValue(record.data(), 0);
+  assert(value.second == sizeof(int) && std::memcmp(value.first, &id, sizeof(int)) == 0);
+  value = layout.getValue(record.data(), 2);
+  assert(value.second == sizeof(float) && std::memcmp(value.first, &price, sizeof(float)) == 0);
+  value = layout.getValue(record.data(), 3);
+  assert(std::string(value.first, value.second) == note);
+  std::cout << "[DEBUG] Record of " << size << " bytes laid out successfully" << std::endl;
+}
+
+static void testTable() {
+  std::string databasePath = Utility::getDatabasePath(DATABASE);
+  [[maybe_unused]] bool created = Utility::createDirectory(databasePath);
+  assert(created);
+  std::string tablePath = databasePath + TABLE;
+  std::remove(tablePath.c_str());
+  std::remove((tablePath + ".vidx").c_str());
+  std::remove((tablePath + ".vfsm").c_str());
+
+  {
+    Table table(DATABASE, TABLE, getColumns());
+    std::vector<Field> full;
+    full.push_back({"id", "1"});
+    full.push_back({"name", "first"});
+    full.push_back({"price", "1.5"});
+    full.push_back({"note", std::string(250, 'x')});
+    [[maybe_unused]] bool added = table.addRecord(full);
+    assert(added);
+    // Columns left out are stored as NULL
+    std::vector<Field> partial;
+    partial.push_back({"note", ""});
+    partial.push_back({"id", "2"});
+    added = table.addRecord(partial);
+    assert(added);
+    // The primary key cannot be left out
+    std::vector<Field> keyless;
+    keyless.push_back({"name", "keyless"});
+    added = table.addRecord(keyless);
+    assert(!added);
+    // A batch with a key already taken, or taken twice within the batch, is
+    // rejected before any of its records is added
+    auto getBatch = [](std::vector<std::string> keys) {
+      std::vector<std::vector<Field>> records(keys.size());
+      for (size_t i = 0; i < keys.size(); i++) {
+        records[i].push_back({"id", keys[i]});
+      }
+      return records;
+    };
+    auto taken = getBatch({"3", "1"});
+    [[maybe_unused]] size_t addedCount = table.addRecords(taken);
+    assert(addedCount == 0);
+    auto repeated = getBatch({"4", "5", "4"});
+    addedCount = table.addRecords(repeated);
+    assert(addedCount == 0);
+    table.save();
+  }
+  {
+    Table table(DATABASE, TABLE, getColumns());
+    Field first = {"id", "1"};
+    auto fields = table.getRecord(table.findRecord(first).unwrap()).unwrap();
+    assert(fields.size() == 4);
+    assert(fields[1].value == "first" && std::stof(fields[2].value) == 1.5f);
+    assert(fields[3].value == std::string(250, 'x'));
+
+    Field second = {"id", "2"};
+    fields = table.getRecord(table.findRecord(second).unwrap()).unwrap();
+    assert(fields.size() == 2);
+    assert(fields[0].name == "id" && fields[0].value == "2");
+    assert(fields[1].name == "note" && fields[1].value.empty());
+
+    for (const char* key : {"3", "4", "5"}) {
+      Field rejected = {"id", key};
+      assert(!table.findRecord(rejected).unwrappable());
+    }
+  }
+  std::cout << "[DEBUG] Records with NULL columns stored and read back successfully" << std::endl;
+
+  // A lost or stale index is built again from the table when it is opened
+  std::remove((tablePath + ".vidx").c_str());
+  {
+    Table table(DATABASE, TABLE, getColumns());
+    Field first = {"id", "1"};
+    auto fields = table.getRecord(table.findRecord(first).unwrap()).unwrap();
+    assert(fields[1].value == "first");
+    Field second = {"id", "2"};
+    fields = table.getRecord(table.findRecord(second).unwrap()).unwrap();
+    assert(fields[0].value == "2");
+  }
+  std::cout << "[DEBUG] Primary index rebuilt successfully" << std::endl;
+
+  std::remove(tablePath.c_str());
+  std::remove((tablePath + ".vidx").c_str());
+  std::remove((tablePath + ".vfsm").c_str());
+}
+
+int main() {
+  // Keep the data directory inside the build tree
+  char cwd[PATH_MAX];
+  [[maybe_unused]] char* workingDirectory = getcwd(cwd, sizeof(cwd));
+  assert(workingDirectory != nullptr);
+  setenv("HOME", (std::string(cwd) + "/record_layout_test_home").c_str(), 1);
+
+  testVarint();
+  testLayout();
+  testTable();
+  return 0;
+}
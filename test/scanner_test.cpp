@@ -0,0 +1,84 @@
+#include "scanner.h"
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static void testTokens() {
+  std::string text = "Insert INTO items VALUES (1, 'a b', -2.5);\nselect COUNT(*) from items where id >= ? AND name <> 'x';";
+  std::vector<Token> tokens;
+  [[maybe_unused]] bool scanned = Scanner(text).scan(tokens);
+  assert(scanned);
+  std::vector<Token::TokenType> types = {
+    Token::TOKEN_INSERT, Token::TOKEN_INTO, Token::TOKEN_IDENTIFIER, Token::TOKEN_VALUES, Token::TOKEN_LEFT_PAREN,
+    Token::TOKEN_INT_VALUE, Token::TOKEN_COMMA, Token::TOKEN_STRING_VALUE, Token::TOKEN_COMMA,
+    Token::TOKEN_FLOAT_VALUE, Token::TOKEN_RIGHT_PAREN, Token::TOKEN_SEMICOLON,
+    Token::TOKEN_SELECT, Token::TOKEN_COUNT, Token::TOKEN_LEFT_PAREN, Token::TOKEN_STAR, Token::TOKEN_RIGHT_PAREN,
+    Token::TOKEN_FROM, Token::TOKEN_IDENTIFIER, Token::TOKEN_WHERE, Token::TOKEN_IDENTIFIER,
+    Token::TOKEN_GREATER_EQUAL, Token::TOKEN_PARAMETER, Token::TOKEN_AND, Token::TOKEN_IDENTIFIER,
+    Token::TOKEN_NOT_EQUAL, Token::TOKEN_STRING_VALUE, Token::TOKEN_SEMICOLON,
+  };
+  assert(tokens.size() == types.size());
+  for (size_t i = 0; i < types.size(); i++) {
+    assert(tokens[i].type == types[i]);
+  }
+  assert(tokens[0].value == "Insert");
+  assert(tokens[2].value == "items");
+  assert(tokens[7].value == "a b");
+  assert(tokens[9].value == "-2.5");
+  assert(tokens[12].line == 2);
+
+  // Values point into the text instead of holding copies
+  for (auto& token : tokens) {
+    if (token.type == Token::TOKEN_IDENTIFIER || token.type == Token::TOKEN_STRING_VALUE) {
+      assert(token.value.data() >= text.data() && token.value.data() < text.data() + text.size());
+    }
+  }
+}
+
+static void testKeywords() {
+  std::string text = "create DATABASE Table int FLOAT varchar primary key layout prepare execute as sum tables selects";
+  std::vector<Token> tokens;
+  [[maybe_unused]] bool scanned = Scanner(text).scan(tokens);
+  assert(scanned);
+  std::vector<Token::TokenType> types = {
+    Token::TOKEN_CREATE, Token::TOKEN_DATABASE, Token::TOKEN_TABLE, Token::TOKEN_INT, Token::TOKEN_FLOAT,
+    Token::TOKEN_VARCHAR, Token::TOKEN_PRIMARY, Token::TOKEN_KEY, Token::TOKEN_LAYOUT, Token::TOKEN_PREPARE,
+    Token::TOKEN_EXECUTE, Token::TOKEN_AS, Token::TOKEN_SUM, Token::TOKEN_IDENTIFIER, Token::TOKEN_IDENTIFIER,
+  };
+  assert(tokens.size() == types.size());
+  for (size_t i = 0; i < types.size(); i++) {
+    assert(tokens[i].type == types[i]);
+  }
+}
+
+// A buffer scanned into again keeps its storage
+static void testReuse() {
+  std::vector<Token> tokens;
+  std::string first = "INSERT INTO items VALUES (1, 'a'), (2, 'b'), (3, 'c');";
+  [[maybe_unused]] bool scanned = Scanner(first).scan(tokens);
+  assert(scanned);
+  size_t capacity = tokens.capacity();
+  const Token* data = tokens.data();
+  std::string second = "INSERT INTO items VALUES (4, 'd');";
+  scanned = Scanner(second).scan(tokens);
+  assert(scanned);
+  assert(tokens.size() == 10);
+  assert(tokens.capacity() == capacity);
+  assert(tokens.data() == data);
+  assert(tokens[5].value == "4");
+
+  std::string invalid = "SELECT * FROM items WHERE name = 'open";
+  scanned = Scanner(invalid).scan(tokens);
+  assert(!scanned);
+  assert(!Scanner(invalid).scan().unwrappable());
+}
+
+int main() {
+  testTokens();
+  testKeywords();
+  testReuse();
+  std::cout << "Scanner tests passed" << std::endl;
+  return 0;
+}
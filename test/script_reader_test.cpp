@@ -0,0 +1,80 @@
+#include "script_reader.h"
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+const char* SCRIPT =
+    "\\c shop\r\n"
+    "CREATE TABLE items (\r\n  id INT PRIMARY KEY,\r\n  name VARCHAR(20)\r\n);\r\n"
+    "INSERT INTO items VALUES (1, 'a;b'), (2, 'it''s');  INSERT INTO items VALUES (3, 'c');\n"
+    "\n\n   SELECT * FROM items\nWHERE id > 1;\n"
+    "\\q\n"
+    "SELECT COUNT(*) FROM items";
+
+static std::vector<std::string> getExpected() {
+  return {
+    "\\c shop\r",
+    "CREATE TABLE items (\r\n  id INT PRIMARY KEY,\r\n  name VARCHAR(20)\r\n);",
+    "INSERT INTO items VALUES (1, 'a;b'), (2, 'it''s');",
+    "INSERT INTO items VALUES (3, 'c');",
+    "SELECT * FROM items\nWHERE id > 1;",
+    "\\q",
+    "SELECT COUNT(*) FROM items",
+  };
+}
+
+// Every chunk size gives the same statements, whatever chunk boundary they
+// cross
+static void testStatements(size_t chunkSize) {
+  std::istringstream in(SCRIPT);
+  ScriptReader reader(in, chunkSize);
+  std::vector<std::string> statements;
+  std::string statement;
+  while (reader.next(statement)) {
+    statements.push_back(statement);
+  }
+  assert(statements == getExpected());
+  [[maybe_unused]] bool more = reader.next(statement);
+  assert(!more);
+}
+
+static void testEmpty() {
+  std::istringstream in(" \n\r\n\t");
+  ScriptReader reader(in);
+  std::string statement;
+  [[maybe_unused]] bool more = reader.next(statement);
+  assert(!more);
+}
+
+// The statement buffer is reused, so a script of many statements does not
+// grow it past its longest statement
+static void testBounded() {
+  std::stringstream script;
+  std::string longest = "INSERT INTO items VALUES (0, 'a');";
+  for (size_t i = 0; i < 100000; i++) {
+    script << "INSERT INTO items VALUES (" << i % 10 << ", 'a');\n";
+  }
+  ScriptReader reader(script, 4096);
+  std::string statement;
+  size_t count = 0;
+  while (reader.next(statement)) {
+    count++;
+    assert(statement.size() == longest.size());
+  }
+  assert(count == 100000);
+  assert(statement.capacity() < 2 * longest.size());
+}
+
+int main() {
+  size_t chunkSizes[] = { 1, 2, 3, 7, 64, SCRIPT_READ_CHUNK_SIZE };
+  for (size_t chunkSize : chunkSizes) {
+    testStatements(chunkSize);
+  }
+  testEmpty();
+  testBounded();
+  std::cout << "Script reader tests passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,133 @@
+#include "table.h"
+#include "table_cache.h"
+#include "util.h"
+
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+size_t RECORD_COUNT = 1000;
+const char* DATABASE = "table_cache_test";
+const char* TABLES[] = { "first", "second", "third" };
+
+static TableSchema getSchema() {
+  TableSchema schema;
+  schema.columns["id"] = {0, {ColumnInfo::INT, 0, true}};
+  schema.columns["name"] = {1, {ColumnInfo::VARCHAR, 32, false}};
+  return schema;
+}
+
+static void removeTable(const std::string& tablePath) {
+  std::remove(tablePath.c_str());
+  std::remove((tablePath + ".vidx").c_str());
+  std::remove((tablePath + ".vfsm").c_str());
+}
+
+static void insert(Table& table) {
+  std::vector<std::vector<Field>> records;
+  for (size_t i = 0; i < RECORD_COUNT; i++) {
+    std::vector<Field> record;
+    record.push_back({"id", std::to_string(i)});
+    record.push_back({"name", "item" + std::to_string(i)});
+    records.push_back(std::move(record));
+  }
+  [[maybe_unused]] size_t added = table.addRecords(records);
+  assert(added == RECORD_COUNT);
+  table.save();
+}
+
+static size_t count(Table& table) {
+  auto scanner = table.scan();
+  size_t count = 0;
+  while (scanner->next().unwrappable()) {
+    count++;
+  }
+  return count;
+}
+
+// Each table keeps its file and its index open
+const size_t FILES_PER_TABLE = 2;
+
+static void testReuse() {
+  TableCache cache(2 * FILES_PER_TABLE);
+  TableSchema schema = getSchema();
+  auto table = cache.open(DATABASE, TABLES[0], schema);
+  insert(*table);
+  auto again = cache.open(DATABASE, TABLES[0], schema);
+  assert(again == table);
+  assert(cache.getSize() == 1);
+  assert(cache.getFileCount() == FILES_PER_TABLE);
+  // The same name in another database is another table
+  assert(!cache.isOpen("other", TABLES[0]));
+}
+
+static void testEviction() {
+  TableCache cache(2 * FILES_PER_TABLE);
+  TableSchema schema = getSchema();
+  cache.open(DATABASE, TABLES[0], schema);
+  cache.open(DATABASE, TABLES[1], schema);
+  // Using the first table makes the second the least recently used
+  cache.open(DATABASE, TABLES[0], schema);
+  cache.open(DATABASE, TABLES[2], schema);
+  assert(cache.getSize() == 2);
+  assert(cache.getFileCount() == 2 * FILES_PER_TABLE);
+  assert(cache.isOpen(DATABASE, TABLES[0]));
+  assert(!cache.isOpen(DATABASE, TABLES[1]));
+  assert(cache.isOpen(DATABASE, TABLES[2]));
+
+  // A table still in use is not closed
+  auto held = cache.open(DATABASE, TABLES[2], schema);
+  cache.open(DATABASE, TABLES[1], schema);
+  assert(cache.isOpen(DATABASE, TABLES[2]));
+  assert(!cache.isOpen(DATABASE, TABLES[0]));
+
+  // A table closed by the cache opens again with its records
+  auto reopened = cache.open(DATABASE, TABLES[0], schema);
+  assert(count(*reopened) == RECORD_COUNT);
+  held = nullptr;
+  reopened = nullptr;
+  cache.clear();
+  assert(cache.getSize() == 0);
+  assert(cache.getFileCount() == 0);
+}
+
+// Descriptors held outside the cache, like those of the master table, leave
+// room for fewer tables
+static void testReserve() {
+  TableCache cache(2 * FILES_PER_TABLE);
+  TableSchema schema = getSchema();
+  cache.open(DATABASE, TABLES[0], schema);
+  cache.open(DATABASE, TABLES[1], schema);
+  cache.reserve(FILES_PER_TABLE);
+  assert(cache.getSize() == 1);
+  assert(cache.isOpen(DATABASE, TABLES[1]));
+  cache.open(DATABASE, TABLES[2], schema);
+  assert(cache.getSize() == 1);
+  assert(cache.getFileCount() + FILES_PER_TABLE <= 2 * FILES_PER_TABLE);
+}
+
+int main() {
+  // Keep the data directory inside the build tree
+  char cwd[PATH_MAX];
+  [[maybe_unused]] char* workingDirectory = getcwd(cwd, sizeof(cwd));
+  assert(workingDirectory != nullptr);
+  setenv("HOME", (std::string(cwd) + "/table_cache_test_home").c_str(), 1);
+  std::string databasePath = Utility::getDatabasePath(DATABASE);
+  [[maybe_unused]] bool created = Utility::createDirectory(databasePath);
+  assert(created);
+  for (const char* table : TABLES) {
+    removeTable(databasePath + table);
+  }
+
+  testReuse();
+  testEviction();
+  testReserve();
+  for (const char* table : TABLES) {
+    removeTable(databasePath + table);
+  }
+  return 0;
+}
@@ -0,0 +1,157 @@
+#include "table.h"
+#include "util.h"
+
+#include <cassert>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+size_t RECORD_COUNT = 50000;
+size_t READ_AHEAD_SIZES[] = { 1, 4, TABLE_SCAN_READ_AHEAD };
+BlockFile::Mode SCAN_MODES[] = { BlockFile::BUFFERED, BlockFile::DIRECT };
+size_t IO_DEPTHS[] = { 1, TABLE_SCAN_IO_DEPTH };
+const char* DATABASE = "table_scan_test";
+const char* TABLE = "items";
+const char* MAPPED_TABLE = "mapped_items";
+
+static Columns getColumns() {
+  Columns columns;
+  columns["id"] = {0, {ColumnInfo::INT, 0, true}};
+  columns["name"] = {1, {ColumnInfo::VARCHAR, 32, false}};
+  columns["price"] = {2, {ColumnInfo::FLOAT, 0, false}};
+  return columns;
+}
+
+int main() {
+  // Keep the data directory inside the build tree
+  char cwd[PATH_MAX];
+  [[maybe_unused]] char* workingDirectory = getcwd(cwd, sizeof(cwd));
+  assert(workingDirectory != nullptr);
+  setenv("HOME", (std::string(cwd) + "/table_scan_test_home").c_str(), 1);
+  std::string databasePath = Utility::getDatabasePath(DATABASE);
+  [[maybe_unused]] bool created = Utility::createDirectory(databasePath);
+  assert(created);
+  std::remove((databasePath + TABLE).c_str());
+  std::remove((databasePath + TABLE + ".vidx").c_str());
+
+  {
+    Table table(DATABASE, TABLE, getColumns());
+    std::vector<std::vector<Field>> records;
+    for (size_t i = 0; i < RECORD_COUNT; i++) {
+      std::vector<Field> record;
+      record.push_back({"id", std::to_string(i)});
+      record.push_back({"name", "item" + std::to_string(i % 97)});
+      record.push_back({"price", std::to_string(i % 13)});
+      records.push_back(std::move(record));
+    }
+    [[maybe_unused]] size_t added = table.addRecords(records);
+    assert(added == RECORD_COUNT);
+
+    // Scanning sees the rows that are still dirty in the buffer pool
+    auto scanner = table.scan();
+    size_t count = 0;
+    while (scanner->next().unwrappable()) {
+      count++;
+    }
+    assert(count == RECORD_COUNT);
+    table.save();
+  }
+
+  Table table(DATABASE, TABLE, getColumns());
+  for (size_t ioDepth : IO_DEPTHS) {
+    for (BlockFile::Mode mode : SCAN_MODES) {
+      for (size_t readAhead : READ_AHEAD_SIZES) {
+        BlockFile file(databasePath + TABLE, mode);
+        TableScanner scanner(file, readAhead, ioDepth);
+        size_t count = 0;
+        size_t lastBlock = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (true) {
+          auto record = scanner.next();
+          if (!record.unwrappable()) {
+            break;
+          }
+          std::vector<Field> fields = table.parseRecord(record.unwrap());
+          assert(fields[0].value == std::to_string(count));
+          assert(fields[1].value == "item" + std::to_string(count % 97));
+          assert(scanner.getBlockIndex() >= lastBlock);
+          lastBlock = scanner.getBlockIndex();
+          count++;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        assert(count == RECORD_COUNT);
+        assert(lastBlock + 1 == file.getBlockCount());
+        std::cout << "[DEBUG] Scanned " << count << " records in " << file.getBlockCount() << " blocks, " << readAhead << " blocks per read, " << ioDepth << " in flight" << (mode == BlockFile::DIRECT ? " with O_DIRECT" : "") << ", in " << elapsed.count() << "us" << std::endl;
+      }
+    }
+  }
+
+  // Rows written through the mapping read back the same through the buffered
+  // path, and the other way around
+  std::remove((databasePath + MAPPED_TABLE).c_str());
+  std::remove((databasePath + MAPPED_TABLE + ".vidx").c_str());
+  {
+    Table mappedTable(DATABASE, MAPPED_TABLE, getColumns(), BlockFile::MAPPED);
+    auto scanner = table.scan();
+    std::vector<std::vector<Field>> records;
+    while (true) {
+      auto record = scanner->next();
+      if (!record.unwrappable()) {
+        break;
+      }
+      records.push_back(table.parseRecord(record.unwrap()));
+    }
+    [[maybe_unused]] size_t added = mappedTable.addRecords(records);
+    assert(added == RECORD_COUNT);
+    Field key = {"id", std::to_string(RECORD_COUNT / 2)};
+    auto location = mappedTable.findRecord(key);
+    assert(location.unwrappable());
+    auto fields = mappedTable.getRecord(location.unwrap());
+    assert(fields.unwrappable() && fields.unwrap()[0].value == key.value);
+    mappedTable.save();
+  }
+  {
+    BlockFile buffered(databasePath + TABLE);
+    BlockFile mapped(databasePath + MAPPED_TABLE, BlockFile::MAPPED);
+    assert(mapped.isMapped() && mapped.getBlockCount() == buffered.getBlockCount());
+    TableScanner bufferedScanner(buffered);
+    TableScanner mappedScanner(mapped);
+    size_t count = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (true) {
+      auto mappedRecord = mappedScanner.next();
+      auto bufferedRecord = bufferedScanner.next();
+      assert(mappedRecord.unwrappable() == bufferedRecord.unwrappable());
+      if (!mappedRecord.unwrappable()) {
+        break;
+      }
+      BinaryRecord left = mappedRecord.unwrap();
+      BinaryRecord right = bufferedRecord.unwrap();
+      assert(left.second == right.second && std::memcmp(left.first, right.first, left.second) == 0);
+      count++;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    assert(count == RECORD_COUNT);
+    std::cout << "[DEBUG] Compared " << count << " mapped records with the buffered file in " << elapsed.count() << "us" << std::endl;
+  }
+  {
+    // Reopening in buffered mode sees what the mapping wrote
+    Table bufferedTable(DATABASE, MAPPED_TABLE, getColumns());
+    Field key = {"id", std::to_string(RECORD_COUNT - 1)};
+    auto location = bufferedTable.findRecord(key);
+    assert(location.unwrappable());
+    auto fields = bufferedTable.getRecord(location.unwrap());
+    assert(fields.unwrappable() && fields.unwrap()[1].value == "item" + std::to_string((RECORD_COUNT - 1) % 97));
+  }
+
+  std::remove((databasePath + TABLE).c_str());
+  std::remove((databasePath + TABLE + ".vidx").c_str());
+  std::remove((databasePath + MAPPED_TABLE).c_str());
+  std::remove((databasePath + MAPPED_TABLE + ".vidx").c_str());
+  return 0;
+}
@@ -0,0 +1,180 @@
+#include "select_stmt.h"
+#include "table.h"
+#include "util.h"
+#include "vector_executor.h"
+
+#include <cassert>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+size_t RECORD_COUNT = 30000;
+const char* DATABASE = "vector_executor_test";
+const char* TABLES[] = { "rows", "columns" };
+PageLayout LAYOUTS[] = { ROW_LAYOUT, PAX_LAYOUT };
+
+static Columns getColumns() {
+  Columns columns;
+  columns["id"] = {0, {ColumnInfo::INT, 0, true}};
+  columns["name"] = {1, {ColumnInfo::VARCHAR, 32, false}};
+  columns["price"] = {2, {ColumnInfo::FLOAT, 0, false}};
+  return columns;
+}
+
+static std::string getName(size_t i) {
+  return "item" + std::to_string(i % 97);
+}
+
+static void removeTable(const std::string& tablePath) {
+  std::remove(tablePath.c_str());
+  std::remove((tablePath + ".vidx").c_str());
+  std::remove((tablePath + ".vfsm").c_str());
+}
+
+// Every fifth row leaves its name NULL
+static void insert(Table& table) {
+  std::vector<std::vector<Field>> records;
+  for (size_t i = 0; i < RECORD_COUNT; i++) {
+    std::vector<Field> record;
+    record.push_back({"id", std::to_string(i)});
+    if (i % 5 != 0) {
+      record.push_back({"name", getName(i)});
+    }
+    record.push_back({"price", std::to_string(i % 13) + ".5"});
+    records.push_back(std::move(record));
+  }
+  [[maybe_unused]] size_t added = table.addRecords(records);
+  assert(added == RECORD_COUNT);
+}
+
+static Condition getCondition(const std::string& column, Condition::Operator op, const std::string& value,
+                              bool isString = false) {
+  Condition condition;
+  condition.column = column;
+  condition.op = op;
+  condition.value = value;
+  condition.isString = isString;
+  return condition;
+}
+
+static size_t count(Table& table, const SelectStmt& stmt) {
+  auto optionalPlan = SelectPlan::create(table.getLayout(), stmt);
+  assert(optionalPlan.unwrappable());
+  SelectPlan plan = optionalPlan.unwrap();
+  VectorExecutor executor(table, plan);
+  Batch batch;
+  size_t selected = 0;
+  while (executor.next(batch)) {
+    assert(batch.size <= VECTOR_BATCH_SIZE && !batch.selection.empty());
+    for (size_t i = 1; i < batch.selection.size(); i++) {
+      assert(batch.selection[i - 1] < batch.selection[i]);
+    }
+    selected += batch.selection.size();
+  }
+  return selected;
+}
+
+static void testTable(const char* name, PageLayout layout) {
+  std::string tablePath = Utility::getDatabasePath(DATABASE) + name;
+  removeTable(tablePath);
+  Table table(DATABASE, name, getColumns(), TABLE_STORAGE_MODE, layout);
+  insert(table);
+  table.save();
+
+  SelectStmt all(name);
+  assert(count(table, all) == RECORD_COUNT);
+
+  // id < 1000 AND price >= 6.5, on INT and FLOAT columns
+  SelectStmt range(name);
+  range.conditions.push_back(getCondition("id", Condition::LESS, "1000"));
+  range.conditions.push_back(getCondition("price", Condition::GREATER_EQUAL, "6.5"));
+  size_t expected = 0;
+  for (size_t i = 0; i < 1000; i++) {
+    expected += i % 13 >= 6;
+  }
+  assert(count(table, range) == expected);
+
+  // NULL names never compare
+  SelectStmt byName(name);
+  byName.columns = {"id"};
+  byName.conditions.push_back(getCondition("name", Condition::EQUAL, "item3", true));
+  expected = 0;
+  size_t notEqual = 0;
+  for (size_t i = 0; i < RECORD_COUNT; i++) {
+    expected += i % 5 != 0 && i % 97 == 3;
+    notEqual += i % 5 != 0 && i % 97 != 3;
+  }
+  assert(count(table, byName) == expected);
+  byName.conditions[0].op = Condition::NOT_EQUAL;
+  assert(count(table, byName) == notEqual);
+
+  // Projection of the rows selected
+  SelectStmt one(name);
+  one.columns = {"name", "id"};
+  one.conditions.push_back(getCondition("id", Condition::EQUAL, "1234"));
+  auto optionalPlan = SelectPlan::create(table.getLayout(), one);
+  SelectPlan plan = optionalPlan.unwrap();
+  std::ostringstream out;
+  [[maybe_unused]] size_t rows = VectorExecutor(table, plan).run(out);
+  assert(rows == 1);
+  assert(out.str() == "name | id\n" + getName(1234) + " | 1234\n");
+
+  // The plan bound to the conditions of another run of the statement
+  one.conditions[0].value = "4321";
+  [[maybe_unused]] bool bound = plan.bind(table.getLayout(), one.conditions);
+  assert(bound);
+  out.str("");
+  rows = VectorExecutor(table, plan).run(out);
+  assert(rows == 1);
+  assert(out.str() == "name | id\n" + getName(4321) + " | 4321\n");
+  one.conditions[0] = getCondition("id", Condition::EQUAL, "abc", true);
+  bound = plan.bind(table.getLayout(), one.conditions);
+  assert(!bound);
+
+  // Unknown columns and mistyped literals are refused
+  SelectStmt unknown(name);
+  unknown.columns = {"missing"};
+  assert(!SelectPlan::create(table.getLayout(), unknown).unwrappable());
+  SelectStmt mistyped(name);
+  mistyped.conditions.push_back(getCondition("id", Condition::EQUAL, "abc", true));
+  assert(!SelectPlan::create(table.getLayout(), mistyped).unwrappable());
+  // Literals that do not parse or are out of range of the column type
+  for (const char* value : {"99999999999", "", "-", "12abc"}) {
+    SelectStmt invalid(name);
+    invalid.conditions.push_back(getCondition("id", Condition::GREATER, value));
+    assert(!SelectPlan::create(table.getLayout(), invalid).unwrappable());
+  }
+  SelectStmt hugeFloat(name);
+  hugeFloat.conditions.push_back(getCondition("price", Condition::GREATER, "1e999"));
+  assert(!SelectPlan::create(table.getLayout(), hugeFloat).unwrappable());
+
+  auto start = std::chrono::steady_clock::now();
+  SelectStmt scan(name);
+  scan.columns = {"price"};
+  scan.conditions.push_back(getCondition("price", Condition::GREATER, "100"));
+  assert(count(table, scan) == 0);
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  std::cout << "[DEBUG] Filtered " << RECORD_COUNT << (layout == PAX_LAYOUT ? " PAX" : "") << " rows in "
+            << elapsed.count() << "us" << std::endl;
+  removeTable(tablePath);
+}
+
+int main() {
+  // Keep the data directory inside the build tree
+  char cwd[PATH_MAX];
+  [[maybe_unused]] char* workingDirectory = getcwd(cwd, sizeof(cwd));
+  assert(workingDirectory != nullptr);
+  setenv("HOME", (std::string(cwd) + "/vector_executor_test_home").c_str(), 1);
+  [[maybe_unused]] bool created = Utility::createDirectory(Utility::getDatabasePath(DATABASE));
+  assert(created);
+
+  for (size_t i = 0; i < 2; i++) {
+    testTable(TABLES[i], LAYOUTS[i]);
+  }
+  return 0;
+}
@@ -0,0 +1,193 @@
+#include "block_file.h"
+#include "buffer_pool.h"
+#include "parameters.h"
+#include "wal.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <csignal>
+#include <iostream>
+#include <thread>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <vector>
+
+size_t FRAME_COUNT = 4;
+size_t PAGE_COUNT = 16;
+size_t THREAD_COUNT = 8;
+size_t COMMITS_PER_THREAD = 200;
+const char* FILE_PATH = "wal_test.vtbl";
+const char* LOG_PATH = "wal_test.wal";
+
+static void fillRange(char* block, size_t offset, size_t size, char value) {
+  std::memset(&block[offset], value, size);
+}
+
+static void testReplay() {
+  std::remove(FILE_PATH);
+  std::remove(LOG_PATH);
+  char block[BLOCK_SIZE] = {};
+  {
+    BlockFile file(FILE_PATH);
+    [[maybe_unused]] bool written = file.writeBlock(0, block) && file.writeBlock(1, block);
+    assert(written);
+  }
+  {
+    // The changes are logged but never reach the file, as after a crash
+    WriteAheadLog log(LOG_PATH);
+    assert(log.isOpen());
+    fillRange(block, 0, 100, 'a');
+    fillRange(block, BLOCK_SIZE - 16, 16, 'b');
+    log.append(FILE_PATH, 0, block, {{0, 100}, {BLOCK_SIZE - 16, 16}});
+    fillRange(block, 100, 50, 'c');
+    log.append(FILE_PATH, 1, block, {{100, 50}});
+    // A block past the end of the file
+    uint64_t lsn = log.append(FILE_PATH, 2, block, {{0, 10}});
+    [[maybe_unused]] bool flushed = log.flush(lsn);
+    assert(flushed);
+  }
+  {
+    // A torn record at the end is ignored
+    std::ofstream torn(LOG_PATH, std::ios::binary | std::ios::app);
+    uint32_t size = 4096;
+    torn.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    torn.write("torn", 4);
+  }
+  {
+    WriteAheadLog log(LOG_PATH);
+    [[maybe_unused]] size_t replayed = log.recover();
+    assert(replayed == 3);
+    assert(log.getSize() == 0);
+    replayed = log.recover();
+    assert(replayed == 0);
+  }
+  BlockFile file(FILE_PATH);
+  assert(file.getBlockCount() == 3);
+  char read[BLOCK_SIZE];
+  [[maybe_unused]] bool readable = file.readBlock(0, read);
+  assert(readable);
+  assert(read[0] == 'a' && read[99] == 'a' && read[100] == 0 && read[BLOCK_SIZE - 1] == 'b');
+  readable = file.readBlock(1, read);
+  assert(readable);
+  assert(read[99] == 0 && read[100] == 'c' && read[149] == 'c' && read[150] == 0);
+  readable = file.readBlock(2, read);
+  assert(readable);
+  assert(read[0] == 'a' && read[10] == 0);
+  std::cout << "[DEBUG] Log replayed successfully" << std::endl;
+}
+
+static void testWriteAhead() {
+  std::remove(FILE_PATH);
+  std::remove(LOG_PATH);
+  BlockFile file(FILE_PATH);
+  BufferPool pool(FRAME_COUNT);
+  {
+    WriteAheadLog log(LOG_PATH, &pool);
+    for (size_t i = 0; i < PAGE_COUNT; i++) {
+      PageGuard page = pool.newPage(file).unwrap();
+      fillRange(page.getData(), 0, BLOCK_SIZE, static_cast<char>(i));
+      page.markDirty(log.append(FILE_PATH, i, page.getData(), {{0, 64}}));
+    }
+    // Evictions had to make the log durable before writing the pages
+    assert(log.getSyncCount() > 0);
+    assert(log.getSize() > 0);
+    [[maybe_unused]] bool checkpointed = log.checkpoint();
+    assert(checkpointed);
+    assert(log.getSize() == 0);
+  }
+  char read[BLOCK_SIZE];
+  [[maybe_unused]] bool readable = file.readBlock(PAGE_COUNT - 1, read);
+  assert(readable && read[0] == static_cast<char>(PAGE_COUNT - 1));
+  pool.evictFile(file);
+  std::cout << "[DEBUG] Pages written after their log records" << std::endl;
+}
+
+// A flush that cannot write the log fails, leaves none of its bytes in the
+// log and writes its records again on the next flush
+static void testFailedFlush() {
+  std::remove(FILE_PATH);
+  std::remove(LOG_PATH);
+  char block[BLOCK_SIZE] = {};
+  {
+    BlockFile file(FILE_PATH);
+    [[maybe_unused]] bool written = file.writeBlock(0, block);
+    assert(written);
+  }
+  {
+    WriteAheadLog log(LOG_PATH);
+    fillRange(block, 0, 10, 'a');
+    [[maybe_unused]] bool flushed = log.flush(log.append(FILE_PATH, 0, block, {{0, 10}}));
+    assert(flushed);
+    size_t size = log.getSize();
+
+    // Writes past the file size limit fail with EFBIG instead of raising
+    // SIGXFSZ. The limit lets part of the next record through.
+    std::signal(SIGXFSZ, SIG_IGN);
+    struct rlimit limit;
+    getrlimit(RLIMIT_FSIZE, &limit);
+    struct rlimit lowered = limit;
+    lowered.rlim_cur = size + 16;
+    setrlimit(RLIMIT_FSIZE, &lowered);
+    fillRange(block, 10, 100, 'b');
+    flushed = log.flush(log.append(FILE_PATH, 0, block, {{10, 100}}));
+    setrlimit(RLIMIT_FSIZE, &limit);
+    std::signal(SIGXFSZ, SIG_DFL);
+    assert(!flushed);
+    assert(log.getSize() == size);
+    struct stat sb;
+    [[maybe_unused]] bool stated = stat(LOG_PATH, &sb) == 0;
+    assert(stated && static_cast<size_t>(sb.st_size) == size);
+
+    fillRange(block, 110, 10, 'c');
+    flushed = log.flush(log.append(FILE_PATH, 0, block, {{110, 10}}));
+    assert(flushed);
+  }
+  {
+    WriteAheadLog log(LOG_PATH);
+    [[maybe_unused]] size_t replayed = log.recover();
+    assert(replayed == 3);
+  }
+  BlockFile file(FILE_PATH);
+  char read[BLOCK_SIZE];
+  [[maybe_unused]] bool readable = file.readBlock(0, read);
+  assert(readable);
+  assert(read[9] == 'a' && read[10] == 'b' && read[109] == 'b' && read[110] == 'c' && read[120] == 0);
+  std::cout << "[DEBUG] Failed flush written again successfully" << std::endl;
+}
+
+static void testGroupCommit() {
+  std::remove(LOG_PATH);
+  WriteAheadLog log(LOG_PATH);
+  char block[BLOCK_SIZE] = {};
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < THREAD_COUNT; t++) {
+    threads.emplace_back([&log, &block, t]() {
+      for (size_t i = 0; i < COMMITS_PER_THREAD; i++) {
+        uint64_t lsn = log.append(FILE_PATH, t, block, {{i * 8, 8}});
+        [[maybe_unused]] bool flushed = log.flush(lsn);
+        assert(flushed);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+  size_t commits = THREAD_COUNT * COMMITS_PER_THREAD;
+  assert(log.getSyncCount() <= commits);
+  std::cout << "[DEBUG] " << commits << " commits from " << THREAD_COUNT << " threads shared " << log.getSyncCount() << " syncs in " << elapsed.count() << "ms" << std::endl;
+}
+
+int main() {
+  testReplay();
+  testWriteAhead();
+  testFailedFlush();
+  testGroupCommit();
+  std::remove(FILE_PATH);
+  std::remove(LOG_PATH);
+  return 0;
+}